@@ -761,6 +761,36 @@ static ssize_t iwl_dbgfs_fw_dbg_domain_read(struct iwl_fw_runtime *fwrt,
 
 FWRT_DEBUGFS_READ_FILE_OPS(fw_dbg_domain, 20);
 
+static ssize_t iwl_dbgfs_pnvm_stats_read(struct iwl_fw_runtime *fwrt,
+					 size_t size, char *buf)
+{
+	static const char * const sources[] = {
+		[IWL_PNVM_SOURCE_NONE] = "none",
+		[IWL_PNVM_SOURCE_UEFI] = "uefi",
+		[IWL_PNVM_SOURCE_FS] = "fs",
+	};
+	const struct iwl_pnvm_stats *stats = &fwrt->trans->pnvm_stats;
+	int pos = 0;
+
+	pos += scnprintf(buf + pos, size - pos, "loads: %u\n", stats->loads);
+	pos += scnprintf(buf + pos, size - pos, "cache hits: %u\n",
+			 stats->cache_hits);
+	pos += scnprintf(buf + pos, size - pos, "parses: %u\n",
+			 stats->parses);
+	pos += scnprintf(buf + pos, size - pos, "source: %s\n",
+			 sources[stats->source]);
+	pos += scnprintf(buf + pos, size - pos, "last parse: %u usec\n",
+			 stats->last_parse_us);
+	pos += scnprintf(buf + pos, size - pos, "last load: %u usec\n",
+			 stats->last_load_us);
+	pos += scnprintf(buf + pos, size - pos, "max load: %u usec\n",
+			 stats->max_load_us);
+
+	return pos;
+}
+
+FWRT_DEBUGFS_READ_FILE_OPS(pnvm_stats, 200);
+
 struct iwl_dbgfs_fw_info_priv {
 	struct iwl_fw_runtime *fwrt;
 };
@@ -866,6 +896,7 @@ void iwl_fwrt_dbgfs_register(struct iwl_fw_runtime *fwrt,
 	FWRT_DEBUGFS_ADD_FILE(send_hcmd, dbgfs_dir, 0200);
 	FWRT_DEBUGFS_ADD_FILE(enabled_severities, dbgfs_dir, 0200);
 	FWRT_DEBUGFS_ADD_FILE(fw_dbg_domain, dbgfs_dir, 0400);
+	FWRT_DEBUGFS_ADD_FILE(pnvm_stats, dbgfs_dir, 0400);
 #ifdef CPTCFG_IWLWIFI_DHC_PRIVATE
 	if (fw_has_capa(&fwrt->fw->ucode_capa,
 			IWL_UCODE_TLV_CAPA_TLC_OFFLOAD)) {
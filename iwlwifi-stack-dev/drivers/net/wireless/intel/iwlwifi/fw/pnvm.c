@@ -174,6 +174,7 @@ static int iwl_pnvm_parse(struct iwl_trans *trans, const u8 *data,
 			  size_t len)
 {
 	const struct iwl_ucode_tlv *tlv;
+	int err = -ENOENT;
 
 	IWL_DEBUG_FW(trans, "Parsing PNVM file\n");
 
@@ -215,6 +216,9 @@ static int iwl_pnvm_parse(struct iwl_trans *trans, const u8 *data,
 				ret = iwl_pnvm_handle_section(trans, data, len);
 				if (!ret)
 					return 0;
+				/* don't report e.g. -ENOMEM as no match */
+				if (ret != -ENOENT)
+					err = ret;
 			} else {
 				IWL_DEBUG_FW(trans, "SKU ID didn't match!\n");
 			}
@@ -224,7 +228,7 @@ static int iwl_pnvm_parse(struct iwl_trans *trans, const u8 *data,
 		}
 	}
 
-	return -ENOENT;
+	return err;
 }
 
 static int iwl_pnvm_get_from_fs(struct iwl_trans *trans, u8 **data, size_t *len)
@@ -258,18 +262,37 @@ static int iwl_pnvm_get_from_fs(struct iwl_trans *trans, u8 **data, size_t *len)
 int iwl_pnvm_load(struct iwl_trans *trans,
 		  struct iwl_notif_wait_data *notif_wait)
 {
+	struct iwl_pnvm_stats *stats = &trans->pnvm_stats;
 	u8 *data;
 	size_t len;
 	struct pnvm_sku_package *package;
 	struct iwl_notification_wait pnvm_wait;
 	static const u16 ntf_cmds[] = { WIDE_ID(REGULATORY_AND_NVM_GROUP,
 						PNVM_INIT_COMPLETE_NTFY) };
+	bool cached = true;
+	ktime_t start;
+	u32 load_us;
 	int ret;
 
 	/* if the SKU_ID is empty, there's nothing to do */
 	if (!trans->sku_id[0] && !trans->sku_id[1] && !trans->sku_id[2])
 		return 0;
 
+	/*
+	 * The data is matched against the SKU ID, so if the firmware now
+	 * reports a different one what we have is no longer valid.
+	 */
+	if ((trans->pnvm_loaded || trans->reduce_power_loaded) &&
+	    memcmp(trans->pnvm_sku_id, trans->sku_id, sizeof(trans->sku_id))) {
+		IWL_DEBUG_FW(trans, "SKU ID changed, reloading PNVM\n");
+		trans->pnvm_loaded = false;
+		trans->reduce_power_loaded = false;
+	}
+	memcpy(trans->pnvm_sku_id, trans->sku_id, sizeof(trans->sku_id));
+
+	stats->loads++;
+	start = ktime_get();
+
 	/*
 	 * If we already loaded (or tried to load) it before, we just
 	 * need to set it again.
@@ -281,6 +304,9 @@ int iwl_pnvm_load(struct iwl_trans *trans,
 		goto skip_parse;
 	}
 
+	cached = false;
+	stats->source = IWL_PNVM_SOURCE_NONE;
+
 	/* First attempt to get the PNVM from BIOS */
 	package = iwl_uefi_get_pnvm(trans, &len);
 	if (!IS_ERR_OR_NULL(package)) {
@@ -295,8 +321,10 @@ int iwl_pnvm_load(struct iwl_trans *trans,
 		/* free package regardless of whether kmemdup succeeded */
 		kfree(package);
 
-		if (data)
+		if (data) {
+			stats->source = IWL_PNVM_SOURCE_UEFI;
 			goto parse;
+		}
 	}
 
 	/* If it's not available, try from the filesystem */
@@ -311,15 +339,23 @@ int iwl_pnvm_load(struct iwl_trans *trans,
 
 		goto skip_parse;
 	}
+	stats->source = IWL_PNVM_SOURCE_FS;
 
 parse:
-	iwl_pnvm_parse(trans, data, len);
+	/*
+	 * No matching section won't appear on a restart either, but other
+	 * errors may be transient, so try again on the next start then.
+	 */
+	ret = iwl_pnvm_parse(trans, data, len);
+	if (ret == -ENOENT)
+		trans->pnvm_loaded = true;
 
 	kfree(data);
 
 skip_parse:
 	/* now try to get the reduce power table, if not loaded yet */
 	if (!trans->reduce_power_loaded) {
+		cached = false;
 		data = iwl_uefi_get_reduced_power(trans, &len);
 		if (IS_ERR_OR_NULL(data)) {
 			/*
@@ -338,15 +374,31 @@ skip_parse:
 		}
 	}
 
+	if (cached) {
+		stats->cache_hits++;
+	} else {
+		stats->parses++;
+		stats->last_parse_us = ktime_us_delta(ktime_get(), start);
+	}
+
 	iwl_init_notification_wait(notif_wait, &pnvm_wait,
 				   ntf_cmds, ARRAY_SIZE(ntf_cmds),
 				   iwl_pnvm_complete_fn, trans);
 
+	start = ktime_get();
+
 	/* kick the doorbell */
 	iwl_write_umac_prph(trans, UREG_DOORBELL_TO_ISR6,
 			    UREG_DOORBELL_TO_ISR6_PNVM);
 
-	return iwl_wait_notification(notif_wait, &pnvm_wait,
-				     MVM_UCODE_PNVM_TIMEOUT);
+	ret = iwl_wait_notification(notif_wait, &pnvm_wait,
+				    MVM_UCODE_PNVM_TIMEOUT);
+	if (!ret) {
+		load_us = ktime_us_delta(ktime_get(), start);
+		stats->last_load_us = load_us;
+		stats->max_load_us = max(stats->max_load_us, load_us);
+	}
+
+	return ret;
 }
 IWL_EXPORT_SYMBOL(iwl_pnvm_load);
@@ -348,6 +348,9 @@ static void iwl_dealloc_ucode(struct iwl_drv *drv)
 	for (i = 0; i < IWL_UCODE_TYPE_MAX; i++)
 		iwl_free_fw_img(drv, drv->fw.img + i);
 
+	/* a persistent DRAM copy of the image must not be reused anymore */
+	drv->trans->init_dram.img = NULL;
+
 	/* clear the data for the aborted load case */
 	memset(&drv->fw, 0, sizeof(drv->fw));
 }
@@ -2382,6 +2385,28 @@ MODULE_PARM_DESC(remove_when_gone,
 module_param_named(disable_11be, iwlwifi_mod_params.disable_11be, bool, 0444);
 MODULE_PARM_DESC(disable_11be, "Disable EHT capabilities (default: false)");
 
+module_param_named(fw_dram_persist, iwlwifi_mod_params.fw_dram_persist,
+		   bool, 0444);
+MODULE_PARM_DESC(fw_dram_persist,
+		 "Keep the firmware image in DMA memory across restarts (default: false)");
+
+module_param_named(napi_threaded, iwlwifi_mod_params.napi_threaded,
+		   bool, 0444);
+MODULE_PARM_DESC(napi_threaded,
+		 "Process RX queues in NAPI kernel threads (default: false)");
+
+module_param_named(napi_rt, iwlwifi_mod_params.napi_rt, bool, 0444);
+MODULE_PARM_DESC(napi_rt,
+		 "Run threaded NAPI with SCHED_FIFO priority (default: false)");
+
+module_param_named(napi_cpus, iwlwifi_mod_params.napi_cpus, charp, 0444);
+MODULE_PARM_DESC(napi_cpus,
+		 "CPU list for the threaded NAPI kernel threads (default: any)");
+
+module_param_named(txq_bql, iwlwifi_mod_params.txq_bql, bool, 0444);
+MODULE_PARM_DESC(txq_bql,
+		 "Dynamically limit the bytes in flight per TX queue (default: false)");
+
 #ifdef CPTCFG_IWLWIFI_PLATFORM_MOCKUPS
 module_param_named(enable_acpi_mockups,
 		   iwlwifi_mod_params.enable_acpi_mockups, bool, 0444);
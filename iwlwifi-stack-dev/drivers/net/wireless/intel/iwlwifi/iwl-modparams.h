@@ -65,6 +65,15 @@ enum iwl_uapsd_disable {
  * @remove_when_gone: remove an inaccessible device from the PCIe bus.
  * @enable_ini: enable new FW debug infratructure (INI TLVs)
  * @disable_11be: disable EHT capabilities, default = false.
+ * @fw_dram_persist: keep the firmware image in DMA memory across firmware
+ *	restarts instead of copying it again on every load, default = false.
+ * @napi_threaded: run the RX queues' NAPI in kernel threads rather than
+ *	in softirq context, default = false.
+ * @napi_rt: run the threaded NAPI kthreads with SCHED_FIFO, default = false.
+ * @napi_cpus: CPU list the threaded NAPI kthreads are allowed to run on,
+ *	default = any.
+ * @txq_bql: limit the bytes in flight on each TX queue dynamically,
+ *	default = false.
  */
 struct iwl_mod_params {
 	int swcrypto;
@@ -92,6 +101,11 @@ struct iwl_mod_params {
 	bool remove_when_gone;
 	u32 enable_ini;
 	bool disable_11be;
+	bool fw_dram_persist;
+	bool napi_threaded;
+	bool napi_rt;
+	char *napi_cpus;
+	bool txq_bql;
 
 #ifdef CPTCFG_IWLWIFI_PLATFORM_MOCKUPS
 	/**
@@ -132,6 +132,7 @@ enum {
 	IWL_XVT_CMD_ENHANCED_TX_DONE,
 	IWL_XVT_CMD_TX_CMD_RESP,
 	IWL_XVT_CMD_ECHO_NOTIF,
+	IWL_XVT_CMD_TX_GEN_SUMMARY,
 
 	/* Bus Tester Commands*/
 	IWL_TM_USER_CMD_SV_BUS_CONFIG = XVT_BUS_TESTER_BASE,
@@ -155,6 +156,7 @@ enum {
 	IWL_DRV_CMD_GET_RX_AGG_STATS,
 	IWL_DRV_CMD_CONFIG_RX_MPDU,
 	IWL_DRV_CMD_ECHO_NOTIF,
+	IWL_DRV_CMD_TX_GEN_START,
 };
 
 enum {
@@ -791,6 +793,90 @@ struct iwl_xvt_tx_done {
 	struct iwl_xvt_post_tx_data tx_data[];
 } __packed __aligned(4);
 
+/**
+ * struct iwl_xvt_tx_gen_start - IWL_DRV_CMD_TX_GEN_START input
+ * @summary_interval_ms: interval between IWL_XVT_CMD_TX_GEN_SUMMARY
+ *	notifications while transmitting, 0 - only send the final one
+ * @reserved: for alignment
+ * @tx_start: frames to transmit, as for IWL_DRV_CMD_TX_START. Each entry
+ *	of frames_data is built once and its copies share the payload, so
+ *	fragmentation isn't supported in this mode.
+ *
+ * Unlike IWL_DRV_CMD_TX_START, the frames of all the queues are sent
+ * without waiting for each other: a queue is only skipped while it has
+ * as many frames in flight as it has room for. IWL_DRV_CMD_TX_STOP
+ * stops the transmission.
+ */
+struct iwl_xvt_tx_gen_start {
+	u32 summary_interval_ms;
+	u32 reserved;
+	struct iwl_xvt_tx_start tx_start;
+} __packed __aligned(4);
+
+/**
+ * struct iwl_xvt_tx_gen_queue_stats - per queue generator statistics
+ * @queued: number of frames given to the transport
+ * @completed: number of frames reclaimed (TX_RSP or BA notification)
+ * @failed: number of frames the firmware reported as failed
+ * @ba_txed: number of MPDUs reported as sent by BA notifications
+ * @ba_acked: number of MPDUs reported as acked by BA notifications
+ * @queue: queue number
+ * @credits: frames that can still be queued at the time of the summary
+ * @reserved: for alignment
+ */
+struct iwl_xvt_tx_gen_queue_stats {
+	u64 queued;
+	u64 completed;
+	u64 failed;
+	u64 ba_txed;
+	u64 ba_acked;
+	u16 queue;
+	u16 credits;
+	u32 reserved;
+} __packed __aligned(4);
+
+/**
+ * struct iwl_xvt_tx_gen_summary - IWL_XVT_CMD_TX_GEN_SUMMARY notification
+ * @status: tx task handler error status, valid if @final is set
+ * @final: set in the last summary, once transmission is over
+ * @reserved: for alignment
+ * @elapsed_ms: time since the generator was started
+ * @num_of_queues: number of entries in @queues
+ * @queues: statistics of each allocated queue
+ */
+struct iwl_xvt_tx_gen_summary {
+	u32 status;
+	u8 final;
+	u8 reserved[3];
+	u32 elapsed_ms;
+	u32 num_of_queues;
+	struct iwl_xvt_tx_gen_queue_stats queues[];
+} __packed __aligned(4);
+
+/**
+ * struct iwl_xvt_rx_relay_hdr - header of a notification in the RX relay
+ * @cmd: the notification, as it would be sent over netlink
+ *	(e.g. IWL_TM_USER_CMD_NOTIF_RX_HDR)
+ * @len: length of @data, the record is padded to a multiple of 4 bytes
+ * @seq: sequence number of the notification
+ * @dropped: notifications dropped because the relay was full (or being
+ *	flushed) since the previous record
+ * @data: the notification payload
+ *
+ * When the rx_notif_relay debugfs control file was used to open the relay,
+ * RX notifications (except the PHY DB ones) are written to the relay
+ * buffer file rx_notif0 instead of being sent over netlink. Each
+ * sub-buffer starts with a u32 holding the number of padding bytes at its
+ * end, followed by records.
+ */
+struct iwl_xvt_rx_relay_hdr {
+	u32 cmd;
+	u32 len;
+	u32 seq;
+	u32 dropped;
+	u8 data[];
+} __packed __aligned(4);
+
 /*
  * struct iwl_xvt_get_rx_agg_stats - get rx aggregation statistics
  * @sta_id: station id of relevant ba
@@ -11,6 +11,7 @@
 #include <linux/mm.h> /* for page_address */
 #include <linux/lockdep.h>
 #include <linux/kernel.h>
+#include <linux/dynamic_queue_limits.h>
 
 #include "iwl-debug.h"
 #include "iwl-config.h"
@@ -247,6 +248,8 @@ struct iwl_rx_cmd_buffer {
 	bool _page_stolen;
 	u32 _rx_page_order;
 	unsigned int truesize;
+	/* RB completion time of latency sampled RBs, otherwise 0 */
+	u64 rb_done_ns;
 };
 
 static inline void *rxb_addr(struct iwl_rx_cmd_buffer *r)
@@ -561,6 +564,10 @@ struct iwl_trans_rxq_dma_data {
  * @set_pnvm: set the pnvm data in the prph scratch buffer, inside the
  *	context info.
  * @interrupts: disable/enable interrupts to transport
+ * @set_coalesce: set the RX interrupt coalescing time in usecs, or let the
+ *	transport adapt it to the RX rate if adaptive is set
+ * @get_coalesce: get the RX interrupt coalescing time currently in use and
+ *	whether it's adaptive
  */
 struct iwl_trans_ops {
 
@@ -650,6 +657,10 @@ struct iwl_trans_ops {
 	int (*imr_dma_data)(struct iwl_trans *trans,
 			    u32 dst_addr, u64 src_addr,
 			    u32 byte_cnt);
+	int (*set_coalesce)(struct iwl_trans *trans, u32 rx_usecs,
+			    bool adaptive);
+	void (*get_coalesce)(struct iwl_trans *trans, u32 *rx_usecs,
+			     bool *adaptive);
 
 };
 
@@ -743,18 +754,54 @@ struct iwl_fw_mon {
 	struct iwl_dram_data *frags;
 };
 
+/**
+ * enum iwl_pnvm_source - where the PNVM data was taken from
+ * @IWL_PNVM_SOURCE_NONE: no PNVM data was found
+ * @IWL_PNVM_SOURCE_UEFI: the PNVM was read from UEFI
+ * @IWL_PNVM_SOURCE_FS: the PNVM was read from the filesystem
+ */
+enum iwl_pnvm_source {
+	IWL_PNVM_SOURCE_NONE,
+	IWL_PNVM_SOURCE_UEFI,
+	IWL_PNVM_SOURCE_FS,
+};
+
+/**
+ * struct iwl_pnvm_stats - PNVM load statistics
+ * @loads: number of times the PNVM was handed to the firmware
+ * @cache_hits: loads that reused the already parsed data
+ * @parses: number of times the PNVM/reduce power data was read and parsed
+ * @source: where the cached PNVM came from, see &enum iwl_pnvm_source
+ * @last_parse_us: time spent reading and parsing the last time
+ * @last_load_us: time from kicking the firmware until it confirmed the
+ *	PNVM the last time
+ * @max_load_us: the longest such time seen so far
+ */
+struct iwl_pnvm_stats {
+	u32 loads;
+	u32 cache_hits;
+	u32 parses;
+	enum iwl_pnvm_source source;
+	u32 last_parse_us;
+	u32 last_load_us;
+	u32 max_load_us;
+};
+
 /**
  * struct iwl_self_init_dram - dram data used by self init process
  * @fw: lmac and umac dram data
  * @fw_cnt: total number of items in array
  * @paging: paging dram data
  * @paging_cnt: total number of items in array
+ * @img: the image @fw and @paging were loaded from, only kept when the
+ *	image stays in DRAM across firmware restarts (fw_dram_persist)
  */
 struct iwl_self_init_dram {
 	struct iwl_dram_data *fw;
 	int fw_cnt;
 	struct iwl_dram_data *paging;
 	int paging_cnt;
+	const struct fw_img *img;
 };
 
 /**
@@ -926,6 +973,10 @@ struct iwl_pcie_first_tb_buf {
  * @id: queue id
  * @low_mark: low watermark, resume queue if free space more than this
  * @high_mark: high watermark, stop queue if free space less than this
+ * @bql: the queue is limited by @dql in addition to the watermarks
+ * @dql: dynamic byte limit on the data in flight, adapted from the
+ *	completion rate like BQL, so frames wait in mac80211's queues
+ *	instead of the hardware ring
  *
  * A Tx queue consists of circular buffer of BDs (a.k.a. TFDs, transmit frame
  * descriptors) and required locking structures.
@@ -970,6 +1021,8 @@ struct iwl_txq {
 	int high_mark;
 
 	bool overflow_tx;
+	bool bql;
+	struct dql dql;
 };
 
 /**
@@ -1033,6 +1086,9 @@ struct iwl_trans_txqs {
  * @hw_rev_step: The mac step of the HW
  * @pm_support: set to true in start_hw if link pm is supported
  * @ltr_enabled: set to true if the LTR is enabled
+ * @pnvm_sku_id: the SKU ID the loaded PNVM/reduce power data was matched
+ *	against; if the firmware reports a different one they are parsed again
+ * @pnvm_stats: PNVM load statistics, see &struct iwl_pnvm_stats
  * @wide_cmd_header: true when ucode supports wide command header format
  * @wait_command_queue: wait queue for sync commands
  * @num_rx_queues: number of RX queues allocated by the transport;
@@ -1052,6 +1108,8 @@ struct iwl_trans_txqs {
  * @iwl_trans_txqs: transport tx queues data.
  * @mbx_addr_0_step: step address data 0
  * @mbx_addr_1_step: step address data 1
+ * @rx_lat_sample: stamp the completion time of one in this many RBs,
+ *	0 disables. Set by the op mode.
  */
 struct iwl_trans {
 	bool csme_own;
@@ -1082,6 +1140,8 @@ struct iwl_trans {
 	bool ltr_enabled;
 	u8 pnvm_loaded:1;
 	u8 reduce_power_loaded:1;
+	u32 pnvm_sku_id[3];
+	struct iwl_pnvm_stats pnvm_stats;
 
 	const struct iwl_hcmd_arr *command_groups;
 	int command_groups_size;
@@ -1120,6 +1180,8 @@ struct iwl_trans {
 	u32 mbx_addr_0_step;
 	u32 mbx_addr_1_step;
 
+	u32 rx_lat_sample;
+
 	/* pointer to trans specific struct */
 	/*Ensure that this pointer will always be aligned to sizeof pointer */
 	char trans_specific[] __aligned(sizeof(void *));
@@ -1633,6 +1695,25 @@ static inline void iwl_trans_interrupts(struct iwl_trans *trans, bool enable)
 		trans->ops->interrupts(trans, enable);
 }
 
+static inline int iwl_trans_set_coalesce(struct iwl_trans *trans,
+					 u32 rx_usecs, bool adaptive)
+{
+	if (!trans->ops->set_coalesce)
+		return -EOPNOTSUPP;
+
+	return trans->ops->set_coalesce(trans, rx_usecs, adaptive);
+}
+
+static inline int iwl_trans_get_coalesce(struct iwl_trans *trans,
+					 u32 *rx_usecs, bool *adaptive)
+{
+	if (!trans->ops->get_coalesce)
+		return -EOPNOTSUPP;
+
+	trans->ops->get_coalesce(trans, rx_usecs, adaptive);
+	return 0;
+}
+
 /*****************************************************
  * transport helper functions
  *****************************************************/
@@ -11,8 +11,47 @@
 
 #include "sap.h"
 
+#define IWL_MEI_PORT_HASH_SIZE	256
+
+/**
+ * enum iwl_mei_filter_eth_type - ethertypes some OOB filter can match
+ * @IWL_MEI_FILTER_ETH_IPV4: IPv4 (including the ICMPv6 filter, see net.c)
+ * @IWL_MEI_FILTER_ETH_ARP: ARP requests or replies
+ */
+enum iwl_mei_filter_eth_type {
+	IWL_MEI_FILTER_ETH_IPV4	= BIT(0),
+	IWL_MEI_FILTER_ETH_ARP	= BIT(1),
+};
+
+/**
+ * struct iwl_mei_filters - the OOB filters and their compiled form
+ * @rcu_head: used to free the filters
+ * @filters: the filters sent by CSME
+ * @has_eth: at least one layer 2 (multicast address) filter is enabled
+ * @eth_types: the ethertypes a frame can have to match a layer 3 filter,
+ *	see &enum iwl_mei_filter_eth_type
+ * @flex_any_port: a flex filter matches regardless of the ports
+ * @flex_dst_ports: hashed destination ports the flex filters look for
+ * @flex_src_ports: hashed source ports of the flex filters that don't
+ *	look at the destination port
+ *
+ * The compiled part is built by iwl_mei_compile_filters() when CSME sends
+ * new filters and lets the Rx path reject most frames with a few compares.
+ */
+struct iwl_mei_filters {
+	struct rcu_head rcu_head;
+	struct iwl_sap_oob_filters filters;
+	bool has_eth;
+	u8 eth_types;
+	bool flex_any_port;
+	DECLARE_BITMAP(flex_dst_ports, IWL_MEI_PORT_HASH_SIZE);
+	DECLARE_BITMAP(flex_src_ports, IWL_MEI_PORT_HASH_SIZE);
+};
+
+void iwl_mei_compile_filters(struct iwl_mei_filters *filters);
+
 rx_handler_result_t iwl_mei_rx_filter(struct sk_buff *skb,
-				      const struct iwl_sap_oob_filters *filters,
+				      const struct iwl_mei_filters *filters,
 				      bool *pass_to_csme);
 
 void iwl_mei_add_data_to_ring(struct sk_buff *skb, bool cb_tx);
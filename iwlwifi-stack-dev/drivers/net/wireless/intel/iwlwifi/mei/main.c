@@ -132,11 +132,6 @@ struct iwl_mei_shared_mem_ptrs {
 	size_t q_size[SAP_DIRECTION_MAX][SAP_QUEUE_IDX_MAX];
 };
 
-struct iwl_mei_filters {
-	struct rcu_head rcu_head;
-	struct iwl_sap_oob_filters filters;
-};
-
 /**
  * struct iwl_mei - holds the private date for iwl_mei
  *
@@ -444,8 +439,31 @@ static int iwl_mei_send_sap_msg_payload(struct mei_cl_device *cldev,
 	return iwl_mei_send_check_shared_area(cldev);
 }
 
+/*
+ * Copy @len bytes from @src (a linear buffer) or from @skb at @offset into
+ * the ring, starting at @wr and wrapping around at the end of the ring.
+ */
+static void iwl_mei_copy_to_ring(u8 *q_head, u32 q_sz, u32 wr,
+				 const struct sk_buff *skb, const void *src,
+				 u32 offset, u32 len)
+{
+	u32 first = min_t(u32, len, q_sz - wr);
+
+	if (skb) {
+		skb_copy_bits(skb, offset, q_head + wr, first);
+		skb_copy_bits(skb, offset + first, q_head, len - first);
+	} else {
+		memcpy(q_head + wr, src, first);
+		memcpy(q_head, src + first, len - first);
+	}
+}
+
 void iwl_mei_add_data_to_ring(struct sk_buff *skb, bool cb_tx)
 {
+	union {
+		struct iwl_sap_cb_data cb;
+		struct iwl_sap_hdr hdr;
+	} sap = {};
 	struct iwl_sap_q_ctrl_blk *notif_q;
 	struct iwl_sap_dir *dir;
 	struct iwl_mei *mei;
@@ -507,37 +525,27 @@ void iwl_mei_add_data_to_ring(struct sk_buff *skb, bool cb_tx)
 		goto out;
 	}
 
-	if (skb_headroom(skb) < hdr_sz) {
-		dev_err(&mei->cldev->dev,
-			"Not enough headroom in the skb to write the SAP header\n");
-		goto out;
-	}
+	/*
+	 * The SAP header is written to the ring directly, followed by the
+	 * frame itself, so that the skb doesn't need to be copied or have
+	 * room for the header.
+	 */
+	sap.hdr.len = cpu_to_le16(tx_sz - sizeof(sap.hdr));
+	sap.hdr.seq_num = cpu_to_le32(atomic_inc_return(&mei->sap_seq_no));
 
 	if (cb_tx) {
-		struct iwl_sap_cb_data *cb_hdr = skb_push(skb, sizeof(*cb_hdr));
-
-		memset(cb_hdr, 0, sizeof(*cb_hdr));
-		cb_hdr->hdr.type = cpu_to_le16(SAP_MSG_CB_DATA_PACKET);
-		cb_hdr->hdr.len = cpu_to_le16(skb->len - sizeof(cb_hdr->hdr));
-		cb_hdr->hdr.seq_num = cpu_to_le32(atomic_inc_return(&mei->sap_seq_no));
-		cb_hdr->to_me_filt_status = cpu_to_le32(BIT(CB_TX_DHCP_FILT_IDX));
-		cb_hdr->data_len = cpu_to_le32(skb->len - sizeof(*cb_hdr));
+		sap.hdr.type = cpu_to_le16(SAP_MSG_CB_DATA_PACKET);
+		sap.cb.to_me_filt_status = cpu_to_le32(BIT(CB_TX_DHCP_FILT_IDX));
+		sap.cb.data_len = cpu_to_le32(skb->len);
 		trace_iwlmei_sap_data(skb, IWL_SAP_TX_DHCP);
 	} else {
-		struct iwl_sap_hdr *hdr = skb_push(skb, sizeof(*hdr));
-
-		hdr->type = cpu_to_le16(SAP_MSG_DATA_PACKET);
-		hdr->len = cpu_to_le16(skb->len - sizeof(*hdr));
-		hdr->seq_num = cpu_to_le32(atomic_inc_return(&mei->sap_seq_no));
+		sap.hdr.type = cpu_to_le16(SAP_MSG_DATA_PACKET);
 		trace_iwlmei_sap_data(skb, IWL_SAP_TX_DATA_FROM_AIR);
 	}
 
-	if (wr + tx_sz <= q_sz) {
-		skb_copy_bits(skb, 0, q_head + wr, tx_sz);
-	} else {
-		skb_copy_bits(skb, 0, q_head + wr, q_sz - wr);
-		skb_copy_bits(skb, q_sz - wr, q_head, tx_sz - (q_sz - wr));
-	}
+	iwl_mei_copy_to_ring(q_head, q_sz, wr, NULL, &sap, 0, hdr_sz);
+	iwl_mei_copy_to_ring(q_head, q_sz, (wr + hdr_sz) % q_sz,
+			     skb, NULL, 0, skb->len);
 
 	WRITE_ONCE(notif_q->wr_ptr, cpu_to_le32((wr + tx_sz) % q_sz));
 
@@ -591,7 +599,7 @@ static rx_handler_result_t iwl_mei_rx_handler(struct sk_buff **pskb)
 	}
 
 	if (filters)
-		res = iwl_mei_rx_filter(skb, &filters->filters, &rx_for_csme);
+		res = iwl_mei_rx_filter(skb, filters, &rx_for_csme);
 	else
 		res = RX_HANDLER_PASS;
 
@@ -685,6 +693,7 @@ static void iwl_mei_handle_csme_filters(struct mei_cl_device *cldev,
 
 	/* Copy the OOB filters */
 	new_filters->filters = filters->filters;
+	iwl_mei_compile_filters(new_filters);
 
 	rcu_assign_pointer(mei->filters, new_filters);
 
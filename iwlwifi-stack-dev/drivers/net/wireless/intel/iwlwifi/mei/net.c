@@ -25,6 +25,50 @@
 #include "sap.h"
 #include "iwl-mei.h"
 
+static inline unsigned int iwl_mei_port_hash(__be16 port)
+{
+	u16 p = be16_to_cpu(port);
+
+	return (p ^ (p >> 8)) % IWL_MEI_PORT_HASH_SIZE;
+}
+
+void iwl_mei_compile_filters(struct iwl_mei_filters *filters)
+{
+	const struct iwl_sap_oob_filters *oob = &filters->filters;
+	u32 ipv4_flags = le32_to_cpu(oob->ipv4_filter.flags);
+	const struct iwl_sap_flex_filter *filt;
+
+	filters->has_eth = oob->eth_filters[0].flags & SAP_ETH_FILTER_ENABLED;
+
+	if (ipv4_flags & (SAP_IPV4_FILTER_ARP_REQ_PASS |
+			  SAP_IPV4_FILTER_ARP_RESP_PASS))
+		filters->eth_types |= IWL_MEI_FILTER_ETH_ARP;
+
+	/* the ICMPv6 filter is checked on IPv4 frames, see below */
+	if (ipv4_flags & SAP_IPV4_FILTER_ICMP_PASS ||
+	    oob->icmpv6_flags & cpu_to_le32(SAP_ICMPV6_FILTER_ENABLED))
+		filters->eth_types |= IWL_MEI_FILTER_ETH_IPV4;
+
+	for (filt = &oob->flex_filters[0];
+	     filt < &oob->flex_filters[0] + ARRAY_SIZE(oob->flex_filters);
+	     filt++) {
+		/* Same assumption as in iwl_mei_rx_filter_tcp_udp() */
+		if (!(filt->flags & SAP_FLEX_FILTER_ENABLED))
+			break;
+
+		filters->eth_types |= IWL_MEI_FILTER_ETH_IPV4;
+
+		if (filt->dst_port)
+			__set_bit(iwl_mei_port_hash(filt->dst_port),
+				  filters->flex_dst_ports);
+		else if (filt->src_port)
+			__set_bit(iwl_mei_port_hash(filt->src_port),
+				  filters->flex_src_ports);
+		else
+			filters->flex_any_port = true;
+	}
+}
+
 /*
  * Returns true if further filtering should be stopped. Only in that case
  * pass_to_csme and rx_handler_res are set. Otherwise, next level of filters
@@ -139,8 +183,17 @@ iwl_mei_rx_filter_tcp_udp(struct sk_buff *skb, bool  ip_match,
 			  const struct iwl_sap_oob_filters *filters,
 			  rx_handler_result_t *rx_handler_res)
 {
+	const struct iwl_mei_filters *compiled =
+		container_of(filters, struct iwl_mei_filters, filters);
+	const struct udphdr *udp = udp_hdr(skb);
 	const struct iwl_sap_flex_filter *filt;
 
+	/* no filter can match those ports, don't walk the filters */
+	if (!compiled->flex_any_port &&
+	    !test_bit(iwl_mei_port_hash(udp->dest), compiled->flex_dst_ports) &&
+	    !test_bit(iwl_mei_port_hash(udp->source), compiled->flex_src_ports))
+		return false;
+
 	for (filt = &filters->flex_filters[0];
 	     filt < &filters->flex_filters[0] + ARRAY_SIZE(filters->flex_filters);
 	     filt++) {
@@ -170,8 +223,8 @@ iwl_mei_rx_filter_tcp_udp(struct sk_buff *skb, bool  ip_match,
 		 * Both are big endian words.
 		 * Use a UDP header and that will work for TCP as well.
 		 */
-		if ((filt->src_port && filt->src_port != udp_hdr(skb)->source) ||
-		    (filt->dst_port && filt->dst_port != udp_hdr(skb)->dest))
+		if ((filt->src_port && filt->src_port != udp->source) ||
+		    (filt->dst_port && filt->dst_port != udp->dest))
 			continue;
 
 		if (filt->flags & SAP_FLEX_FILTER_COPY)
@@ -276,14 +329,16 @@ static bool iwl_mei_rx_filter_ipv6(struct sk_buff *skb,
 
 static rx_handler_result_t
 iwl_mei_rx_pass_to_csme(struct sk_buff *skb,
-			const struct iwl_sap_oob_filters *filters,
+			const struct iwl_mei_filters *compiled,
 			bool *pass_to_csme)
 {
+	const struct iwl_sap_oob_filters *filters = &compiled->filters;
 	const struct ethhdr *ethhdr = (void *)skb_mac_header(skb);
 	rx_handler_result_t rx_handler_res = RX_HANDLER_PASS;
 	bool (*filt_handler)(struct sk_buff *skb,
 			     const struct iwl_sap_oob_filters *filters,
 			     rx_handler_result_t *rx_handler_res);
+	u8 eth_type;
 
 	/*
 	 * skb->data points the IP header / ARP header and the ETH header
@@ -301,6 +356,13 @@ iwl_mei_rx_pass_to_csme(struct sk_buff *skb,
 	if (skb_headroom(skb) < sizeof(*ethhdr))
 		return RX_HANDLER_PASS;
 
+	/* MCAST frames can only reach ME through a layer 2 filter */
+	if (!compiled->has_eth && is_multicast_ether_addr(ethhdr->h_dest) &&
+	    !is_broadcast_ether_addr(ethhdr->h_dest)) {
+		*pass_to_csme = false;
+		return rx_handler_res;
+	}
+
 	if (iwl_mei_rx_filter_eth(ethhdr, filters,
 				  pass_to_csme, &rx_handler_res))
 		return rx_handler_res;
@@ -308,46 +370,52 @@ iwl_mei_rx_pass_to_csme(struct sk_buff *skb,
 	switch (skb->protocol) {
 	case htons(ETH_P_IP):
 		filt_handler = iwl_mei_rx_filter_ipv4;
+		eth_type = IWL_MEI_FILTER_ETH_IPV4;
 		break;
 	case htons(ETH_P_ARP):
 		filt_handler = iwl_mei_rx_filter_arp;
+		eth_type = IWL_MEI_FILTER_ETH_ARP;
 		break;
 	case htons(ETH_P_IPV6):
+		/* no IPv6 filtering yet, see iwl_mei_rx_filter_ipv6() */
 		filt_handler = iwl_mei_rx_filter_ipv6;
+		eth_type = 0;
 		break;
 	default:
 		*pass_to_csme = false;
 		return rx_handler_res;
 	}
 
+	/* none of the layer 3 filters can match, no need to parse more */
+	if (!(compiled->eth_types & eth_type)) {
+		*pass_to_csme = false;
+		return rx_handler_res;
+	}
+
 	*pass_to_csme = filt_handler(skb, filters, &rx_handler_res);
 
 	return rx_handler_res;
 }
 
-rx_handler_result_t iwl_mei_rx_filter(struct sk_buff *orig_skb,
-				      const struct iwl_sap_oob_filters *filters,
+rx_handler_result_t iwl_mei_rx_filter(struct sk_buff *skb,
+				      const struct iwl_mei_filters *filters,
 				      bool *pass_to_csme)
 {
 	rx_handler_result_t ret;
-	struct sk_buff *skb;
+	unsigned int mac_len;
 
-	ret = iwl_mei_rx_pass_to_csme(orig_skb, filters, pass_to_csme);
+	ret = iwl_mei_rx_pass_to_csme(skb, filters, pass_to_csme);
 
 	if (!*pass_to_csme)
 		return RX_HANDLER_PASS;
 
-	if (ret == RX_HANDLER_PASS) {
-		skb = skb_copy(orig_skb, GFP_ATOMIC);
-
-		if (!skb)
-			return RX_HANDLER_PASS;
-	} else {
-		skb = orig_skb;
-	}
-
-	/* CSME wants the MAC header as well, push it back */
-	skb_push(skb, skb->data - skb_mac_header(skb));
+	/*
+	 * CSME wants the MAC header as well, push it back. The ring writer
+	 * copies the frame without modifying it, so the same skb can be given
+	 * to the stack afterwards when it needs to get the frame too.
+	 */
+	mac_len = skb->data - skb_mac_header(skb);
+	skb_push(skb, mac_len);
 
 	/*
 	 * Add the packet that CSME wants to get to the ring. Don't send the
@@ -361,7 +429,7 @@ rx_handler_result_t iwl_mei_rx_filter(struct sk_buff *orig_skb,
 	 * for us
 	 */
 	if (ret == RX_HANDLER_PASS)
-		dev_kfree_skb(skb);
+		skb_pull(skb, mac_len);
 
 	return ret;
 }
@@ -397,10 +465,7 @@ void iwl_mei_tx_copy_to_csme(struct sk_buff *origskb, unsigned int ivlen)
 	memcpy(ethhdr.h_dest, ieee80211_get_DA(hdr), ETH_ALEN);
 	memcpy(ethhdr.h_source, ieee80211_get_SA(hdr), ETH_ALEN);
 
-	/*
-	 * Remove the ieee80211 header + IV + SNAP but leave the ethertype
-	 * We still have enough headroom for the sap header.
-	 */
+	/* Remove the ieee80211 header + IV + SNAP but leave the ethertype */
 	pskb_pull(skb, ieee80211_hdrlen(hdr->frame_control) + ivlen + 6);
 	eth = skb_push(skb, sizeof(ethhdr.h_dest) + sizeof(ethhdr.h_source));
 	memcpy(eth, &ethhdr, sizeof(ethhdr.h_dest) + sizeof(ethhdr.h_source));
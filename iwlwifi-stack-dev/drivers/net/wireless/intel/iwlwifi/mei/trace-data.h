@@ -18,24 +18,6 @@ enum iwl_sap_data_trace_type {
 	IWL_SAP_RX_DATA_DROPPED_FROM_AIR,
 	IWL_SAP_TX_DHCP,
 };
-
-static inline size_t
-iwlmei_sap_data_offset(enum iwl_sap_data_trace_type trace_type)
-{
-	switch (trace_type) {
-	case IWL_SAP_RX_DATA_TO_AIR:
-		return 0;
-	case IWL_SAP_TX_DATA_FROM_AIR:
-	case IWL_SAP_RX_DATA_DROPPED_FROM_AIR:
-		return sizeof(struct iwl_sap_hdr);
-	case IWL_SAP_TX_DHCP:
-		return sizeof(struct iwl_sap_cb_data);
-	default:
-		WARN_ON_ONCE(1);
-	}
-
-	return 0;
-}
 #endif
 
 #define __IWLWIFI_DEVICE_TRACE_IWLWIFI_SAP_DATA
@@ -52,15 +34,12 @@ TRACE_EVENT(iwlmei_sap_data,
 		 enum iwl_sap_data_trace_type trace_type),
 	TP_ARGS(skb, trace_type),
 	TP_STRUCT__entry(
-		__dynamic_array(u8, data,
-				skb->len - iwlmei_sap_data_offset(trace_type))
+		__dynamic_array(u8, data, skb->len)
 		__field(u32, trace_type)
 	),
 	TP_fast_assign(
-		size_t offset = iwlmei_sap_data_offset(trace_type);
 		__entry->trace_type = trace_type;
-		skb_copy_bits(skb, offset, __get_dynamic_array(data),
-			      skb->len - offset);
+		skb_copy_bits(skb, 0, __get_dynamic_array(data), skb->len);
 	),
 	TP_printk("sap_data:trace_type %d len %d",
 		  __entry->trace_type, __get_dynamic_array_len(data))
@@ -14,6 +14,8 @@
 #include "sta.h"
 #include "iwl-io.h"
 #include "debugfs.h"
+#include "rss.h"
+#include "dp-lat.h"
 #include "iwl-modparams.h"
 #include "fw/error-dump.h"
 #include "fw/api/phy-ctxt.h"
@@ -1491,6 +1493,43 @@ static ssize_t iwl_dbgfs_drv_rx_stats_read(struct file *file,
 					  &mvm->drv_rx_stats);
 }
 
+static ssize_t iwl_dbgfs_tx_compl_stats_read(struct file *file,
+					     char __user *user_buf,
+					     size_t count, loff_t *ppos)
+{
+	struct iwl_mvm *mvm = file->private_data;
+	struct iwl_mvm_tx_compl *tc = &mvm->tx_compl;
+	char buf[256];
+	int pos = 0, bufsz = sizeof(buf);
+	u64 notifs, lat_sum_ns;
+
+	if (!tc->enabled)
+		return -EOPNOTSUPP;
+
+	spin_lock_bh(&tc->lock);
+	notifs = tc->stats.notifs;
+	lat_sum_ns = tc->stats.lat_sum_ns;
+	pos += scnprintf(buf + pos, bufsz - pos, "notifs: %llu\n", notifs);
+	pos += scnprintf(buf + pos, bufsz - pos, "polls: %llu\n",
+			 tc->stats.polls);
+	pos += scnprintf(buf + pos, bufsz - pos, "pending: %u\n",
+			 tc->stats.pending);
+	pos += scnprintf(buf + pos, bufsz - pos, "max_pending: %u\n",
+			 tc->stats.max_pending);
+	pos += scnprintf(buf + pos, bufsz - pos, "pool_misses: %u\n",
+			 tc->stats.pool_misses);
+	pos += scnprintf(buf + pos, bufsz - pos, "inline_fallbacks: %u\n",
+			 tc->stats.inline_fallbacks);
+	pos += scnprintf(buf + pos, bufsz - pos, "avg_latency_us: %llu\n",
+			 notifs ? div64_u64(lat_sum_ns, notifs) / NSEC_PER_USEC :
+				  0);
+	pos += scnprintf(buf + pos, bufsz - pos, "max_latency_us: %llu\n",
+			 div_u64(tc->stats.lat_max_ns, NSEC_PER_USEC));
+	spin_unlock_bh(&tc->lock);
+
+	return simple_read_from_buffer(user_buf, count, ppos, buf, pos);
+}
+
 static ssize_t iwl_dbgfs_fw_restart_write(struct iwl_mvm *mvm, char *buf,
 					  size_t count, loff_t *ppos)
 {
@@ -1585,18 +1624,13 @@ static ssize_t iwl_dbgfs_indirection_tbl_write(struct iwl_mvm *mvm,
 					       char *buf, size_t count,
 					       loff_t *ppos)
 {
-	struct iwl_rss_config_cmd cmd = {
-		.flags = cpu_to_le32(IWL_RSS_ENABLE),
-		.hash_mask = IWL_RSS_HASH_TYPE_IPV4_TCP |
-			     IWL_RSS_HASH_TYPE_IPV4_UDP |
-			     IWL_RSS_HASH_TYPE_IPV4_PAYLOAD |
-			     IWL_RSS_HASH_TYPE_IPV6_TCP |
-			     IWL_RSS_HASH_TYPE_IPV6_UDP |
-			     IWL_RSS_HASH_TYPE_IPV6_PAYLOAD,
-	};
+	u8 indir[IWL_RSS_INDIRECTION_TABLE_SIZE];
 	int ret, i, num_repeats, nbytes = count / 2;
 
-	ret = hex2bin(cmd.indirection_table, buf, nbytes);
+	if (!iwl_mvm_rss_supported(mvm))
+		return -EOPNOTSUPP;
+
+	ret = hex2bin(indir, buf, nbytes);
 	if (ret)
 		return ret;
 
@@ -1607,25 +1641,254 @@ static ssize_t iwl_dbgfs_indirection_tbl_write(struct iwl_mvm *mvm,
 	 * indirecting RSS hash results to queues 1, 2, 15 (skipping
 	 * queues 3 - 14).
 	 */
-	num_repeats = ARRAY_SIZE(cmd.indirection_table) / nbytes;
+	num_repeats = ARRAY_SIZE(indir) / nbytes;
 	for (i = 1; i < num_repeats; i++)
-		memcpy(&cmd.indirection_table[i * nbytes],
-		       cmd.indirection_table, nbytes);
+		memcpy(&indir[i * nbytes], indir, nbytes);
 	/* handle cut in the middle pattern for the last places */
-	memcpy(&cmd.indirection_table[i * nbytes], cmd.indirection_table,
-	       ARRAY_SIZE(cmd.indirection_table) % nbytes);
+	memcpy(&indir[i * nbytes], indir, ARRAY_SIZE(indir) % nbytes);
+
+	mutex_lock(&mvm->mutex);
+	ret = iwl_mvm_rss_set_indir(mvm, indir);
+	mutex_unlock(&mvm->mutex);
 
-	netdev_rss_key_fill(cmd.secret_key, sizeof(cmd.secret_key));
+	return ret ?: count;
+}
+
+static ssize_t iwl_dbgfs_rss_rebalance_read(struct file *file,
+					    char __user *user_buf,
+					    size_t count, loff_t *ppos)
+{
+	struct iwl_mvm *mvm = file->private_data;
+	char buf[16 * IWL_MAX_RX_HW_QUEUES + 16];
+	int i, pos = 0, bufsz = sizeof(buf);
 
 	mutex_lock(&mvm->mutex);
-	if (iwl_mvm_firmware_running(mvm))
-		ret = iwl_mvm_send_cmd_pdu(mvm, RSS_CONFIG_CMD, 0,
-					   sizeof(cmd), &cmd);
+	pos += scnprintf(buf + pos, bufsz - pos, "%d\n", mvm->rss.rebalance);
+	for (i = 1; i < mvm->trans->num_rx_queues; i++)
+		pos += scnprintf(buf + pos, bufsz - pos, "q%d: %u\n", i,
+				 READ_ONCE(mvm->rss.rx_pkts[i]));
+	mutex_unlock(&mvm->mutex);
+
+	return simple_read_from_buffer(user_buf, count, ppos, buf, pos);
+}
+
+static ssize_t iwl_dbgfs_rss_rebalance_write(struct iwl_mvm *mvm, char *buf,
+					     size_t count, loff_t *ppos)
+{
+	bool enable;
+	int ret;
+
+	if (!iwl_mvm_rss_supported(mvm))
+		return -EOPNOTSUPP;
+
+	ret = kstrtobool(buf, &enable);
+	if (ret)
+		return ret;
+
+	mutex_lock(&mvm->mutex);
+	iwl_mvm_rss_set_rebalance(mvm, enable);
+	mutex_unlock(&mvm->mutex);
+
+	return count;
+}
+
+static ssize_t iwl_dbgfs_stats_cache_read(struct file *file,
+					  char __user *user_buf,
+					  size_t count, loff_t *ppos)
+{
+	struct iwl_mvm *mvm = file->private_data;
+	struct iwl_mvm_stats_cache *cache = &mvm->stats_cache;
+	char buf[128];
+	int pos = 0, bufsz = sizeof(buf);
+
+	pos += scnprintf(buf + pos, bufsz - pos, "max_age_ms: %u\n",
+			 READ_ONCE(cache->max_age_ms));
+	pos += scnprintf(buf + pos, bufsz - pos, "hits: %d\n",
+			 atomic_read(&cache->hits));
+	pos += scnprintf(buf + pos, bufsz - pos, "misses: %d\n",
+			 atomic_read(&cache->misses));
+	if (READ_ONCE(cache->valid))
+		pos += scnprintf(buf + pos, bufsz - pos, "age_ms: %u\n",
+				 jiffies_to_msecs(jiffies -
+						  READ_ONCE(cache->updated)));
 	else
-		ret = 0;
+		pos += scnprintf(buf + pos, bufsz - pos, "age_ms: none\n");
+
+	return simple_read_from_buffer(user_buf, count, ppos, buf, pos);
+}
+
+static ssize_t iwl_dbgfs_stats_cache_write(struct iwl_mvm *mvm, char *buf,
+					   size_t count, loff_t *ppos)
+{
+	u32 max_age_ms;
+	int ret;
+
+	/* 0 disables the cache, every query goes to the firmware */
+	ret = kstrtou32(buf, 0, &max_age_ms);
+	if (ret)
+		return ret;
+
+	WRITE_ONCE(mvm->stats_cache.max_age_ms, max_age_ms);
+
+	return count;
+}
+
+static ssize_t iwl_dbgfs_regd_cache_read(struct file *file,
+					 char __user *user_buf,
+					 size_t count, loff_t *ppos)
+{
+	struct iwl_mvm *mvm = file->private_data;
+	struct iwl_mvm_regd_cache *cache = &mvm->regd_cache;
+	struct iwl_mvm_regd_cache_entry *entry;
+	const size_t bufsz = 1024;
+	int i, pos = 0;
+	ssize_t ret;
+	char *buf;
+
+	buf = kzalloc(bufsz, GFP_KERNEL);
+	if (!buf)
+		return -ENOMEM;
+
+	mutex_lock(&mvm->mutex);
+	pos += scnprintf(buf + pos, bufsz - pos, "hits: %u\n", cache->hits);
+	pos += scnprintf(buf + pos, bufsz - pos, "misses: %u\n",
+			 cache->misses);
+	pos += scnprintf(buf + pos, bufsz - pos, "updates: %u\n",
+			 cache->updates);
+	pos += scnprintf(buf + pos, bufsz - pos, "skipped: %u\n",
+			 cache->skipped);
+	pos += scnprintf(buf + pos, bufsz - pos,
+			 "query_us: last %llu max %llu\n",
+			 div_u64(cache->query_last_ns, NSEC_PER_USEC),
+			 div_u64(cache->query_max_ns, NSEC_PER_USEC));
+	pos += scnprintf(buf + pos, bufsz - pos,
+			 "set_us: last %llu max %llu\n",
+			 div_u64(cache->set_last_ns, NSEC_PER_USEC),
+			 div_u64(cache->set_max_ns, NSEC_PER_USEC));
+
+	for (i = 0; i < ARRAY_SIZE(cache->entries); i++) {
+		entry = &cache->entries[i];
+		if (!entry->regd)
+			continue;
+
+		pos += scnprintf(buf + pos, bufsz - pos,
+				 "entry %d: mcc %c%c cap 0x%x geo_info 0x%x ver %u channels %u rules %u\n",
+				 i, entry->mcc >> 8, entry->mcc & 0xff,
+				 entry->cap, entry->geo_info, entry->resp_ver,
+				 entry->n_channels, entry->regd->n_reg_rules);
+	}
 	mutex_unlock(&mvm->mutex);
 
-	return ret ?: count;
+	ret = simple_read_from_buffer(user_buf, count, ppos, buf, pos);
+	kfree(buf);
+
+	return ret;
+}
+
+static ssize_t iwl_dbgfs_regd_cache_write(struct iwl_mvm *mvm, char *buf,
+					  size_t count, loff_t *ppos)
+{
+	struct iwl_mvm_regd_cache *cache = &mvm->regd_cache;
+	bool flush;
+	int ret;
+
+	/* writing 1 drops the cached regdomains, any write clears the stats */
+	ret = kstrtobool(buf, &flush);
+	if (ret)
+		return ret;
+
+	mutex_lock(&mvm->mutex);
+	if (flush)
+		iwl_mvm_regd_cache_flush(mvm);
+	cache->hits = 0;
+	cache->misses = 0;
+	cache->updates = 0;
+	cache->skipped = 0;
+	cache->query_last_ns = 0;
+	cache->query_max_ns = 0;
+	cache->set_last_ns = 0;
+	cache->set_max_ns = 0;
+	mutex_unlock(&mvm->mutex);
+
+	return count;
+}
+
+static const char * const iwl_mvm_dp_lat_stage_names[] = {
+	[IWL_MVM_DP_LAT_RX_AIR] = "rx_air_to_rb",
+	[IWL_MVM_DP_LAT_RX_REORDER] = "rx_rb_to_release",
+	[IWL_MVM_DP_LAT_RX_DELIVER] = "rx_release_to_mac80211_done",
+	[IWL_MVM_DP_LAT_TX_FQ] = "tx_fq_enqueue_to_dequeue",
+	[IWL_MVM_DP_LAT_TX_DRV] = "tx_dequeue_to_trans",
+	[IWL_MVM_DP_LAT_TX_STATUS] = "tx_trans_to_status",
+};
+
+static ssize_t iwl_dbgfs_dp_latency_read(struct file *file,
+					 char __user *user_buf,
+					 size_t count, loff_t *ppos)
+{
+	struct iwl_mvm *mvm = file->private_data;
+	struct iwl_mvm_dp_lat *lat = &mvm->dp_lat;
+	int stage, i, pos = 0;
+	const size_t bufsz = 4096;
+	ssize_t ret;
+	char *buf;
+
+	BUILD_BUG_ON(ARRAY_SIZE(iwl_mvm_dp_lat_stage_names) !=
+		     IWL_MVM_DP_LAT_NUM_STAGES);
+
+	buf = kzalloc(bufsz, GFP_KERNEL);
+	if (!buf)
+		return -ENOMEM;
+
+	pos += scnprintf(buf + pos, bufsz - pos, "rate: %u\n",
+			 READ_ONCE(lat->rate));
+	pos += scnprintf(buf + pos, bufsz - pos,
+			 "buckets: <1us, then [2^(n-1), 2^n) us, last is open\n");
+
+	spin_lock_bh(&lat->lock);
+	for (stage = 0; stage < IWL_MVM_DP_LAT_NUM_STAGES; stage++) {
+		u64 samples = 0;
+
+		for (i = 0; i < IWL_MVM_DP_LAT_BUCKETS; i++)
+			samples += lat->hist[stage][i];
+
+		pos += scnprintf(buf + pos, bufsz - pos,
+				 "%s: samples %llu avg_us %llu max_us %llu\n",
+				 iwl_mvm_dp_lat_stage_names[stage], samples,
+				 samples ?
+				 div64_u64(lat->sum_ns[stage], samples) /
+				 NSEC_PER_USEC : 0,
+				 div_u64(lat->max_ns[stage], NSEC_PER_USEC));
+		pos += scnprintf(buf + pos, bufsz - pos, " ");
+		for (i = 0; i < IWL_MVM_DP_LAT_BUCKETS; i++)
+			pos += scnprintf(buf + pos, bufsz - pos, " %llu",
+					 lat->hist[stage][i]);
+		pos += scnprintf(buf + pos, bufsz - pos, "\n");
+	}
+	spin_unlock_bh(&lat->lock);
+
+	ret = simple_read_from_buffer(user_buf, count, ppos, buf, pos);
+	kfree(buf);
+
+	return ret;
+}
+
+static ssize_t iwl_dbgfs_dp_latency_write(struct iwl_mvm *mvm, char *buf,
+					  size_t count, loff_t *ppos)
+{
+	u32 rate;
+	int ret;
+
+	/* sample one in rate frames, 0 disables; also clears the histograms */
+	ret = kstrtou32(buf, 0, &rate);
+	if (ret)
+		return ret;
+
+	mutex_lock(&mvm->mutex);
+	iwl_mvm_dp_lat_set_rate(mvm, rate);
+	mutex_unlock(&mvm->mutex);
+
+	return count;
 }
 
 static ssize_t iwl_dbgfs_inject_packet_write(struct iwl_mvm *mvm,
@@ -2628,6 +2891,7 @@ MVM_DEBUGFS_READ_FILE_OPS(bt_cmd);
 MVM_DEBUGFS_READ_WRITE_FILE_OPS(disable_power_off, 64);
 MVM_DEBUGFS_READ_FILE_OPS(fw_rx_stats);
 MVM_DEBUGFS_READ_FILE_OPS(drv_rx_stats);
+MVM_DEBUGFS_READ_FILE_OPS(tx_compl_stats);
 MVM_DEBUGFS_READ_FILE_OPS(fw_ver);
 MVM_DEBUGFS_READ_FILE_OPS(phy_integration_ver);
 MVM_DEBUGFS_READ_FILE_OPS(tas_get_status);
@@ -2641,6 +2905,10 @@ MVM_DEBUGFS_WRITE_FILE_OPS(fw_dbg_collect, 64);
 MVM_DEBUGFS_WRITE_FILE_OPS(dbg_time_point, 64);
 MVM_DEBUGFS_WRITE_FILE_OPS(indirection_tbl,
 			   (IWL_RSS_INDIRECTION_TABLE_SIZE * 2));
+MVM_DEBUGFS_READ_WRITE_FILE_OPS(rss_rebalance, 8);
+MVM_DEBUGFS_READ_WRITE_FILE_OPS(stats_cache, 16);
+MVM_DEBUGFS_READ_WRITE_FILE_OPS(dp_latency, 16);
+MVM_DEBUGFS_READ_WRITE_FILE_OPS(regd_cache, 8);
 MVM_DEBUGFS_WRITE_FILE_OPS(inject_packet, 512);
 MVM_DEBUGFS_WRITE_FILE_OPS(inject_beacon_ie, 512);
 MVM_DEBUGFS_WRITE_FILE_OPS(inject_beacon_ie_restore, 512);
@@ -2864,6 +3132,7 @@ void iwl_mvm_dbgfs_register(struct iwl_mvm *mvm)
 	MVM_DEBUGFS_ADD_FILE(fw_ver, mvm->debugfs_dir, 0400);
 	MVM_DEBUGFS_ADD_FILE(fw_rx_stats, mvm->debugfs_dir, 0400);
 	MVM_DEBUGFS_ADD_FILE(drv_rx_stats, mvm->debugfs_dir, 0400);
+	MVM_DEBUGFS_ADD_FILE(tx_compl_stats, mvm->debugfs_dir, 0400);
 	MVM_DEBUGFS_ADD_FILE(fw_restart, mvm->debugfs_dir, 0200);
 	MVM_DEBUGFS_ADD_FILE(fw_nmi, mvm->debugfs_dir, 0200);
 	MVM_DEBUGFS_ADD_FILE(bt_tx_prio, mvm->debugfs_dir, 0200);
@@ -2875,6 +3144,10 @@ void iwl_mvm_dbgfs_register(struct iwl_mvm *mvm)
 	MVM_DEBUGFS_ADD_FILE(dbg_time_point, mvm->debugfs_dir, 0200);
 	MVM_DEBUGFS_ADD_FILE(send_echo_cmd, mvm->debugfs_dir, 0200);
 	MVM_DEBUGFS_ADD_FILE(indirection_tbl, mvm->debugfs_dir, 0200);
+	MVM_DEBUGFS_ADD_FILE(rss_rebalance, mvm->debugfs_dir, 0600);
+	MVM_DEBUGFS_ADD_FILE(stats_cache, mvm->debugfs_dir, 0600);
+	MVM_DEBUGFS_ADD_FILE(dp_latency, mvm->debugfs_dir, 0600);
+	MVM_DEBUGFS_ADD_FILE(regd_cache, mvm->debugfs_dir, 0600);
 	MVM_DEBUGFS_ADD_FILE(inject_packet, mvm->debugfs_dir, 0200);
 	MVM_DEBUGFS_ADD_FILE(inject_beacon_ie, mvm->debugfs_dir, 0200);
 	MVM_DEBUGFS_ADD_FILE(inject_beacon_ie_restore, mvm->debugfs_dir, 0200);
@@ -0,0 +1,224 @@
+// SPDX-License-Identifier: GPL-2.0 OR BSD-3-Clause
+/*
+ * Copyright (C) 2023 Intel Corporation
+ */
+#include <net/codel.h>
+#include "mvm.h"
+#include "dp-lat.h"
+
+/* refresh the GP2 reference often enough for the clock drift not to show */
+#define IWL_MVM_DP_LAT_REF_INTERVAL	(HZ / 10)
+/* a sampled frame that wasn't seen for this long was dropped somewhere */
+#define IWL_MVM_DP_LAT_TIMEOUT		HZ
+
+/* marks a slot that is being filled in, never matches a real frame */
+#define IWL_MVM_DP_LAT_CLAIMED		((struct sk_buff *)ERR_PTR(-EBUSY))
+
+static void iwl_mvm_dp_lat_ref_wk(struct work_struct *wk)
+{
+	struct iwl_mvm *mvm = container_of(wk, struct iwl_mvm,
+					   dp_lat.ref_wk.work);
+	struct iwl_mvm_dp_lat *lat = &mvm->dp_lat;
+	u64 now = 0;
+	u32 gp2 = 0;
+
+	mutex_lock(&mvm->mutex);
+	if (!READ_ONCE(lat->rate)) {
+		mutex_unlock(&mvm->mutex);
+		return;
+	}
+
+	if (iwl_mvm_firmware_running(mvm)) {
+		gp2 = iwl_mvm_get_systime(mvm);
+		now = ktime_get_ns();
+	}
+
+	spin_lock_bh(&lat->lock);
+	lat->gp2_ref = gp2;
+	lat->gp2_ref_ns = now;
+	spin_unlock_bh(&lat->lock);
+	mutex_unlock(&mvm->mutex);
+
+	schedule_delayed_work(&lat->ref_wk, IWL_MVM_DP_LAT_REF_INTERVAL);
+}
+
+void iwl_mvm_dp_lat_init(struct iwl_mvm *mvm)
+{
+	spin_lock_init(&mvm->dp_lat.lock);
+	INIT_DELAYED_WORK(&mvm->dp_lat.ref_wk, iwl_mvm_dp_lat_ref_wk);
+}
+
+void iwl_mvm_dp_lat_set_rate(struct iwl_mvm *mvm, u32 rate)
+{
+	struct iwl_mvm_dp_lat *lat = &mvm->dp_lat;
+	int i;
+
+	lockdep_assert_held(&mvm->mutex);
+
+	WRITE_ONCE(mvm->trans->rx_lat_sample, 0);
+	WRITE_ONCE(lat->rate, 0);
+
+	for (i = 0; i < ARRAY_SIZE(lat->rx); i++)
+		WRITE_ONCE(lat->rx[i].skb, NULL);
+	WRITE_ONCE(lat->tx.skb, NULL);
+
+	spin_lock_bh(&lat->lock);
+	memset(lat->hist, 0, sizeof(lat->hist));
+	memset(lat->sum_ns, 0, sizeof(lat->sum_ns));
+	memset(lat->max_ns, 0, sizeof(lat->max_ns));
+	lat->gp2_ref_ns = 0;
+	spin_unlock_bh(&lat->lock);
+
+	if (!rate)
+		return;
+
+	lat->tx_cnt = 0;
+	WRITE_ONCE(lat->rate, rate);
+	WRITE_ONCE(mvm->trans->rx_lat_sample, rate);
+
+	/* the work stops by itself once the rate is 0 */
+	mod_delayed_work(system_wq, &lat->ref_wk, 0);
+}
+
+void iwl_mvm_dp_lat_record(struct iwl_mvm *mvm,
+			   enum iwl_mvm_dp_lat_stage stage,
+			   u64 start_ns, u64 end_ns)
+{
+	struct iwl_mvm_dp_lat *lat = &mvm->dp_lat;
+	u64 delta;
+	int bucket;
+
+	/* unknown start, or a GP2 reference that is off */
+	if (!start_ns || end_ns < start_ns)
+		return;
+
+	delta = end_ns - start_ns;
+	bucket = min_t(int, fls64(div_u64(delta, NSEC_PER_USEC)),
+		       IWL_MVM_DP_LAT_BUCKETS - 1);
+
+	spin_lock_bh(&lat->lock);
+	lat->hist[stage][bucket]++;
+	lat->sum_ns[stage] += delta;
+	lat->max_ns[stage] = max(lat->max_ns[stage], delta);
+	spin_unlock_bh(&lat->lock);
+}
+
+/* take a free slot, or one whose frame was lost on the way */
+static bool iwl_mvm_dp_lat_claim(struct iwl_mvm_dp_lat_sample *slot)
+{
+	struct sk_buff *cur = READ_ONCE(slot->skb);
+
+	if (cur && time_before(jiffies, slot->armed + IWL_MVM_DP_LAT_TIMEOUT))
+		return false;
+
+	return cmpxchg(&slot->skb, cur, IWL_MVM_DP_LAT_CLAIMED) == cur;
+}
+
+void __iwl_mvm_dp_lat_rx_arm(struct iwl_mvm *mvm, int queue,
+			     struct sk_buff *skb, u64 rb_done_ns, u32 gp2)
+{
+	struct iwl_mvm_dp_lat *lat = &mvm->dp_lat;
+	struct iwl_mvm_dp_lat_sample *slot = &lat->rx[queue];
+	u64 air_ns = 0;
+
+	if (!iwl_mvm_dp_lat_claim(slot))
+		return;
+
+	spin_lock_bh(&lat->lock);
+	if (lat->gp2_ref_ns)
+		air_ns = lat->gp2_ref_ns +
+			 (s64)(s32)(gp2 - lat->gp2_ref) * NSEC_PER_USEC;
+	spin_unlock_bh(&lat->lock);
+
+	slot->ts[IWL_MVM_DP_LAT_TS_AIR] = air_ns;
+	slot->ts[IWL_MVM_DP_LAT_TS_RB] = rb_done_ns;
+	slot->tag = gp2;
+	slot->armed = jiffies;
+	smp_store_release(&slot->skb, skb);
+}
+
+u64 __iwl_mvm_dp_lat_rx_release(struct iwl_mvm *mvm, int queue,
+				struct sk_buff *skb)
+{
+	struct iwl_mvm_dp_lat_sample *slot = &mvm->dp_lat.rx[queue];
+	u64 air_ns, rb_ns, now = ktime_get_ns();
+	u32 tag;
+
+	/* pairs with the release in __iwl_mvm_dp_lat_rx_arm() */
+	if (smp_load_acquire(&slot->skb) != skb)
+		return 0;
+
+	air_ns = READ_ONCE(slot->ts[IWL_MVM_DP_LAT_TS_AIR]);
+	rb_ns = READ_ONCE(slot->ts[IWL_MVM_DP_LAT_TS_RB]);
+	tag = READ_ONCE(slot->tag);
+
+	/* the reorder timer may release frames of this queue concurrently */
+	if (cmpxchg(&slot->skb, skb, NULL) != skb)
+		return 0;
+
+	/* the sampled frame was dropped and its skb reused, forget it */
+	if (IEEE80211_SKB_RXCB(skb)->device_timestamp != tag)
+		return 0;
+
+	iwl_mvm_dp_lat_record(mvm, IWL_MVM_DP_LAT_RX_AIR, air_ns, rb_ns);
+	iwl_mvm_dp_lat_record(mvm, IWL_MVM_DP_LAT_RX_REORDER, rb_ns, now);
+
+	return now;
+}
+
+void __iwl_mvm_dp_lat_tx_dequeue(struct iwl_mvm *mvm, struct sk_buff *skb)
+{
+	struct iwl_mvm_dp_lat *lat = &mvm->dp_lat;
+	struct iwl_mvm_dp_lat_sample *slot = &lat->tx;
+	struct ieee80211_tx_info *info = IEEE80211_SKB_CB(skb);
+	codel_time_t fq_time;
+	u32 cnt;
+	u64 now;
+
+	/* GSO frames are split into new skbs further down */
+	if (skb_is_gso(skb))
+		return;
+
+	/* racy, but it only needs to be roughly one in rate */
+	cnt = READ_ONCE(lat->tx_cnt) + 1;
+	if (cnt < READ_ONCE(lat->rate)) {
+		WRITE_ONCE(lat->tx_cnt, cnt);
+		return;
+	}
+	WRITE_ONCE(lat->tx_cnt, 0);
+
+	if (!iwl_mvm_dp_lat_claim(slot))
+		return;
+
+	/* mac80211 stamps the frame (in codel time) when it enters FQ */
+	now = ktime_get_ns();
+	fq_time = codel_get_time() - info->control.enqueue_time;
+
+	slot->ts[IWL_MVM_DP_LAT_TS_ENQ] = now - ((u64)fq_time << CODEL_SHIFT);
+	slot->ts[IWL_MVM_DP_LAT_TS_DEQ] = now;
+	slot->ts[IWL_MVM_DP_LAT_TS_TRANS] = 0;
+	slot->armed = jiffies;
+	smp_store_release(&slot->skb, skb);
+}
+
+void __iwl_mvm_dp_lat_drop(struct iwl_mvm_dp_lat_sample *slot,
+			   struct sk_buff *skb)
+{
+	cmpxchg(&slot->skb, skb, NULL);
+}
+
+void __iwl_mvm_dp_lat_tx_status(struct iwl_mvm *mvm, struct sk_buff *skb)
+{
+	struct iwl_mvm_dp_lat_sample *slot = &mvm->dp_lat.tx;
+	u64 enq_ns = READ_ONCE(slot->ts[IWL_MVM_DP_LAT_TS_ENQ]);
+	u64 deq_ns = READ_ONCE(slot->ts[IWL_MVM_DP_LAT_TS_DEQ]);
+	u64 trans_ns = READ_ONCE(slot->ts[IWL_MVM_DP_LAT_TS_TRANS]);
+	u64 now = ktime_get_ns();
+
+	if (cmpxchg(&slot->skb, skb, NULL) != skb)
+		return;
+
+	iwl_mvm_dp_lat_record(mvm, IWL_MVM_DP_LAT_TX_FQ, enq_ns, deq_ns);
+	iwl_mvm_dp_lat_record(mvm, IWL_MVM_DP_LAT_TX_DRV, deq_ns, trans_ns);
+	iwl_mvm_dp_lat_record(mvm, IWL_MVM_DP_LAT_TX_STATUS, trans_ns, now);
+}
@@ -0,0 +1,93 @@
+/* SPDX-License-Identifier: GPL-2.0 OR BSD-3-Clause */
+/*
+ * Copyright (C) 2023 Intel Corporation
+ */
+#ifndef __DP_LAT_H__
+#define __DP_LAT_H__
+
+#include "mvm.h"
+
+/* RX sample timestamps */
+#define IWL_MVM_DP_LAT_TS_AIR		0
+#define IWL_MVM_DP_LAT_TS_RB		1
+/* TX sample timestamps */
+#define IWL_MVM_DP_LAT_TS_ENQ		0
+#define IWL_MVM_DP_LAT_TS_DEQ		1
+#define IWL_MVM_DP_LAT_TS_TRANS		2
+
+void iwl_mvm_dp_lat_init(struct iwl_mvm *mvm);
+void iwl_mvm_dp_lat_set_rate(struct iwl_mvm *mvm, u32 rate);
+void iwl_mvm_dp_lat_record(struct iwl_mvm *mvm,
+			   enum iwl_mvm_dp_lat_stage stage,
+			   u64 start_ns, u64 end_ns);
+void __iwl_mvm_dp_lat_rx_arm(struct iwl_mvm *mvm, int queue,
+			     struct sk_buff *skb, u64 rb_done_ns, u32 gp2);
+u64 __iwl_mvm_dp_lat_rx_release(struct iwl_mvm *mvm, int queue,
+				struct sk_buff *skb);
+void __iwl_mvm_dp_lat_tx_dequeue(struct iwl_mvm *mvm, struct sk_buff *skb);
+void __iwl_mvm_dp_lat_tx_status(struct iwl_mvm *mvm, struct sk_buff *skb);
+void __iwl_mvm_dp_lat_drop(struct iwl_mvm_dp_lat_sample *slot,
+			   struct sk_buff *skb);
+
+/* called with the RX descriptor's GP2 for each new MPDU */
+static inline void iwl_mvm_dp_lat_rx_arm(struct iwl_mvm *mvm, int queue,
+					 struct sk_buff *skb,
+					 struct iwl_rx_cmd_buffer *rxb,
+					 u32 gp2)
+{
+	if (unlikely(rxb->rb_done_ns))
+		__iwl_mvm_dp_lat_rx_arm(mvm, queue, skb, rxb->rb_done_ns, gp2);
+}
+
+/*
+ * Called when a frame is released to mac80211, returns the release time
+ * if @skb was sampled, 0 otherwise.
+ */
+static inline u64 iwl_mvm_dp_lat_rx_release(struct iwl_mvm *mvm, int queue,
+					    struct sk_buff *skb)
+{
+	if (likely(READ_ONCE(mvm->dp_lat.rx[queue].skb) != skb))
+		return 0;
+
+	return __iwl_mvm_dp_lat_rx_release(mvm, queue, skb);
+}
+
+/* called before an RX frame is freed instead of being released */
+static inline void iwl_mvm_dp_lat_rx_drop(struct iwl_mvm *mvm, int queue,
+					  struct sk_buff *skb)
+{
+	if (unlikely(READ_ONCE(mvm->dp_lat.rx[queue].skb) == skb))
+		__iwl_mvm_dp_lat_drop(&mvm->dp_lat.rx[queue], skb);
+}
+
+/* must be called before the driver uses the skb's control info */
+static inline void iwl_mvm_dp_lat_tx_dequeue(struct iwl_mvm *mvm,
+					     struct sk_buff *skb)
+{
+	if (unlikely(READ_ONCE(mvm->dp_lat.rate)))
+		__iwl_mvm_dp_lat_tx_dequeue(mvm, skb);
+}
+
+static inline void iwl_mvm_dp_lat_tx_trans(struct iwl_mvm *mvm,
+					   struct sk_buff *skb)
+{
+	if (unlikely(READ_ONCE(mvm->dp_lat.tx.skb) == skb))
+		WRITE_ONCE(mvm->dp_lat.tx.ts[IWL_MVM_DP_LAT_TS_TRANS],
+			   ktime_get_ns());
+}
+
+static inline void iwl_mvm_dp_lat_tx_status(struct iwl_mvm *mvm,
+					    struct sk_buff *skb)
+{
+	if (unlikely(READ_ONCE(mvm->dp_lat.tx.skb) == skb))
+		__iwl_mvm_dp_lat_tx_status(mvm, skb);
+}
+
+/* called before a TX frame is freed without being transmitted */
+static inline void iwl_mvm_dp_lat_tx_drop(struct iwl_mvm *mvm,
+					  struct sk_buff *skb)
+{
+	if (unlikely(READ_ONCE(mvm->dp_lat.tx.skb) == skb))
+		__iwl_mvm_dp_lat_drop(&mvm->dp_lat.tx, skb);
+}
+#endif
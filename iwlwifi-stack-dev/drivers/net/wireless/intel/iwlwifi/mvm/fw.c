@@ -29,6 +29,7 @@
 #include "fw/platform-mockups.h"
 #endif /* CPTCFG_IWLWIFI_PLATFORM_MOCKUPS */
 #include "time-sync.h"
+#include "rss.h"
 
 #define MVM_UCODE_ALIVE_TIMEOUT	(HZ * CPTCFG_IWL_TIMEOUT_FACTOR)
 #define MVM_UCODE_CALIB_TIMEOUT	(2 * HZ * CPTCFG_IWL_TIMEOUT_FACTOR)
@@ -52,31 +53,6 @@ static int iwl_send_tx_ant_cfg(struct iwl_mvm *mvm, u8 valid_tx_ant)
 				    sizeof(tx_ant_cmd), &tx_ant_cmd);
 }
 
-static int iwl_send_rss_cfg_cmd(struct iwl_mvm *mvm)
-{
-	int i;
-	struct iwl_rss_config_cmd cmd = {
-		.flags = cpu_to_le32(IWL_RSS_ENABLE),
-		.hash_mask = BIT(IWL_RSS_HASH_TYPE_IPV4_TCP) |
-			     BIT(IWL_RSS_HASH_TYPE_IPV4_UDP) |
-			     BIT(IWL_RSS_HASH_TYPE_IPV4_PAYLOAD) |
-			     BIT(IWL_RSS_HASH_TYPE_IPV6_TCP) |
-			     BIT(IWL_RSS_HASH_TYPE_IPV6_UDP) |
-			     BIT(IWL_RSS_HASH_TYPE_IPV6_PAYLOAD),
-	};
-
-	if (mvm->trans->num_rx_queues == 1)
-		return 0;
-
-	/* Do not direct RSS traffic to Q 0 which is our fallback queue */
-	for (i = 0; i < ARRAY_SIZE(cmd.indirection_table); i++)
-		cmd.indirection_table[i] =
-			1 + (i % (mvm->trans->num_rx_queues - 1));
-	netdev_rss_key_fill(cmd.secret_key, sizeof(cmd.secret_key));
-
-	return iwl_mvm_send_cmd_pdu(mvm, RSS_CONFIG_CMD, 0, sizeof(cmd), &cmd);
-}
-
 static int iwl_mvm_send_dqa_cmd(struct iwl_mvm *mvm)
 {
 	struct iwl_dqa_enable_cmd dqa_cmd = {
@@ -1728,7 +1704,7 @@ int iwl_mvm_up(struct iwl_mvm *mvm)
 		goto error;
 
 	if (iwl_mvm_has_new_rx_api(mvm)) {
-		ret = iwl_send_rss_cfg_cmd(mvm);
+		ret = iwl_mvm_rss_send_cfg(mvm);
 		if (ret) {
 			IWL_ERR(mvm, "Failed to configure RSS queues: %d\n",
 				ret);
@@ -37,6 +37,8 @@
 #endif
 #include "fw/api/nan.h"
 #include "time-sync.h"
+#include "rss.h"
+#include "dp-lat.h"
 
 static const struct ieee80211_iface_limit iwl_mvm_limits[] = {
 	{
@@ -147,7 +149,9 @@ struct ieee80211_regdomain *iwl_mvm_get_regdomain(struct wiphy *wiphy,
 	struct ieee80211_regdomain *regd = NULL;
 	struct ieee80211_hw *hw = wiphy_to_ieee80211_hw(wiphy);
 	struct iwl_mvm *mvm = IWL_MAC80211_GET_MVM(hw);
+	struct iwl_mvm_regd_cache *cache = &mvm->regd_cache;
 	struct iwl_mcc_update_resp *resp;
+	u64 start = ktime_get_ns();
 	u8 resp_ver;
 
 	IWL_DEBUG_LAR(mvm, "Getting regdomain data for %s from FW\n", alpha2);
@@ -172,12 +176,7 @@ struct ieee80211_regdomain *iwl_mvm_get_regdomain(struct wiphy *wiphy,
 					   MCC_UPDATE_CMD, 0);
 	IWL_DEBUG_LAR(mvm, "MCC update response version: %d\n", resp_ver);
 
-	regd = iwl_parse_nvm_mcc_info(mvm->trans->dev, mvm->cfg,
-				      __le32_to_cpu(resp->n_channels),
-				      resp->channels,
-				      __le16_to_cpu(resp->mcc),
-				      __le16_to_cpu(resp->geo_info),
-				      __le16_to_cpu(resp->cap), resp_ver);
+	regd = iwl_mvm_regd_cache_get(mvm, resp, resp_ver);
 	/* Store the return source id */
 	src_id = resp->source_id;
 	if (IS_ERR_OR_NULL(regd)) {
@@ -186,6 +185,9 @@ struct ieee80211_regdomain *iwl_mvm_get_regdomain(struct wiphy *wiphy,
 		goto out;
 	}
 
+	cache->query_last_ns = ktime_get_ns() - start;
+	cache->query_max_ns = max(cache->query_max_ns, cache->query_last_ns);
+
 	IWL_DEBUG_LAR(mvm, "setting alpha2 from FW to %s (0x%x, 0x%x) src=%d\n",
 		      regd->alpha2, regd->alpha2[0], regd->alpha2[1], src_id);
 	mvm->lar_regdom_set = true;
@@ -210,12 +212,55 @@ void iwl_mvm_update_changed_regdom(struct iwl_mvm *mvm)
 	if (!IS_ERR_OR_NULL(regd)) {
 		/* only update the regulatory core if changed */
 		if (changed)
-			regulatory_set_wiphy_regd(mvm->hw->wiphy, regd);
+			iwl_mvm_set_wiphy_regd(mvm, regd, false);
 
 		kfree(regd);
 	}
 }
 
+/*
+ * Give a regdomain built from an MCC update to cfg80211, unless it is
+ * identical to the one given last time: cfg80211 would recompute all the
+ * channels only to end up where it already is (or will be, if the last
+ * update is still pending).
+ */
+int iwl_mvm_set_wiphy_regd(struct iwl_mvm *mvm,
+			   struct ieee80211_regdomain *regd, bool sync)
+{
+	struct iwl_mvm_regd_cache *cache = &mvm->regd_cache;
+	size_t len = struct_size(regd, reg_rules, regd->n_reg_rules);
+	u64 start;
+	int ret;
+
+	lockdep_assert_held(&mvm->mutex);
+
+	if (cache->last && rcu_access_pointer(mvm->hw->wiphy->regd) &&
+	    cache->last->n_reg_rules == regd->n_reg_rules &&
+	    !memcmp(cache->last, regd, len)) {
+		IWL_DEBUG_LAR(mvm, "regdomain %c%c unchanged, not updating\n",
+			      regd->alpha2[0], regd->alpha2[1]);
+		cache->skipped++;
+		return 0;
+	}
+
+	kfree(cache->last);
+	cache->last = NULL;
+
+	start = ktime_get_ns();
+	if (sync)
+		ret = regulatory_set_wiphy_regd_sync(mvm->hw->wiphy, regd);
+	else
+		ret = regulatory_set_wiphy_regd(mvm->hw->wiphy, regd);
+	cache->set_last_ns = ktime_get_ns() - start;
+	cache->set_max_ns = max(cache->set_max_ns, cache->set_last_ns);
+	cache->updates++;
+
+	if (!ret)
+		cache->last = kmemdup(regd, len, GFP_KERNEL);
+
+	return ret;
+}
+
 struct ieee80211_regdomain *iwl_mvm_get_current_regdomain(struct iwl_mvm *mvm,
 							  bool *changed)
 {
@@ -254,7 +299,7 @@ int iwl_mvm_init_fw_regd(struct iwl_mvm *mvm)
 
 	/* update cfg80211 if the regdomain was changed */
 	if (changed)
-		ret = regulatory_set_wiphy_regd_sync(mvm->hw->wiphy, regd);
+		ret = iwl_mvm_set_wiphy_regd(mvm, regd, true);
 	else
 		ret = 0;
 
@@ -450,6 +495,11 @@ int iwl_mvm_mac_setup_register(struct iwl_mvm *mvm)
 	hw->uapsd_max_sp_len = IWL_UAPSD_MAX_SP;
 	hw->max_tx_fragments = mvm->trans->max_skb_frags;
 
+	if (iwl_mvm_rss_supported(mvm)) {
+		hw->rxfh_indir_size = IWL_RSS_INDIRECTION_TABLE_SIZE;
+		hw->rxfh_key_size = sizeof(mvm->rss.key);
+	}
+
 	BUILD_BUG_ON(ARRAY_SIZE(mvm->ciphers) < ARRAY_SIZE(mvm_ciphers) + 6);
 	memcpy(mvm->ciphers, mvm_ciphers, sizeof(mvm_ciphers));
 	hw->wiphy->n_cipher_suites = ARRAY_SIZE(mvm_ciphers);
@@ -812,6 +862,7 @@ static void iwl_mvm_tx_skb(struct iwl_mvm *mvm, struct sk_buff *skb,
 			return;
 	}
 
+	iwl_mvm_dp_lat_tx_drop(mvm, skb);
 	ieee80211_free_txskb(mvm->hw, skb);
 }
 
@@ -927,6 +978,7 @@ void iwl_mvm_mac_itxq_xmit(struct ieee80211_hw *hw, struct ieee80211_txq *txq)
 				break;
 			}
 
+			iwl_mvm_dp_lat_tx_dequeue(mvm, skb);
 			iwl_mvm_tx_skb(mvm, skb, txq->sta);
 		}
 	} while (atomic_dec_return(&mvmtxq->tx_request));
@@ -6059,6 +6111,19 @@ static void iwl_mvm_set_sta_rate(u32 rate_n_flags, struct rate_info *rinfo)
 	}
 }
 
+static void iwl_mvm_fill_beacon_sinfo(struct iwl_mvm_vif *mvmvif,
+				      struct station_info *sinfo)
+{
+	sinfo->rx_beacon = READ_ONCE(mvmvif->deflink.beacon_stats.num_beacons) +
+			   READ_ONCE(mvmvif->deflink.beacon_stats.accu_num_beacons);
+	sinfo->filled |= BIT_ULL(NL80211_STA_INFO_BEACON_RX);
+	if (mvmvif->deflink.beacon_stats.avg_signal) {
+		/* firmware only reports a value after RXing a few beacons */
+		sinfo->rx_beacon_signal_avg = mvmvif->deflink.beacon_stats.avg_signal;
+		sinfo->filled |= BIT_ULL(NL80211_STA_INFO_BEACON_SIGNAL_AVG);
+	}
+}
+
 void iwl_mvm_mac_sta_statistics(struct ieee80211_hw *hw,
 				struct ieee80211_vif *vif,
 				struct ieee80211_sta *sta,
@@ -6087,6 +6152,21 @@ void iwl_mvm_mac_sta_statistics(struct ieee80211_hw *hw,
 	if (!vif->cfg.assoc)
 		return;
 
+	if (READ_ONCE(mvmvif->deflink.ap_sta_id) != mvmsta->deflink.sta_id)
+		return;
+
+	/*
+	 * The periodic statistics notifications keep the beacon statistics
+	 * current, avoid a firmware round trip under the mutex per query.
+	 */
+	if (iwl_mvm_stats_cache_fresh(mvm)) {
+		atomic_inc(&mvm->stats_cache.hits);
+		iwl_mvm_fill_beacon_sinfo(mvmvif, sinfo);
+		return;
+	}
+
+	atomic_inc(&mvm->stats_cache.misses);
+
 	mutex_lock(&mvm->mutex);
 
 	if (mvmvif->deflink.ap_sta_id != mvmsta->deflink.sta_id)
@@ -6095,14 +6175,7 @@ void iwl_mvm_mac_sta_statistics(struct ieee80211_hw *hw,
 	if (iwl_mvm_request_statistics(mvm, false))
 		goto unlock;
 
-	sinfo->rx_beacon = mvmvif->deflink.beacon_stats.num_beacons +
-			   mvmvif->deflink.beacon_stats.accu_num_beacons;
-	sinfo->filled |= BIT_ULL(NL80211_STA_INFO_BEACON_RX);
-	if (mvmvif->deflink.beacon_stats.avg_signal) {
-		/* firmware only reports a value after RXing a few beacons */
-		sinfo->rx_beacon_signal_avg = mvmvif->deflink.beacon_stats.avg_signal;
-		sinfo->filled |= BIT_ULL(NL80211_STA_INFO_BEACON_SIGNAL_AVG);
-	}
+	iwl_mvm_fill_beacon_sinfo(mvmvif, sinfo);
  unlock:
 	mutex_unlock(&mvm->mutex);
 }
@@ -6401,6 +6474,22 @@ int iwl_mvm_set_hw_timestamp(struct ieee80211_hw *hw,
 	return ret;
 }
 
+int iwl_mvm_mac_set_coalesce(struct ieee80211_hw *hw, u32 rx_usecs,
+			     bool adaptive_rx)
+{
+	struct iwl_mvm *mvm = IWL_MAC80211_GET_MVM(hw);
+
+	return iwl_trans_set_coalesce(mvm->trans, rx_usecs, adaptive_rx);
+}
+
+int iwl_mvm_mac_get_coalesce(struct ieee80211_hw *hw, u32 *rx_usecs,
+			     bool *adaptive_rx)
+{
+	struct iwl_mvm *mvm = IWL_MAC80211_GET_MVM(hw);
+
+	return iwl_trans_get_coalesce(mvm->trans, rx_usecs, adaptive_rx);
+}
+
 const struct ieee80211_ops iwl_mvm_hw_ops = {
 	.tx = iwl_mvm_mac_tx,
 	.wake_tx_queue = iwl_mvm_mac_wake_tx_queue,
@@ -6495,4 +6584,15 @@ const struct ieee80211_ops iwl_mvm_hw_ops = {
 	.sta_add_debugfs = iwl_mvm_sta_add_debugfs,
 #endif
 	.set_hw_timestamp = iwl_mvm_set_hw_timestamp,
+	.set_coalesce = iwl_mvm_mac_set_coalesce,
+	.get_coalesce = iwl_mvm_mac_get_coalesce,
+	.get_rxfh = iwl_mvm_mac_get_rxfh,
+	.set_rxfh = iwl_mvm_mac_set_rxfh,
+	.get_rxnfc = iwl_mvm_mac_get_rxnfc,
+	.set_rxnfc = iwl_mvm_mac_set_rxnfc,
+	.get_channels = iwl_mvm_mac_get_channels,
+	.set_channels = iwl_mvm_mac_set_channels,
+#if defined(CPTCFG_IWLMVM_VENDOR_CMDS) && defined(CPTCFG_IWLMVM_PHC)
+	.get_ts_info = iwl_mvm_mac_get_ts_info,
+#endif
 };
@@ -1090,6 +1090,17 @@ const struct ieee80211_ops iwl_mvm_mld_hw_ops = {
 	.sta_add_debugfs = iwl_mvm_sta_add_debugfs,
 #endif
 	.set_hw_timestamp = iwl_mvm_set_hw_timestamp,
+	.set_coalesce = iwl_mvm_mac_set_coalesce,
+	.get_coalesce = iwl_mvm_mac_get_coalesce,
+	.get_rxfh = iwl_mvm_mac_get_rxfh,
+	.set_rxfh = iwl_mvm_mac_set_rxfh,
+	.get_rxnfc = iwl_mvm_mac_get_rxnfc,
+	.set_rxnfc = iwl_mvm_mac_set_rxnfc,
+	.get_channels = iwl_mvm_mac_get_channels,
+	.set_channels = iwl_mvm_mac_set_channels,
+#if defined(CPTCFG_IWLMVM_VENDOR_CMDS) && defined(CPTCFG_IWLMVM_PHC)
+	.get_ts_info = iwl_mvm_mac_get_ts_info,
+#endif
 
 	.change_vif_links = iwl_mvm_mld_change_vif_links,
 	.change_sta_links = iwl_mvm_mld_change_sta_links,
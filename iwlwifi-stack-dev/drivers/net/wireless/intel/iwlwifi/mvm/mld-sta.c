@@ -326,6 +326,7 @@ static int iwl_mvm_mld_disable_txq(struct iwl_mvm *mvm, int sta_id,
 					   &remove_cmd);
 	}
 
+	iwl_mvm_tx_compl_sync(mvm);
 	iwl_trans_txq_free(mvm->trans, queue);
 	*queueptr = IWL_MVM_INVALID_QUEUE;
 
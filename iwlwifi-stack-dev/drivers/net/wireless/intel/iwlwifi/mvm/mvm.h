@@ -89,10 +89,13 @@ extern const struct ieee80211_ops iwl_mvm_mld_hw_ops;
  *	be up'ed after the INIT fw asserted. This is useful to be able to use
  *	proprietary tools over testmode to debug the INIT fw.
  * @power_scheme: one of enum iwl_power_scheme
+ * @tx_compl_napi: process TX status notifications in a dedicated NAPI
+ *	context instead of inline in the RX path
  */
 struct iwl_mvm_mod_params {
 	bool init_dbg;
 	int power_scheme;
+	bool tx_compl_napi;
 };
 extern struct iwl_mvm_mod_params iwlmvm_mod_params;
 
@@ -830,6 +833,12 @@ struct ptp_data {
 
 	struct delayed_work dwork;
 
+	/*
+	 * Protects the GP2 conversion state below. Readers are lockless,
+	 * it's only taken for writing on clock adjustments and wraparounds.
+	 */
+	seqlock_t lock;
+
 	/* The last GP2 reading from the hw */
 	u32 last_gp2;
 
@@ -856,6 +865,33 @@ struct iwl_time_sync_data {
 	bool active;
 };
 
+/**
+ * struct iwl_mvm_rss - RSS configuration
+ * @indir: indirection table, RX hardware queue per hash bucket
+ * @key: hash secret key
+ * @hash_mask: enabled hash types, BIT(IWL_RSS_HASH_TYPE_*)
+ * @num_queues: number of RX queues (not counting the default queue)
+ *	the default table spreads over
+ * @user_indir: the table was configured explicitly and is kept as is
+ * @rebalance: move buckets away from overloaded queues
+ * @rebalance_next: bucket to start looking from on the next rebalance
+ * @rebalance_wk: the periodic rebalance work
+ * @rx_pkts: per-queue RX packet counters, only updated while rebalancing
+ * @last_rx_pkts: @rx_pkts at the previous rebalance run
+ */
+struct iwl_mvm_rss {
+	u8 indir[IWL_RSS_INDIRECTION_TABLE_SIZE];
+	__le32 key[IWL_RSS_HASH_KEY_CNT];
+	u8 hash_mask;
+	u8 num_queues;
+	bool user_indir;
+	bool rebalance;
+	u8 rebalance_next;
+	struct delayed_work rebalance_wk;
+	u32 rx_pkts[IWL_MAX_RX_HW_QUEUES];
+	u32 last_rx_pkts[IWL_MAX_RX_HW_QUEUES];
+};
+
 #ifdef CPTCFG_IWLMVM_MEI_SCAN_FILTER
 struct iwl_mei_scan_filter {
 	bool is_mei_limited_scan;
@@ -864,6 +900,209 @@ struct iwl_mei_scan_filter {
 };
 #endif
 
+#define IWL_MVM_STATS_CACHE_DEF_MAX_AGE_MS	1000
+
+/**
+ * struct iwl_mvm_stats_cache - freshness of the firmware statistics
+ *
+ * The statistics notifications keep the driver's copy of the firmware
+ * statistics up to date, station queries use it as long as it isn't
+ * older than @max_age_ms instead of requesting new statistics.
+ *
+ * @updated: jiffies of the last statistics update
+ * @valid: @updated is set
+ * @max_age_ms: maximum age of cached statistics, 0 to always request
+ * @hits: queries answered from the cache
+ * @misses: queries that had to request statistics from the firmware
+ */
+struct iwl_mvm_stats_cache {
+	unsigned long updated;
+	bool valid;
+	u32 max_age_ms;
+	atomic_t hits;
+	atomic_t misses;
+};
+
+#define IWL_MVM_REGD_CACHE_SIZE	8
+
+/**
+ * struct iwl_mvm_regd_cache_entry - a parsed MCC update response
+ * @mcc: MCC reported by the firmware
+ * @geo_info: geo info flags of the response
+ * @cap: regulatory capability flags of the response
+ * @resp_ver: version of the response
+ * @n_channels: number of entries in @channels
+ * @channels: per-channel flags of the response
+ * @last_used: &iwl_mvm_regd_cache.use_cnt at the last lookup, for LRU
+ * @regd: the regdomain built from the above, %NULL if the entry is free
+ */
+struct iwl_mvm_regd_cache_entry {
+	u16 mcc;
+	u16 geo_info;
+	u16 cap;
+	u8 resp_ver;
+	u32 n_channels;
+	__le32 *channels;
+	u32 last_used;
+	struct ieee80211_regdomain *regd;
+};
+
+/**
+ * struct iwl_mvm_regd_cache - regdomains built from firmware MCC updates
+ *
+ * Parsing the channel flags of an MCC update response into a regdomain
+ * only depends on the response, so keep the last few around for devices
+ * that go back and forth between countries. All fields are protected by
+ * the mvm mutex.
+ *
+ * @entries: the cached regdomains
+ * @use_cnt: lookup counter, for LRU replacement
+ * @last: copy of the last regdomain given to cfg80211
+ * @hits: responses that were found in the cache
+ * @misses: responses that had to be parsed
+ * @updates: regdomains given to cfg80211
+ * @skipped: updates not given to cfg80211, identical to the current one
+ * @query_last_ns: duration of the last MCC update command and parsing
+ * @query_max_ns: maximum of @query_last_ns
+ * @set_last_ns: duration of the last cfg80211 update
+ * @set_max_ns: maximum of @set_last_ns
+ */
+struct iwl_mvm_regd_cache {
+	struct iwl_mvm_regd_cache_entry entries[IWL_MVM_REGD_CACHE_SIZE];
+	u32 use_cnt;
+	struct ieee80211_regdomain *last;
+	u32 hits;
+	u32 misses;
+	u32 updates;
+	u32 skipped;
+	u64 query_last_ns;
+	u64 query_max_ns;
+	u64 set_last_ns;
+	u64 set_max_ns;
+};
+
+enum iwl_mvm_dp_lat_stage {
+	IWL_MVM_DP_LAT_RX_AIR,
+	IWL_MVM_DP_LAT_RX_REORDER,
+	IWL_MVM_DP_LAT_RX_DELIVER,
+	IWL_MVM_DP_LAT_TX_FQ,
+	IWL_MVM_DP_LAT_TX_DRV,
+	IWL_MVM_DP_LAT_TX_STATUS,
+
+	IWL_MVM_DP_LAT_NUM_STAGES,
+};
+
+/* bucket 0 is < 1us, bucket N is [2^(N-1), 2^N) us, the last is open */
+#define IWL_MVM_DP_LAT_BUCKETS	20
+#define IWL_MVM_DP_LAT_NUM_TS	3
+
+/**
+ * struct iwl_mvm_dp_lat_sample - a sampled frame on its way through
+ * @skb: the sampled frame, only used as a key, %NULL if the slot is free
+ * @armed: jiffies when the frame was sampled, to reclaim lost samples
+ * @tag: RX only, the frame's GP2 (also in its rx_status), so an skb that
+ *	was freed and reused for another frame isn't taken for the sample
+ * @ts: stage timestamps in ns, RX: on-air, RB done; TX: FQ enqueue,
+ *	dequeue, handed to the transport
+ */
+struct iwl_mvm_dp_lat_sample {
+	struct sk_buff *skb;
+	unsigned long armed;
+	u32 tag;
+	u64 ts[IWL_MVM_DP_LAT_NUM_TS];
+};
+
+/**
+ * struct iwl_mvm_dp_lat - sampled datapath latency histograms
+ *
+ * One in @rate frames is followed through the datapath, at most one per
+ * RX queue and one for TX at a time. Frames are matched by their skb
+ * pointer at each stage, so the unsampled path only costs a compare.
+ *
+ * @rate: sample one in this many frames, 0 disables
+ * @tx_cnt: frames dequeued since the last TX sample
+ * @rx: in-flight sample per RX queue
+ * @tx: in-flight TX sample
+ * @lock: protects the fields below
+ * @gp2_ref: GP2 time of the last reference reading
+ * @gp2_ref_ns: host time (ktime_get_ns()) of @gp2_ref, 0 if unknown
+ * @hist: per-stage latency histograms
+ * @sum_ns: per-stage latency sums
+ * @max_ns: per-stage maximum latency
+ * @ref_wk: periodically refreshes the GP2 reference while sampling
+ */
+struct iwl_mvm_dp_lat {
+	u32 rate;
+	u32 tx_cnt;
+	struct iwl_mvm_dp_lat_sample rx[IWL_MAX_RX_HW_QUEUES];
+	struct iwl_mvm_dp_lat_sample tx;
+
+	spinlock_t lock;
+	u32 gp2_ref;
+	u64 gp2_ref_ns;
+	u64 hist[IWL_MVM_DP_LAT_NUM_STAGES][IWL_MVM_DP_LAT_BUCKETS];
+	u64 sum_ns[IWL_MVM_DP_LAT_NUM_STAGES];
+	u64 max_ns[IWL_MVM_DP_LAT_NUM_STAGES];
+
+	struct delayed_work ref_wk;
+};
+
+#define IWL_MVM_TX_COMPL_POOL_SIZE	256
+
+/**
+ * struct iwl_mvm_tx_compl_entry - a deferred TX status notification
+ * @list: entry in &iwl_mvm_tx_compl.pending or &iwl_mvm_tx_compl.free
+ * @rxb: the notification, owns the page
+ * @fn: the RX handler to call
+ * @ts: ktime (ns) at which the notification was queued
+ * @pooled: the entry comes from the preallocated pool
+ */
+struct iwl_mvm_tx_compl_entry {
+	struct list_head list;
+	struct iwl_rx_cmd_buffer rxb;
+	void (*fn)(struct iwl_mvm *mvm, struct iwl_rx_cmd_buffer *rxb);
+	u64 ts;
+	bool pooled;
+};
+
+/**
+ * struct iwl_mvm_tx_compl - TX completion context
+ * @napi_dev: dummy netdev for @napi
+ * @napi: NAPI that processes the pending TX status notifications
+ * @lock: protects @pending, @free, @active, @polling, @draining and @stats
+ * @pending: notifications to process, in order of arrival
+ * @free: unused entries of @pool
+ * @enabled: the context was set up
+ * @active: notifications may be queued, cleared while the device stops
+ * @polling: the NAPI took a batch from @pending and is processing it
+ * @draining: an entry couldn't be allocated, @pending is being processed
+ *	from the RX path and notifications are handled inline meanwhile
+ * @pool: preallocated entries, more are allocated if it runs out
+ * @stats: statistics, see debugfs tx_compl_stats
+ */
+struct iwl_mvm_tx_compl {
+	struct net_device napi_dev;
+	struct napi_struct napi;
+	spinlock_t lock;
+	struct list_head pending;
+	struct list_head free;
+	bool enabled;
+	bool active;
+	bool polling;
+	bool draining;
+	struct iwl_mvm_tx_compl_entry pool[IWL_MVM_TX_COMPL_POOL_SIZE];
+	struct {
+		u64 notifs;
+		u64 polls;
+		u64 lat_sum_ns;
+		u64 lat_max_ns;
+		u32 pending;
+		u32 max_pending;
+		u32 pool_misses;
+		u32 inline_fallbacks;
+	} stats;
+};
+
 struct iwl_mvm {
 	/* for logger access */
 	struct device *dev;
@@ -880,6 +1119,8 @@ struct iwl_mvm {
 	spinlock_t async_handlers_lock;
 	struct work_struct async_handlers_wk;
 
+	struct iwl_mvm_tx_compl tx_compl;
+
 	struct work_struct roc_done_wk;
 
 	unsigned long init_status;
@@ -1264,6 +1505,14 @@ struct iwl_mvm {
 
 	struct iwl_time_sync_data time_sync;
 
+	struct iwl_mvm_rss rss;
+
+	struct iwl_mvm_stats_cache stats_cache;
+
+	struct iwl_mvm_dp_lat dp_lat;
+
+	struct iwl_mvm_regd_cache regd_cache;
+
 #ifdef CPTCFG_IWLMVM_MEI_SCAN_FILTER
 	struct iwl_mei_scan_filter mei_scan_filter;
 #endif
@@ -1718,8 +1967,29 @@ void iwl_mvm_handle_rx_statistics(struct iwl_mvm *mvm,
 void iwl_mvm_rx_statistics(struct iwl_mvm *mvm,
 			   struct iwl_rx_cmd_buffer *rxb);
 int iwl_mvm_request_statistics(struct iwl_mvm *mvm, bool clear);
+
 void iwl_mvm_accu_radio_stats(struct iwl_mvm *mvm);
 
+/* stamp and check the age of the statistics last received from the FW */
+static inline void iwl_mvm_stats_cache_update(struct iwl_mvm *mvm)
+{
+	/* the statistics themselves must be visible before the timestamp */
+	smp_store_release(&mvm->stats_cache.updated, jiffies);
+	WRITE_ONCE(mvm->stats_cache.valid, true);
+}
+
+static inline bool iwl_mvm_stats_cache_fresh(struct iwl_mvm *mvm)
+{
+	u32 max_age_ms = READ_ONCE(mvm->stats_cache.max_age_ms);
+
+	if (!max_age_ms || !READ_ONCE(mvm->stats_cache.valid))
+		return false;
+
+	return time_before(jiffies,
+			   smp_load_acquire(&mvm->stats_cache.updated) +
+			   msecs_to_jiffies(max_age_ms));
+}
+
 /* NVM */
 int iwl_nvm_init(struct iwl_mvm *mvm);
 int iwl_mvm_load_nvm_to_nic(struct iwl_mvm *mvm);
@@ -1786,6 +2056,14 @@ void iwl_mvm_mfu_assert_dump_notif(struct iwl_mvm *mvm,
 				   struct iwl_rx_cmd_buffer *rxb);
 void iwl_mvm_send_recovery_cmd(struct iwl_mvm *mvm, u32 flags);
 void iwl_mvm_rx_ba_notif(struct iwl_mvm *mvm, struct iwl_rx_cmd_buffer *rxb);
+void iwl_mvm_tx_compl_init(struct iwl_mvm *mvm);
+void iwl_mvm_tx_compl_free(struct iwl_mvm *mvm);
+bool iwl_mvm_tx_compl_queue(struct iwl_mvm *mvm, struct iwl_rx_cmd_buffer *rxb,
+			    void (*fn)(struct iwl_mvm *mvm,
+				       struct iwl_rx_cmd_buffer *rxb));
+void iwl_mvm_tx_compl_sync(struct iwl_mvm *mvm);
+void iwl_mvm_tx_compl_stop(struct iwl_mvm *mvm);
+void iwl_mvm_tx_compl_start(struct iwl_mvm *mvm);
 void iwl_mvm_rx_ant_coupling_notif(struct iwl_mvm *mvm,
 				   struct iwl_rx_cmd_buffer *rxb);
 void iwl_mvm_rx_fw_error(struct iwl_mvm *mvm, struct iwl_rx_cmd_buffer *rxb);
@@ -2307,6 +2585,12 @@ struct ieee80211_regdomain *iwl_mvm_get_current_regdomain(struct iwl_mvm *mvm,
 							  bool *changed);
 int iwl_mvm_init_fw_regd(struct iwl_mvm *mvm);
 void iwl_mvm_update_changed_regdom(struct iwl_mvm *mvm);
+int iwl_mvm_set_wiphy_regd(struct iwl_mvm *mvm,
+			   struct ieee80211_regdomain *regd, bool sync);
+struct ieee80211_regdomain *
+iwl_mvm_regd_cache_get(struct iwl_mvm *mvm, struct iwl_mcc_update_resp *resp,
+		       u8 resp_ver);
+void iwl_mvm_regd_cache_flush(struct iwl_mvm *mvm);
 
 /* smart fifo */
 int iwl_mvm_sf_update(struct iwl_mvm *mvm, struct ieee80211_vif *vif,
@@ -2425,6 +2709,8 @@ int iwl_mvm_send_csi_cmd(struct iwl_mvm *mvm);
 void iwl_mvm_ptp_init(struct iwl_mvm *mvm);
 void iwl_mvm_ptp_remove(struct iwl_mvm *mvm);
 u64 iwl_mvm_ptp_get_adj_time(struct iwl_mvm *mvm, u64 base_time);
+int iwl_mvm_mac_get_ts_info(struct ieee80211_hw *hw, u32 *so_timestamping,
+			    int *phc_index);
 #else
 static inline u64 iwl_mvm_ptp_get_adj_time(struct iwl_mvm *mvm, u64 base_time)
 {
@@ -2433,6 +2719,20 @@ static inline u64 iwl_mvm_ptp_get_adj_time(struct iwl_mvm *mvm, u64 base_time)
 #endif
 #endif
 
+/* report the GP2 on-air time of an RX frame as its SO_TIMESTAMPING time */
+static inline void iwl_mvm_rx_hwtstamp(struct iwl_mvm *mvm,
+				       struct sk_buff *skb, u32 gp2)
+{
+#if defined(CPTCFG_IWLMVM_VENDOR_CMDS) && defined(CPTCFG_IWLMVM_PHC)
+	if (!mvm->ptp_data.ptp_clock)
+		return;
+
+	skb_hwtstamps(skb)->hwtstamp =
+		ns_to_ktime(iwl_mvm_ptp_get_adj_time(mvm,
+						     (u64)gp2 * NSEC_PER_USEC));
+#endif
+}
+
 /* NAN */
 void iwl_mvm_nan_match(struct iwl_mvm *mvm,
 		       struct iwl_rx_cmd_buffer *rxb);
@@ -2807,5 +3107,18 @@ int iwl_mvm_set_tx_power(struct iwl_mvm *mvm, struct ieee80211_vif *vif,
 int iwl_mvm_set_hw_timestamp(struct ieee80211_hw *hw,
 			     struct ieee80211_vif *vif,
 			     struct cfg80211_set_hw_timestamp *hwts);
+int iwl_mvm_mac_set_coalesce(struct ieee80211_hw *hw, u32 rx_usecs,
+			     bool adaptive_rx);
+int iwl_mvm_mac_get_coalesce(struct ieee80211_hw *hw, u32 *rx_usecs,
+			     bool *adaptive_rx);
+int iwl_mvm_mac_get_rxfh(struct ieee80211_hw *hw, u32 *indir, u8 *key);
+int iwl_mvm_mac_set_rxfh(struct ieee80211_hw *hw, const u32 *indir,
+			 const u8 *key);
+int iwl_mvm_mac_get_rxnfc(struct ieee80211_hw *hw, struct ethtool_rxnfc *info);
+int iwl_mvm_mac_set_rxnfc(struct ieee80211_hw *hw, struct ethtool_rxnfc *info);
+void iwl_mvm_mac_get_channels(struct ieee80211_hw *hw,
+			      struct ethtool_channels *ch);
+int iwl_mvm_mac_set_channels(struct ieee80211_hw *hw,
+			     struct ethtool_channels *ch);
 int iwl_mvm_update_mu_groups(struct iwl_mvm *mvm, struct ieee80211_vif *vif);
 #endif /* __IWL_MVM_H__ */
@@ -501,6 +501,113 @@ exit:
 	return resp_cp;
 }
 
+static bool iwl_mvm_regd_cache_match(struct iwl_mvm_regd_cache_entry *entry,
+				     struct iwl_mcc_update_resp *resp,
+				     u8 resp_ver)
+{
+	u32 n_channels = le32_to_cpu(resp->n_channels);
+
+	return entry->regd &&
+	       entry->mcc == le16_to_cpu(resp->mcc) &&
+	       entry->geo_info == le16_to_cpu(resp->geo_info) &&
+	       entry->cap == le16_to_cpu(resp->cap) &&
+	       entry->resp_ver == resp_ver &&
+	       entry->n_channels == n_channels &&
+	       !memcmp(entry->channels, resp->channels,
+		       n_channels * sizeof(__le32));
+}
+
+/*
+ * Build the regdomain for an MCC update response, or copy it from the
+ * cache if the same response was parsed before. As with
+ * iwl_parse_nvm_mcc_info(), the caller must kfree() the result.
+ */
+struct ieee80211_regdomain *
+iwl_mvm_regd_cache_get(struct iwl_mvm *mvm, struct iwl_mcc_update_resp *resp,
+		       u8 resp_ver)
+{
+	struct iwl_mvm_regd_cache *cache = &mvm->regd_cache;
+	struct iwl_mvm_regd_cache_entry *entry, *victim = NULL;
+	u32 n_channels = le32_to_cpu(resp->n_channels);
+	struct ieee80211_regdomain *regd, *regd_cp;
+	__le32 *channels;
+	int i;
+
+	lockdep_assert_held(&mvm->mutex);
+
+	cache->use_cnt++;
+
+	for (i = 0; i < ARRAY_SIZE(cache->entries); i++) {
+		entry = &cache->entries[i];
+
+		if (iwl_mvm_regd_cache_match(entry, resp, resp_ver)) {
+			entry->last_used = cache->use_cnt;
+			cache->hits++;
+
+			regd = kmemdup(entry->regd,
+				       struct_size(entry->regd, reg_rules,
+						   entry->regd->n_reg_rules),
+				       GFP_KERNEL);
+			return regd ?: ERR_PTR(-ENOMEM);
+		}
+
+		/* prefer a free entry, otherwise the least recently used */
+		if (!victim || (victim->regd &&
+				(!entry->regd ||
+				 entry->last_used < victim->last_used)))
+			victim = entry;
+	}
+
+	cache->misses++;
+
+	regd = iwl_parse_nvm_mcc_info(mvm->trans->dev, mvm->cfg, n_channels,
+				      resp->channels,
+				      le16_to_cpu(resp->mcc),
+				      le16_to_cpu(resp->geo_info),
+				      le16_to_cpu(resp->cap), resp_ver);
+	if (IS_ERR_OR_NULL(regd))
+		return regd;
+
+	/* failing to cache the regdomain isn't an error */
+	channels = kmemdup(resp->channels, n_channels * sizeof(__le32),
+			   GFP_KERNEL);
+	regd_cp = kmemdup(regd, struct_size(regd, reg_rules, regd->n_reg_rules),
+			  GFP_KERNEL);
+	if (!channels || !regd_cp) {
+		kfree(channels);
+		kfree(regd_cp);
+		return regd;
+	}
+
+	kfree(victim->channels);
+	kfree(victim->regd);
+	victim->mcc = le16_to_cpu(resp->mcc);
+	victim->geo_info = le16_to_cpu(resp->geo_info);
+	victim->cap = le16_to_cpu(resp->cap);
+	victim->resp_ver = resp_ver;
+	victim->n_channels = n_channels;
+	victim->channels = channels;
+	victim->last_used = cache->use_cnt;
+	victim->regd = regd_cp;
+
+	return regd;
+}
+
+void iwl_mvm_regd_cache_flush(struct iwl_mvm *mvm)
+{
+	struct iwl_mvm_regd_cache *cache = &mvm->regd_cache;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(cache->entries); i++) {
+		kfree(cache->entries[i].channels);
+		kfree(cache->entries[i].regd);
+	}
+	memset(cache->entries, 0, sizeof(cache->entries));
+
+	kfree(cache->last);
+	cache->last = NULL;
+}
+
 int iwl_mvm_init_mcc(struct iwl_mvm *mvm)
 {
 	bool tlv_lar;
@@ -552,7 +659,7 @@ int iwl_mvm_init_mcc(struct iwl_mvm *mvm)
 			return -EIO;
 	}
 
-	retval = regulatory_set_wiphy_regd_sync(mvm->hw->wiphy, regd);
+	retval = iwl_mvm_set_wiphy_regd(mvm, regd, true);
 
 	kfree(regd);
 	return retval;
@@ -599,6 +706,6 @@ void iwl_mvm_rx_chub_update_mcc(struct iwl_mvm *mvm,
 		IWL_DEBUG_INFO(mvm, "SAR WGDS: geo profile %d is configured\n",
 			       wgds_tbl_idx);
 
-	regulatory_set_wiphy_regd(mvm->hw->wiphy, regd);
+	iwl_mvm_set_wiphy_regd(mvm, regd, false);
 	kfree(regd);
 }
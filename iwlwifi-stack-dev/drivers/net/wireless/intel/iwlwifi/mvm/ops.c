@@ -32,6 +32,8 @@
 #include "fw/acpi.h"
 #include "fw/uefi.h"
 #include "time-sync.h"
+#include "rss.h"
+#include "dp-lat.h"
 
 #ifdef CPTCFG_IWLWIFI_DEVICE_TESTMODE
 #include "iwl-dnt-cfg.h"
@@ -58,6 +60,9 @@ MODULE_PARM_DESC(init_dbg,
 module_param_named(power_scheme, iwlmvm_mod_params.power_scheme, int, 0444);
 MODULE_PARM_DESC(power_scheme,
 		 "power management scheme: 1-active, 2-balanced, 3-low power, default: 2");
+module_param_named(tx_compl_napi, iwlmvm_mod_params.tx_compl_napi, bool, 0444);
+MODULE_PARM_DESC(tx_compl_napi,
+		 "process TX status in a dedicated NAPI context (default: false)");
 
 #ifdef CPTCFG_IWLWIFI_DEVICE_TESTMODE
 static void iwl_mvm_rx_fw_logs(struct iwl_mvm *mvm,
@@ -316,11 +321,14 @@ static void iwl_mvm_rx_thermal_dual_chain_req(struct iwl_mvm *mvm,
  *	it will be called from a worker with mvm->mutex held.
  * @RX_HANDLER_ASYNC_UNLOCKED : in case the handler needs to lock the
  *	mutex itself, it will be called from a worker without mvm->mutex held.
+ * @RX_HANDLER_TX_STATUS : TX status notification, called from the TX
+ *	completion NAPI if enabled, otherwise like %RX_HANDLER_SYNC.
  */
 enum iwl_rx_handler_context {
 	RX_HANDLER_SYNC,
 	RX_HANDLER_ASYNC_LOCKED,
 	RX_HANDLER_ASYNC_UNLOCKED,
+	RX_HANDLER_TX_STATUS,
 };
 
 /**
@@ -355,9 +363,9 @@ struct iwl_rx_handlers {
  * The handler can be one from three contexts, see &iwl_rx_handler_context
  */
 static const struct iwl_rx_handlers iwl_mvm_rx_handlers[] = {
-	RX_HANDLER(TX_CMD, iwl_mvm_rx_tx_cmd, RX_HANDLER_SYNC,
+	RX_HANDLER(TX_CMD, iwl_mvm_rx_tx_cmd, RX_HANDLER_TX_STATUS,
 		   struct iwl_mvm_tx_resp),
-	RX_HANDLER(BA_NOTIF, iwl_mvm_rx_ba_notif, RX_HANDLER_SYNC,
+	RX_HANDLER(BA_NOTIF, iwl_mvm_rx_ba_notif, RX_HANDLER_TX_STATUS,
 		   struct iwl_mvm_ba_notif),
 
 	RX_HANDLER_GRP(DATA_PATH_GROUP, TLC_MNG_UPDATE_NOTIF,
@@ -1047,6 +1055,7 @@ out_free:
 	iwl_trans_op_mode_leave(mvm->trans);
 	kfree(mvm->nvm_data);
 	kfree(mvm->mei_nvm_data);
+	iwl_mvm_regd_cache_flush(mvm);
 
 	ieee80211_free_hw(mvm->hw);
 }
@@ -1565,6 +1574,10 @@ iwl_op_mode_mvm_start(struct iwl_trans *trans, const struct iwl_cfg *cfg,
 	iwl_mvm_ftm_initiator_smooth_config(mvm);
 
 	iwl_mvm_init_time_sync(&mvm->time_sync);
+	iwl_mvm_rss_init(mvm);
+	iwl_mvm_tx_compl_init(mvm);
+	iwl_mvm_dp_lat_init(mvm);
+	mvm->stats_cache.max_age_ms = IWL_MVM_STATS_CACHE_DEF_MAX_AGE_MS;
 
 	mvm->debugfs_dir = dbgfs_dir;
 
@@ -1594,6 +1607,7 @@ iwl_op_mode_mvm_start(struct iwl_trans *trans, const struct iwl_cfg *cfg,
 
  out_thermal_exit:
 	iwl_mvm_thermal_exit(mvm);
+	iwl_mvm_tx_compl_free(mvm);
 	if (mvm->mei_registered) {
 		iwl_mei_start_unregister();
 		iwl_mei_unregister_complete();
@@ -1624,7 +1638,10 @@ void iwl_mvm_stop_device(struct iwl_mvm *mvm)
 	clear_bit(IWL_MVM_STATUS_FIRMWARE_RUNNING, &mvm->status);
 
 	iwl_fw_dbg_stop_sync(&mvm->fwrt);
+	iwl_mvm_tx_compl_stop(mvm);
 	iwl_trans_stop_device(mvm->trans);
+	iwl_mvm_tx_compl_start(mvm);
+	WRITE_ONCE(mvm->stats_cache.valid, false);
 	iwl_free_fw_paging(&mvm->fwrt);
 	iwl_fw_dump_conf_clear(&mvm->fwrt);
 	iwl_mvm_mei_device_state(mvm, false);
@@ -1692,12 +1709,16 @@ static void iwl_op_mode_mvm_stop(struct iwl_op_mode *op_mode)
 #endif
 	kfree(mvm->nvm_data);
 	kfree(mvm->mei_nvm_data);
+	iwl_mvm_regd_cache_flush(mvm);
 	kfree(rcu_access_pointer(mvm->csme_conn_info));
 	kfree(mvm->temp_nvm_data);
 	for (i = 0; i < NVM_MAX_NUM_SECTIONS; i++)
 		kfree(mvm->nvm_sections[i].data);
 
 	cancel_delayed_work_sync(&mvm->tcm.work);
+	cancel_delayed_work_sync(&mvm->rss.rebalance_wk);
+	cancel_delayed_work_sync(&mvm->dp_lat.ref_wk);
+	iwl_mvm_tx_compl_free(mvm);
 
 #ifdef CPTCFG_IWLMVM_TDLS_PEER_CACHE
 	iwl_mvm_tdls_peer_cache_clear(mvm, NULL);
@@ -1820,7 +1841,12 @@ static void iwl_mvm_rx_common(struct iwl_mvm *mvm,
 		if (unlikely(pkt_len < rx_h->min_size))
 			return;
 
-		if (rx_h->context == RX_HANDLER_SYNC) {
+		if (rx_h->context == RX_HANDLER_TX_STATUS &&
+		    iwl_mvm_tx_compl_queue(mvm, rxb, rx_h->fn))
+			return;
+
+		if (rx_h->context == RX_HANDLER_SYNC ||
+		    rx_h->context == RX_HANDLER_TX_STATUS) {
 			rx_h->fn(mvm, rxb);
 			return;
 		}
@@ -7,6 +7,7 @@
 #include "iwl-debug.h"
 #include <linux/timekeeping.h>
 #include <linux/math64.h>
+#include <linux/net_tstamp.h>
 
 #define IWL_PTP_GP2_WRAP	0x100000000ULL
 #define IWL_PTP_WRAP_TIME	(3600 * HZ)
@@ -21,6 +22,13 @@
 
 #define IWL_PTP_GET_CROSS_TS_NUM	5
 
+static bool iwl_mvm_ptp_is_wrap(struct ptp_data *data, u32 gp2)
+{
+	return gp2 < data->last_gp2 &&
+	       data->last_gp2 - gp2 >= IWL_PTP_WRAP_THRESHOLD_USEC;
+}
+
+/* must be called with ptp_data.lock held for writing */
 static void iwl_mvm_ptp_update_new_read(struct iwl_mvm *mvm, u32 gp2)
 {
 	/*
@@ -28,7 +36,7 @@ static void iwl_mvm_ptp_update_new_read(struct iwl_mvm *mvm, u32 gp2)
 	 * Otherwise assume it's an old read and ignore it.
 	 */
 	if (gp2 < mvm->ptp_data.last_gp2 &&
-	    mvm->ptp_data.last_gp2 - gp2 < IWL_PTP_WRAP_THRESHOLD_USEC) {
+	    !iwl_mvm_ptp_is_wrap(&mvm->ptp_data, gp2)) {
 		IWL_DEBUG_INFO(mvm,
 			       "PTP: ignore old read (gp2=%u, last_gp2=%u)\n",
 			       gp2, mvm->ptp_data.last_gp2);
@@ -45,42 +53,56 @@ static void iwl_mvm_ptp_update_new_read(struct iwl_mvm *mvm, u32 gp2)
 	schedule_delayed_work(&mvm->ptp_data.dwork, IWL_PTP_WRAP_TIME);
 }
 
-u64 iwl_mvm_ptp_get_adj_time(struct iwl_mvm *mvm, u64 base_time_ns)
+/* must be called inside a ptp_data.lock read section, or with it held */
+static u64 iwl_mvm_ptp_gp2_to_ns(struct ptp_data *data, u64 base_time_ns)
 {
-	struct ptp_data *data = &mvm->ptp_data;
-	u64 last_gp2_ns = mvm->ptp_data.scale_update_gp2 * NSEC_PER_USEC;
-	u64 res;
+	u64 last_gp2_ns = (u64)data->scale_update_gp2 * NSEC_PER_USEC;
+	u32 wrap_counter = data->wrap_counter;
 	u64 diff;
 
-	iwl_mvm_ptp_update_new_read(mvm, base_time_ns / NSEC_PER_USEC);
-
-	IWL_DEBUG_INFO(mvm, "base_time_ns=%llu, wrap_counter=%u\n",
-		       (unsigned long long)base_time_ns, data->wrap_counter);
+	/* a read that already wrapped before anyone recorded it */
+	if (iwl_mvm_ptp_is_wrap(data, div_u64(base_time_ns, NSEC_PER_USEC)))
+		wrap_counter++;
 
 	base_time_ns = base_time_ns +
-		(data->wrap_counter * IWL_PTP_GP2_WRAP * NSEC_PER_USEC);
+		(wrap_counter * IWL_PTP_GP2_WRAP * NSEC_PER_USEC);
 
 	/*
 	 * It is possible that a GP2 timestamp was received from fw before the
 	 * last scale update. Since we don't know how to scale - ignore it.
 	 */
-	if (base_time_ns < last_gp2_ns) {
-		IWL_DEBUG_INFO(mvm, "Time before scale update - ignore\n");
+	if (base_time_ns < last_gp2_ns)
 		return 0;
-	}
 
 	diff = base_time_ns - last_gp2_ns;
-	IWL_DEBUG_INFO(mvm, "diff ns=%llu\n", (unsigned long long)diff);
+	if (data->scaled_freq != SCALE_FACTOR)
+		diff = mul_u64_u64_div_u64(diff, data->scaled_freq,
+					   SCALE_FACTOR);
 
-	diff = mul_u64_u64_div_u64(diff, data->scaled_freq,
-				   SCALE_FACTOR);
-	IWL_DEBUG_INFO(mvm, "scaled diff ns=%llu\n", (unsigned long long)diff);
+	return data->scale_update_adj_time_ns + data->delta + diff;
+}
 
-	res = data->scale_update_adj_time_ns + data->delta + diff;
+u64 iwl_mvm_ptp_get_adj_time(struct iwl_mvm *mvm, u64 base_time_ns)
+{
+	struct ptp_data *data = &mvm->ptp_data;
+	u32 gp2 = div_u64(base_time_ns, NSEC_PER_USEC);
+	unsigned int seq;
+	bool wrap;
+	u64 res;
+
+	/* this is called per RX frame, keep it lockless */
+	do {
+		seq = read_seqbegin(&data->lock);
+		wrap = iwl_mvm_ptp_is_wrap(data, gp2);
+		res = iwl_mvm_ptp_gp2_to_ns(data, base_time_ns);
+	} while (read_seqretry(&data->lock, seq));
+
+	if (unlikely(wrap)) {
+		write_seqlock_bh(&data->lock);
+		iwl_mvm_ptp_update_new_read(mvm, gp2);
+		write_sequnlock_bh(&data->lock);
+	}
 
-	IWL_DEBUG_INFO(mvm, "base=%llu delta=%lld adj=%llu\n",
-		       (unsigned long long)base_time_ns, (long long)data->delta,
-		       (unsigned long long)res);
 	return res;
 }
 
@@ -181,7 +203,7 @@ iwl_mvm_phc_get_crosstimestamp(struct ptp_clock_info *ptp,
 	gp2_ns = iwl_mvm_ptp_get_adj_time(mvm, (u64)gp2 * NSEC_PER_USEC);
 
 	IWL_INFO(mvm, "Got Sync Time: GP2:%u, last_GP2: %u, GP2_ns: %lld, sys_time: %lld\n",
-		 gp2, mvm->ptp_data.last_gp2, gp2_ns, (s64)sys_time);
+		 gp2, READ_ONCE(mvm->ptp_data.last_gp2), gp2_ns, (s64)sys_time);
 
 	/* System monotonic raw time is not used */
 	xtstamp->device = (ktime_t)gp2_ns;
@@ -198,10 +220,11 @@ static void iwl_mvm_ptp_work(struct work_struct *wk)
 					   ptp_data.dwork.work);
 	u32 gp2;
 
-	mutex_lock(&mvm->mutex);
 	gp2 = iwl_mvm_get_systime(mvm);
+
+	write_seqlock_bh(&mvm->ptp_data.lock);
 	iwl_mvm_ptp_update_new_read(mvm, gp2);
-	mutex_unlock(&mvm->mutex);
+	write_sequnlock_bh(&mvm->ptp_data.lock);
 }
 
 static int iwl_mvm_ptp_gettime(struct ptp_clock_info *ptp, struct timespec64 *ts)
@@ -211,10 +234,9 @@ static int iwl_mvm_ptp_gettime(struct ptp_clock_info *ptp, struct timespec64 *ts
 	u64 gp2;
 	u64 ns;
 
-	mutex_lock(&mvm->mutex);
+	/* the GP2 read doesn't need the mutex, and the conversion is lockless */
 	gp2 = iwl_mvm_get_systime(mvm);
 	ns = iwl_mvm_ptp_get_adj_time(mvm, gp2 * NSEC_PER_USEC);
-	mutex_unlock(&mvm->mutex);
 
 	*ts = ns_to_timespec64(ns);
 	return 0;
@@ -226,12 +248,15 @@ static int iwl_mvm_ptp_adjtime(struct ptp_clock_info *ptp, s64 delta)
 					   ptp_data.ptp_clock_info);
 	struct ptp_data *data = container_of(ptp, struct ptp_data,
 					     ptp_clock_info);
+	s64 new_delta;
 
-	mutex_lock(&mvm->mutex);
+	write_seqlock_bh(&data->lock);
 	data->delta += delta;
+	new_delta = data->delta;
+	write_sequnlock_bh(&data->lock);
+
 	IWL_DEBUG_INFO(mvm, "delta=%lld, new delta=%lld\n", (long long)delta,
-		       (long long)data->delta);
-	mutex_unlock(&mvm->mutex);
+		       (long long)new_delta);
 	return 0;
 }
 
@@ -242,25 +267,28 @@ static int iwl_mvm_ptp_adjfine(struct ptp_clock_info *ptp, long scaled_ppm)
 	struct ptp_data *data = &mvm->ptp_data;
 	u32 gp2;
 
-	mutex_lock(&mvm->mutex);
+	gp2 = iwl_mvm_get_systime(mvm);
+
+	write_seqlock_bh(&data->lock);
 
 	/*
-	 * Must call _iwl_mvm_ptp_get_adj_time() before updating
+	 * Must call iwl_mvm_ptp_gp2_to_ns() before updating
 	 * data->scale_update_gp2 or data->scaled_freq since
 	 * scale_update_adj_time_ns should reflect the previous scaled_freq.
 	 */
-	gp2 = iwl_mvm_get_systime(mvm);
 	data->scale_update_adj_time_ns =
-		iwl_mvm_ptp_get_adj_time(mvm, gp2 * NSEC_PER_USEC);
+		iwl_mvm_ptp_gp2_to_ns(data, (u64)gp2 * NSEC_PER_USEC);
 	data->scale_update_gp2 = gp2;
+	data->last_gp2 = gp2;
 	data->wrap_counter = 0;
 	data->delta = 0;
 
 	data->scaled_freq = SCALE_FACTOR + scaled_ppm;
-	IWL_DEBUG_INFO(mvm, "adjfine: scaled_ppm=%ld new=%llu\n",
-		       scaled_ppm, (unsigned long long)data->scaled_freq);
 
-	mutex_unlock(&mvm->mutex);
+	write_sequnlock_bh(&data->lock);
+
+	IWL_DEBUG_INFO(mvm, "adjfine: scaled_ppm=%ld new=%llu\n",
+		       scaled_ppm, (unsigned long long)(SCALE_FACTOR + scaled_ppm));
 	return 0;
 }
 
@@ -297,6 +325,7 @@ void iwl_mvm_ptp_init(struct iwl_mvm *mvm)
 	mvm->ptp_data.scale_update_adj_time_ns = 0;
 	mvm->ptp_data.scaled_freq = SCALE_FACTOR;
 	mvm->ptp_data.delta = 0;
+	seqlock_init(&mvm->ptp_data.lock);
 
 	/* Give a short 'friendly name' to identify the PHC clock */
 	snprintf(mvm->ptp_data.ptp_clock_info.name,
@@ -316,9 +345,26 @@ void iwl_mvm_ptp_init(struct iwl_mvm *mvm)
 		IWL_INFO(mvm, "Registered PHC clock: %s, with index: %d\n",
 			 mvm->ptp_data.ptp_clock_info.name,
 			 ptp_clock_index(mvm->ptp_data.ptp_clock));
+		/* GP2 wraps only get recorded by this work or by a reader */
+		schedule_delayed_work(&mvm->ptp_data.dwork, IWL_PTP_WRAP_TIME);
 	}
 }
 
+int iwl_mvm_mac_get_ts_info(struct ieee80211_hw *hw, u32 *so_timestamping,
+			    int *phc_index)
+{
+	struct iwl_mvm *mvm = IWL_MAC80211_GET_MVM(hw);
+
+	if (!mvm->ptp_data.ptp_clock)
+		return -EOPNOTSUPP;
+
+	*so_timestamping = SOF_TIMESTAMPING_RX_HARDWARE |
+			   SOF_TIMESTAMPING_RAW_HARDWARE;
+	*phc_index = ptp_clock_index(mvm->ptp_data.ptp_clock);
+
+	return 0;
+}
+
 /*
  * iwl_mvm_ptp_remove - disable PTP device.
  * @mvm: internal mvm structure, see &struct iwl_mvm.
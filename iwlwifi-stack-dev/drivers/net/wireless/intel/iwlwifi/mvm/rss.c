@@ -0,0 +1,433 @@
+// SPDX-License-Identifier: GPL-2.0 OR BSD-3-Clause
+/*
+ * Copyright (C) 2023 Intel Corporation
+ */
+#include <linux/ethtool.h>
+#include <linux/netdevice.h>
+#include "mvm.h"
+#include "rss.h"
+
+#define IWL_MVM_RSS_REBALANCE_INTERVAL	HZ
+/* don't bother moving buckets unless the busiest queue sees this much */
+#define IWL_MVM_RSS_REBALANCE_MIN_PKTS	1000
+
+#define IWL_MVM_RSS_L3_FIELDS	(RXH_IP_SRC | RXH_IP_DST)
+#define IWL_MVM_RSS_L4_FIELDS	(IWL_MVM_RSS_L3_FIELDS | \
+				 RXH_L4_B_0_1 | RXH_L4_B_2_3)
+
+/*
+ * ethtool RX ring N is RX hardware queue N + 1, queue 0 is the default
+ * queue for non-RSS traffic and never appears in the indirection table.
+ */
+static inline u32 iwl_mvm_rss_queue_to_ring(u8 queue)
+{
+	return queue - 1;
+}
+
+static inline u8 iwl_mvm_rss_ring_to_queue(u32 ring)
+{
+	return ring + 1;
+}
+
+static void iwl_mvm_rss_fill_default_indir(struct iwl_mvm *mvm)
+{
+	struct iwl_mvm_rss *rss = &mvm->rss;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(rss->indir); i++)
+		rss->indir[i] = 1 + (i % rss->num_queues);
+}
+
+static void iwl_mvm_rss_rebalance_wk(struct work_struct *wk)
+{
+	struct iwl_mvm *mvm = container_of(wk, struct iwl_mvm,
+					   rss.rebalance_wk.work);
+	struct iwl_mvm_rss *rss = &mvm->rss;
+	u32 load[IWL_MAX_RX_HW_QUEUES] = {};
+	u8 buckets[IWL_MAX_RX_HW_QUEUES] = {};
+	u8 max_q = 0, min_q = 0;
+	int i;
+
+	mutex_lock(&mvm->mutex);
+
+	if (!rss->rebalance || !iwl_mvm_firmware_running(mvm))
+		goto out_unlock;
+
+	for (i = 1; i < mvm->trans->num_rx_queues; i++) {
+		u32 pkts = READ_ONCE(rss->rx_pkts[i]);
+
+		load[i] = pkts - rss->last_rx_pkts[i];
+		rss->last_rx_pkts[i] = pkts;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(rss->indir); i++)
+		buckets[rss->indir[i]]++;
+
+	/* only consider queues that are part of the table at all */
+	for (i = 1; i < mvm->trans->num_rx_queues; i++) {
+		if (!buckets[i])
+			continue;
+		if (!max_q || load[i] > load[max_q])
+			max_q = i;
+		if (!min_q || load[i] < load[min_q])
+			min_q = i;
+	}
+
+	if (max_q == min_q || buckets[max_q] == 1 ||
+	    load[max_q] < IWL_MVM_RSS_REBALANCE_MIN_PKTS ||
+	    load[max_q] <= load[min_q] + load[min_q] / 2)
+		goto out_resched;
+
+	/*
+	 * The hash of the flows isn't reported, so we can't tell which of
+	 * the busy queue's buckets carries the load - rotate through them
+	 * and move one per interval until the load evens out.
+	 */
+	for (i = 0; i < ARRAY_SIZE(rss->indir); i++) {
+		int idx = (rss->rebalance_next + i) % ARRAY_SIZE(rss->indir);
+
+		if (rss->indir[idx] != max_q)
+			continue;
+
+		IWL_DEBUG_RX(mvm,
+			     "RSS: moving bucket %d from queue %d (%u pkts) to queue %d (%u pkts)\n",
+			     idx, max_q, load[max_q], min_q, load[min_q]);
+		rss->indir[idx] = min_q;
+		rss->rebalance_next = (idx + 1) % ARRAY_SIZE(rss->indir);
+		break;
+	}
+
+	/* this also reschedules the work */
+	iwl_mvm_rss_send_cfg(mvm);
+	goto out_unlock;
+
+out_resched:
+	schedule_delayed_work(&rss->rebalance_wk,
+			      IWL_MVM_RSS_REBALANCE_INTERVAL);
+out_unlock:
+	mutex_unlock(&mvm->mutex);
+}
+
+void iwl_mvm_rss_init(struct iwl_mvm *mvm)
+{
+	struct iwl_mvm_rss *rss = &mvm->rss;
+
+	INIT_DELAYED_WORK(&rss->rebalance_wk, iwl_mvm_rss_rebalance_wk);
+
+	rss->hash_mask = BIT(IWL_RSS_HASH_TYPE_IPV4_TCP) |
+			 BIT(IWL_RSS_HASH_TYPE_IPV4_UDP) |
+			 BIT(IWL_RSS_HASH_TYPE_IPV4_PAYLOAD) |
+			 BIT(IWL_RSS_HASH_TYPE_IPV6_TCP) |
+			 BIT(IWL_RSS_HASH_TYPE_IPV6_UDP) |
+			 BIT(IWL_RSS_HASH_TYPE_IPV6_PAYLOAD);
+	netdev_rss_key_fill(rss->key, sizeof(rss->key));
+
+	if (mvm->trans->num_rx_queues <= 1)
+		return;
+
+	/* Do not direct RSS traffic to Q 0 which is our fallback queue */
+	rss->num_queues = mvm->trans->num_rx_queues - 1;
+	iwl_mvm_rss_fill_default_indir(mvm);
+}
+
+int iwl_mvm_rss_send_cfg(struct iwl_mvm *mvm)
+{
+	struct iwl_mvm_rss *rss = &mvm->rss;
+	struct iwl_rss_config_cmd cmd = {
+		.flags = cpu_to_le32(IWL_RSS_ENABLE),
+		.hash_mask = rss->hash_mask,
+	};
+
+	lockdep_assert_held(&mvm->mutex);
+
+	if (mvm->trans->num_rx_queues == 1)
+		return 0;
+
+	BUILD_BUG_ON(sizeof(cmd.indirection_table) != sizeof(rss->indir));
+	BUILD_BUG_ON(sizeof(cmd.secret_key) != sizeof(rss->key));
+	memcpy(cmd.indirection_table, rss->indir, sizeof(rss->indir));
+	memcpy(cmd.secret_key, rss->key, sizeof(rss->key));
+
+	if (rss->rebalance)
+		schedule_delayed_work(&rss->rebalance_wk,
+				      IWL_MVM_RSS_REBALANCE_INTERVAL);
+
+	return iwl_mvm_send_cmd_pdu(mvm, RSS_CONFIG_CMD, 0, sizeof(cmd), &cmd);
+}
+
+static int iwl_mvm_rss_update(struct iwl_mvm *mvm)
+{
+	if (!iwl_mvm_firmware_running(mvm))
+		return 0;
+
+	return iwl_mvm_rss_send_cfg(mvm);
+}
+
+/*
+ * Install an explicit indirection table of RX hardware queues. This turns
+ * off the rebalancer since it would undo the configuration.
+ */
+int iwl_mvm_rss_set_indir(struct iwl_mvm *mvm, const u8 *queues)
+{
+	struct iwl_mvm_rss *rss = &mvm->rss;
+	int i;
+
+	lockdep_assert_held(&mvm->mutex);
+
+	for (i = 0; i < ARRAY_SIZE(rss->indir); i++)
+		if (!queues[i] || queues[i] > rss->num_queues)
+			return -EINVAL;
+
+	memcpy(rss->indir, queues, sizeof(rss->indir));
+	rss->user_indir = true;
+	rss->rebalance = false;
+
+	return iwl_mvm_rss_update(mvm);
+}
+
+void iwl_mvm_rss_set_rebalance(struct iwl_mvm *mvm, bool enable)
+{
+	struct iwl_mvm_rss *rss = &mvm->rss;
+
+	lockdep_assert_held(&mvm->mutex);
+
+	if (rss->rebalance == enable)
+		return;
+
+	if (enable) {
+		memcpy(rss->last_rx_pkts, rss->rx_pkts,
+		       sizeof(rss->last_rx_pkts));
+		rss->user_indir = false;
+		if (iwl_mvm_firmware_running(mvm))
+			schedule_delayed_work(&rss->rebalance_wk,
+					      IWL_MVM_RSS_REBALANCE_INTERVAL);
+	}
+
+	/* a pending run will notice this and not reschedule itself */
+	WRITE_ONCE(rss->rebalance, enable);
+}
+
+int iwl_mvm_mac_get_rxfh(struct ieee80211_hw *hw, u32 *indir, u8 *key)
+{
+	struct iwl_mvm *mvm = IWL_MAC80211_GET_MVM(hw);
+	struct iwl_mvm_rss *rss = &mvm->rss;
+	int i;
+
+	if (!iwl_mvm_rss_supported(mvm))
+		return -EOPNOTSUPP;
+
+	mutex_lock(&mvm->mutex);
+	if (indir)
+		for (i = 0; i < ARRAY_SIZE(rss->indir); i++)
+			indir[i] = iwl_mvm_rss_queue_to_ring(rss->indir[i]);
+	if (key)
+		memcpy(key, rss->key, sizeof(rss->key));
+	mutex_unlock(&mvm->mutex);
+
+	return 0;
+}
+
+int iwl_mvm_mac_set_rxfh(struct ieee80211_hw *hw, const u32 *indir,
+			 const u8 *key)
+{
+	struct iwl_mvm *mvm = IWL_MAC80211_GET_MVM(hw);
+	struct iwl_mvm_rss *rss = &mvm->rss;
+	u8 queues[IWL_RSS_INDIRECTION_TABLE_SIZE];
+	int i, ret = 0;
+
+	if (!iwl_mvm_rss_supported(mvm))
+		return -EOPNOTSUPP;
+
+	/* ethtool already validated the rings against get_rxnfc */
+	if (indir)
+		for (i = 0; i < ARRAY_SIZE(queues); i++)
+			queues[i] = iwl_mvm_rss_ring_to_queue(indir[i]);
+
+	mutex_lock(&mvm->mutex);
+	if (key)
+		memcpy(rss->key, key, sizeof(rss->key));
+	if (indir)
+		ret = iwl_mvm_rss_set_indir(mvm, queues);
+	else if (key)
+		ret = iwl_mvm_rss_update(mvm);
+	mutex_unlock(&mvm->mutex);
+
+	return ret;
+}
+
+static int iwl_mvm_rss_flow_hash_types(u32 flow_type, u8 *l4, u8 *l3)
+{
+	switch (flow_type) {
+	case TCP_V4_FLOW:
+		*l4 = IWL_RSS_HASH_TYPE_IPV4_TCP;
+		*l3 = IWL_RSS_HASH_TYPE_IPV4_PAYLOAD;
+		return 0;
+	case UDP_V4_FLOW:
+		*l4 = IWL_RSS_HASH_TYPE_IPV4_UDP;
+		*l3 = IWL_RSS_HASH_TYPE_IPV4_PAYLOAD;
+		return 0;
+	case IPV4_FLOW:
+		*l4 = 0xff;
+		*l3 = IWL_RSS_HASH_TYPE_IPV4_PAYLOAD;
+		return 0;
+	case TCP_V6_FLOW:
+		*l4 = IWL_RSS_HASH_TYPE_IPV6_TCP;
+		*l3 = IWL_RSS_HASH_TYPE_IPV6_PAYLOAD;
+		return 0;
+	case UDP_V6_FLOW:
+		*l4 = IWL_RSS_HASH_TYPE_IPV6_UDP;
+		*l3 = IWL_RSS_HASH_TYPE_IPV6_PAYLOAD;
+		return 0;
+	case IPV6_FLOW:
+		*l4 = 0xff;
+		*l3 = IWL_RSS_HASH_TYPE_IPV6_PAYLOAD;
+		return 0;
+	default:
+		return -EINVAL;
+	}
+}
+
+int iwl_mvm_mac_get_rxnfc(struct ieee80211_hw *hw, struct ethtool_rxnfc *info)
+{
+	struct iwl_mvm *mvm = IWL_MAC80211_GET_MVM(hw);
+	u8 hash_mask, l4, l3;
+	int ret;
+
+	if (!iwl_mvm_rss_supported(mvm))
+		return -EOPNOTSUPP;
+
+	switch (info->cmd) {
+	case ETHTOOL_GRXRINGS:
+		info->data = mvm->trans->num_rx_queues - 1;
+		return 0;
+	case ETHTOOL_GRXFH:
+		ret = iwl_mvm_rss_flow_hash_types(info->flow_type, &l4, &l3);
+		if (ret)
+			return ret;
+
+		hash_mask = READ_ONCE(mvm->rss.hash_mask);
+		if (l4 != 0xff && hash_mask & BIT(l4))
+			info->data = IWL_MVM_RSS_L4_FIELDS;
+		else if (hash_mask & BIT(l3))
+			info->data = IWL_MVM_RSS_L3_FIELDS;
+		else
+			info->data = 0;
+		return 0;
+	default:
+		return -EOPNOTSUPP;
+	}
+}
+
+int iwl_mvm_mac_set_rxnfc(struct ieee80211_hw *hw, struct ethtool_rxnfc *info)
+{
+	struct iwl_mvm *mvm = IWL_MAC80211_GET_MVM(hw);
+	struct iwl_mvm_rss *rss = &mvm->rss;
+	u8 hash_mask, l4, l3;
+	int ret;
+
+	if (!iwl_mvm_rss_supported(mvm))
+		return -EOPNOTSUPP;
+
+	if (info->cmd != ETHTOOL_SRXFH)
+		return -EOPNOTSUPP;
+
+	ret = iwl_mvm_rss_flow_hash_types(info->flow_type, &l4, &l3);
+	if (ret)
+		return ret;
+
+	mutex_lock(&mvm->mutex);
+	hash_mask = rss->hash_mask;
+
+	/*
+	 * The firmware hashes either on the L3 addresses or also on the
+	 * L4 ports, there's no finer control over the fields.
+	 */
+	switch (info->data) {
+	case IWL_MVM_RSS_L4_FIELDS:
+		if (l4 == 0xff) {
+			ret = -EINVAL;
+			goto out_unlock;
+		}
+		hash_mask |= BIT(l4) | BIT(l3);
+		break;
+	case IWL_MVM_RSS_L3_FIELDS:
+		if (l4 != 0xff)
+			hash_mask &= ~BIT(l4);
+		hash_mask |= BIT(l3);
+		break;
+	case 0:
+		/* the L3 hash is shared by all flow types of the family */
+		if (l4 != 0xff) {
+			ret = -EINVAL;
+			goto out_unlock;
+		}
+		hash_mask &= ~BIT(l3);
+		break;
+	default:
+		ret = -EINVAL;
+		goto out_unlock;
+	}
+
+	if (hash_mask != rss->hash_mask) {
+		WRITE_ONCE(rss->hash_mask, hash_mask);
+		ret = iwl_mvm_rss_update(mvm);
+	}
+
+out_unlock:
+	mutex_unlock(&mvm->mutex);
+	return ret;
+}
+
+void iwl_mvm_mac_get_channels(struct ieee80211_hw *hw,
+			      struct ethtool_channels *ch)
+{
+	struct iwl_mvm *mvm = IWL_MAC80211_GET_MVM(hw);
+
+	if (!iwl_mvm_rss_supported(mvm))
+		return;
+
+	/* the default queue is reported as the single "other" channel */
+	ch->max_combined = mvm->trans->num_rx_queues - 1;
+	ch->max_other = 1;
+	ch->other_count = 1;
+	ch->combined_count = READ_ONCE(mvm->rss.num_queues);
+}
+
+int iwl_mvm_mac_set_channels(struct ieee80211_hw *hw,
+			     struct ethtool_channels *ch)
+{
+	struct iwl_mvm *mvm = IWL_MAC80211_GET_MVM(hw);
+	struct iwl_mvm_rss *rss = &mvm->rss;
+	int i, ret = 0;
+
+	if (!iwl_mvm_rss_supported(mvm))
+		return -EOPNOTSUPP;
+
+	/* ethtool checked the counts against the maximums */
+	if (!ch->combined_count || ch->other_count != 1)
+		return -EINVAL;
+
+	mutex_lock(&mvm->mutex);
+	if (ch->combined_count == rss->num_queues)
+		goto out_unlock;
+
+	/* don't silently drop queues from a user-configured table */
+	if (rss->user_indir) {
+		for (i = 0; i < ARRAY_SIZE(rss->indir); i++) {
+			if (rss->indir[i] > ch->combined_count) {
+				ret = -EINVAL;
+				goto out_unlock;
+			}
+		}
+	}
+
+	WRITE_ONCE(rss->num_queues, ch->combined_count);
+	if (!rss->user_indir)
+		iwl_mvm_rss_fill_default_indir(mvm);
+
+	ret = iwl_mvm_rss_update(mvm);
+
+out_unlock:
+	mutex_unlock(&mvm->mutex);
+	return ret;
+}
@@ -0,0 +1,27 @@
+/* SPDX-License-Identifier: GPL-2.0 OR BSD-3-Clause */
+/*
+ * Copyright (C) 2023 Intel Corporation
+ */
+#ifndef __RSS_H__
+#define __RSS_H__
+
+#include "mvm.h"
+
+void iwl_mvm_rss_init(struct iwl_mvm *mvm);
+int iwl_mvm_rss_send_cfg(struct iwl_mvm *mvm);
+int iwl_mvm_rss_set_indir(struct iwl_mvm *mvm, const u8 *queues);
+void iwl_mvm_rss_set_rebalance(struct iwl_mvm *mvm, bool enable);
+
+static inline bool iwl_mvm_rss_supported(struct iwl_mvm *mvm)
+{
+	return iwl_mvm_has_new_rx_api(mvm) && mvm->trans->num_rx_queues > 1;
+}
+
+static inline void iwl_mvm_rss_count_rx(struct iwl_mvm *mvm, int queue)
+{
+	/* each queue's counter is only written from that queue's NAPI */
+	if (READ_ONCE(mvm->rss.rebalance))
+		WRITE_ONCE(mvm->rss.rx_pkts[queue],
+			   mvm->rss.rx_pkts[queue] + 1);
+}
+#endif
@@ -340,6 +340,7 @@ void iwl_mvm_rx_rx_mpdu(struct iwl_mvm *mvm, struct napi_struct *napi,
 	/* rx_status carries information about the packet to mac80211 */
 	rx_status->mactime = le64_to_cpu(phy_info->timestamp);
 	rx_status->device_timestamp = le32_to_cpu(phy_info->system_timestamp);
+	iwl_mvm_rx_hwtstamp(mvm, skb, rx_status->device_timestamp);
 	rx_status->band =
 		(phy_info->phy_flags & cpu_to_le16(RX_RES_PHY_FLAGS_BAND_24)) ?
 				NL80211_BAND_2GHZ : NL80211_BAND_5GHZ;
@@ -830,7 +831,7 @@ static bool iwl_mvm_verify_stats_len(struct iwl_mvm *mvm,
 	return true;
 }
 
-static void
+static bool
 iwl_mvm_handle_rx_statistics_tlv(struct iwl_mvm *mvm,
 				 struct iwl_rx_packet *pkt)
 {
@@ -844,14 +845,14 @@ iwl_mvm_handle_rx_statistics_tlv(struct iwl_mvm *mvm,
 
 	if (WARN_ONCE(notif_ver > 15,
 		      "invalid statistics version id: %d\n", notif_ver))
-		return;
+		return false;
 
 	if (notif_ver == 14) {
 		struct iwl_statistics_operational_ntfy_ver_14 *stats =
 			(void *)pkt->data;
 
 		if (!iwl_mvm_verify_stats_len(mvm, pkt, sizeof(*stats)))
-			return;
+			return false;
 
 		iwl_mvm_stats_ver_14(mvm, stats);
 
@@ -876,7 +877,7 @@ iwl_mvm_handle_rx_statistics_tlv(struct iwl_mvm *mvm,
 			(void *)pkt->data;
 
 		if (!iwl_mvm_verify_stats_len(mvm, pkt, sizeof(*stats)))
-			return;
+			return false;
 
 		iwl_mvm_stats_ver_15(mvm, stats);
 
@@ -908,6 +909,8 @@ iwl_mvm_handle_rx_statistics_tlv(struct iwl_mvm *mvm,
 	 */
 	if (le32_to_cpu(flags) & IWL_STATISTICS_REPLY_FLG_CLEAR)
 		iwl_mvm_update_tcm_from_stats(mvm, air_time, rx_bytes);
+
+	return true;
 }
 
 void iwl_mvm_handle_rx_statistics(struct iwl_mvm *mvm,
@@ -922,8 +925,11 @@ void iwl_mvm_handle_rx_statistics(struct iwl_mvm *mvm,
 
 	/* From ver 14 and up we use TLV statistics format */
 	if (iwl_fw_lookup_notif_ver(mvm->fw, LEGACY_GROUP,
-				    STATISTICS_NOTIFICATION, 0) >= 14)
-		return iwl_mvm_handle_rx_statistics_tlv(mvm, pkt);
+				    STATISTICS_NOTIFICATION, 0) >= 14) {
+		if (iwl_mvm_handle_rx_statistics_tlv(mvm, pkt))
+			iwl_mvm_stats_cache_update(mvm);
+		return;
+	}
 
 	if (!iwl_mvm_has_new_rx_stats_api(mvm)) {
 		if (iwl_mvm_has_new_rx_api(mvm))
@@ -993,6 +999,8 @@ void iwl_mvm_handle_rx_statistics(struct iwl_mvm *mvm,
 					    iwl_mvm_stat_iterator,
 					    &data);
 
+	iwl_mvm_stats_cache_update(mvm);
+
 	if (!iwl_mvm_has_new_rx_api(mvm))
 		return;
 
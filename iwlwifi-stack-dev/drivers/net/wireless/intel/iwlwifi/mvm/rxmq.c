@@ -10,6 +10,8 @@
 #include "mvm.h"
 #include "fw-api.h"
 #include "time-sync.h"
+#include "rss.h"
+#include "dp-lat.h"
 
 static inline int iwl_mvm_check_pn(struct iwl_mvm *mvm, struct sk_buff *skb,
 				   int queue, struct ieee80211_sta *sta)
@@ -254,7 +256,10 @@ static void iwl_mvm_pass_packet_to_mac80211(struct iwl_mvm *mvm,
 					    struct ieee80211_sta *sta,
 					    struct ieee80211_link_sta *link_sta)
 {
+	u64 lat_ns;
+
 	if (unlikely(iwl_mvm_check_pn(mvm, skb, queue, sta))) {
+		iwl_mvm_dp_lat_rx_drop(mvm, queue, skb);
 		kfree_skb(skb);
 		return;
 	}
@@ -266,7 +271,13 @@ static void iwl_mvm_pass_packet_to_mac80211(struct iwl_mvm *mvm,
 		rx_status->link_id = link_sta->link_id;
 	}
 
+	lat_ns = iwl_mvm_dp_lat_rx_release(mvm, queue, skb);
+
 	ieee80211_rx_napi(mvm->hw, sta, skb, napi);
+
+	if (unlikely(lat_ns))
+		iwl_mvm_dp_lat_record(mvm, IWL_MVM_DP_LAT_RX_DELIVER, lat_ns,
+				      ktime_get_ns());
 }
 
 static void iwl_mvm_get_signal_strength(struct iwl_mvm *mvm,
@@ -1132,6 +1143,7 @@ static bool iwl_mvm_reorder(struct iwl_mvm *mvm,
 	return true;
 
 drop:
+	iwl_mvm_dp_lat_rx_drop(mvm, queue, skb);
 	kfree_skb(skb);
 	spin_unlock_bh(&buffer->lock);
 	return true;
@@ -2174,6 +2186,7 @@ static void iwl_mvm_rx_fill_status(struct iwl_mvm *mvm,
 	iwl_mvm_decode_lsig(skb, phy_data);
 
 	rx_status->device_timestamp = phy_data->gp2_on_air_rise;
+	iwl_mvm_rx_hwtstamp(mvm, skb, phy_data->gp2_on_air_rise);
 	rx_status->freq = ieee80211_channel_to_frequency(phy_data->channel,
 							 rx_status->band);
 	iwl_mvm_get_signal_strength(mvm, rx_status, rate_n_flags,
@@ -2335,6 +2348,8 @@ void iwl_mvm_rx_mpdu_mq(struct iwl_mvm *mvm, struct napi_struct *napi,
 	if (unlikely(test_bit(IWL_MVM_STATUS_IN_HW_RESTART, &mvm->status)))
 		return;
 
+	iwl_mvm_rss_count_rx(mvm, queue);
+
 	if (mvm->trans->trans_cfg->device_family >= IWL_DEVICE_FAMILY_AX210)
 		desc_size = sizeof(*desc);
 	else
@@ -2499,6 +2514,7 @@ void iwl_mvm_rx_mpdu_mq(struct iwl_mvm *mvm, struct napi_struct *napi,
 	}
 
 	iwl_mvm_rx_fill_status(mvm, skb, &phy_data, queue);
+	iwl_mvm_dp_lat_rx_arm(mvm, queue, skb, rxb, phy_data.gp2_on_air_rise);
 
 	if (sta) {
 		struct iwl_mvm_sta *mvmsta = iwl_mvm_sta_from_mac80211(sta);
@@ -2574,6 +2590,7 @@ void iwl_mvm_rx_mpdu_mq(struct iwl_mvm *mvm, struct napi_struct *napi,
 #endif /* CPTCFG_IWLMVM_TDLS_PEER_CACHE */
 
 		if (iwl_mvm_is_dup(sta, queue, rx_status, hdr, desc)) {
+			iwl_mvm_dp_lat_rx_drop(mvm, queue, skb);
 			kfree_skb(skb);
 			goto out;
 		}
@@ -2619,6 +2636,7 @@ void iwl_mvm_rx_mpdu_mq(struct iwl_mvm *mvm, struct napi_struct *napi,
 	}
 
 	if (iwl_mvm_create_skb(mvm, skb, hdr, len, crypt_len, rxb)) {
+		iwl_mvm_dp_lat_rx_drop(mvm, queue, skb);
 		kfree_skb(skb);
 		goto out;
 	}
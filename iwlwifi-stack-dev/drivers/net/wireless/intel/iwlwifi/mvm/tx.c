@@ -15,6 +15,7 @@
 #include "mvm.h"
 #include "sta.h"
 #include "time-sync.h"
+#include "dp-lat.h"
 
 static void
 iwl_mvm_bar_check_trigger(struct iwl_mvm *mvm, const u8 *addr,
@@ -1213,6 +1214,8 @@ static int iwl_mvm_tx_mpdu(struct iwl_mvm *mvm, struct sk_buff *skb,
 					    !iwl_mvm_has_new_tx_api(mvm) ?
 					    info->control.hw_key->iv_len : 0);
 
+	iwl_mvm_dp_lat_tx_trans(mvm, skb);
+
 	if (iwl_trans_tx(mvm->trans, skb, dev_cmd, txq_id))
 		goto drop_unlock_sta;
 
@@ -1546,13 +1549,14 @@ static void iwl_mvm_rx_tx_cmd_single(struct iwl_mvm *mvm,
 		iwl_mvm_get_agg_status(mvm, tx_resp);
 	u32 status = le16_to_cpu(agg_status->status);
 	u16 ssn = iwl_mvm_get_scd_ssn(mvm, tx_resp);
-	struct sk_buff_head skbs;
+	struct sk_buff_head skbs, status_skbs;
 	u8 skb_freed = 0;
 	u8 lq_color;
 	u16 next_reclaimed, seq_ctl;
 	bool is_ndp = false;
 
 	__skb_queue_head_init(&skbs);
+	__skb_queue_head_init(&status_skbs);
 
 	if (iwl_mvm_has_new_tx_api(mvm))
 		txq_id = le16_to_cpu(tx_resp->tx_queue);
@@ -1570,6 +1574,7 @@ static void iwl_mvm_rx_tx_cmd_single(struct iwl_mvm *mvm,
 
 		skb_freed++;
 
+		iwl_mvm_dp_lat_tx_status(mvm, skb);
 		iwl_trans_free_tx_cmd(mvm->trans, info->driver_data[1]);
 
 		memset(&info->status, 0, sizeof(info->status));
@@ -1671,7 +1676,7 @@ static void iwl_mvm_rx_tx_cmd_single(struct iwl_mvm *mvm,
 #endif /* CPTCFG_IWLMVM_TDLS_PEER_CACHE */
 
 		if (likely(!iwl_mvm_time_sync_frame(mvm, skb, hdr->addr1)))
-			ieee80211_tx_status(mvm->hw, skb);
+			__skb_queue_tail(&status_skbs, skb);
 	}
 
 	/* This is an aggregation queue or might become one, so we use
@@ -1703,6 +1708,14 @@ static void iwl_mvm_rx_tx_cmd_single(struct iwl_mvm *mvm,
 	rcu_read_lock();
 
 	sta = rcu_dereference(mvm->fw_id_to_mac_id[sta_id]);
+
+	/*
+	 * Frames on a station queue all belong to that station, so report
+	 * them in one go; for internal stations mac80211 looks them up.
+	 */
+	ieee80211_tx_status_list(mvm->hw, IS_ERR_OR_NULL(sta) ? NULL : sta,
+				 &status_skbs);
+
 	/*
 	 * sta can't be NULL otherwise it'd mean that the sta has been freed in
 	 * the firmware while we still have packets for it in the Tx queues.
@@ -1927,6 +1940,7 @@ static void iwl_mvm_tx_reclaim(struct iwl_mvm *mvm, int sta_id, int tid,
 	skb_queue_walk(&reclaimed_skbs, skb) {
 		struct ieee80211_tx_info *info = IEEE80211_SKB_CB(skb);
 
+		iwl_mvm_dp_lat_tx_status(mvm, skb);
 		iwl_trans_free_tx_cmd(mvm->trans, info->driver_data[1]);
 
 		memset(&info->status, 0, sizeof(info->status));
@@ -2025,12 +2039,10 @@ static void iwl_mvm_tx_reclaim(struct iwl_mvm *mvm, int sta_id, int tid,
 	}
 
 out:
+	/* all the reclaimed frames were sent to this station (if it exists) */
+	ieee80211_tx_status_list(mvm->hw, IS_ERR(sta) ? NULL : sta,
+				 &reclaimed_skbs);
 	rcu_read_unlock();
-
-	while (!skb_queue_empty(&reclaimed_skbs)) {
-		skb = __skb_dequeue(&reclaimed_skbs);
-		ieee80211_tx_status(mvm->hw, skb);
-	}
 }
 
 void iwl_mvm_rx_ba_notif(struct iwl_mvm *mvm, struct iwl_rx_cmd_buffer *rxb)
@@ -2233,6 +2245,9 @@ int iwl_mvm_flush_sta_tids(struct iwl_mvm *mvm, u32 sta_id, u16 tids)
 			goto free_rsp;
 		}
 
+		/* status that was reported before the flush goes first */
+		iwl_mvm_tx_compl_sync(mvm);
+
 		for (i = 0; i < num_flushed_queues; i++) {
 			struct ieee80211_tx_info tx_info = {};
 			struct iwl_flush_queue_info *queue_info = &rsp->queues[i];
@@ -2278,3 +2293,298 @@ int iwl_mvm_flush_sta(struct iwl_mvm *mvm, void *sta, bool internal)
 
 	return iwl_mvm_flush_tx_path(mvm, tfd_queue_msk);
 }
+
+/*
+ * TX status notifications (TX_CMD, BA_NOTIF) all arrive on the default RX
+ * queue. Instead of reclaiming inline, interleaved with RX, they may be
+ * queued to a dedicated NAPI context with its own budget, which can also
+ * be threaded and run on a different CPU. Notifications are processed in
+ * the order they arrived since reclaim depends on it.
+ */
+static void iwl_mvm_tx_compl_process(struct iwl_mvm *mvm,
+				     struct list_head *batch)
+{
+	struct iwl_mvm_tx_compl *tc = &mvm->tx_compl;
+	struct iwl_mvm_tx_compl_entry *entry, *tmp;
+	u64 lat, lat_sum = 0, lat_max = 0;
+	u32 n = 0;
+
+	list_for_each_entry_safe(entry, tmp, batch, list) {
+		lat = ktime_get_ns() - entry->ts;
+		entry->fn(mvm, &entry->rxb);
+		iwl_free_rxb(&entry->rxb);
+
+		lat_sum += lat;
+		lat_max = max(lat_max, lat);
+		n++;
+
+		if (!entry->pooled) {
+			list_del(&entry->list);
+			kfree(entry);
+		}
+	}
+
+	/* account for the whole batch with a single lock round */
+	spin_lock_bh(&tc->lock);
+	tc->stats.notifs += n;
+	tc->stats.lat_sum_ns += lat_sum;
+	tc->stats.lat_max_ns = max(tc->stats.lat_max_ns, lat_max);
+	list_splice(batch, &tc->free);
+	tc->polling = false;
+	spin_unlock_bh(&tc->lock);
+}
+
+static int iwl_mvm_tx_compl_poll(struct napi_struct *napi, int budget)
+{
+	struct iwl_mvm_tx_compl *tc =
+		container_of(napi, struct iwl_mvm_tx_compl, napi);
+	struct iwl_mvm *mvm = container_of(tc, struct iwl_mvm, tx_compl);
+	LIST_HEAD(batch);
+	int done = 0;
+
+	/* take up to a budget worth of notifications in one go */
+	spin_lock_bh(&tc->lock);
+	while (done < budget && !list_empty(&tc->pending)) {
+		list_move_tail(tc->pending.next, &batch);
+		done++;
+	}
+	tc->stats.pending -= done;
+	tc->stats.polls++;
+	tc->polling = done > 0;
+	spin_unlock_bh(&tc->lock);
+
+	iwl_mvm_tx_compl_process(mvm, &batch);
+
+	if (done < budget)
+		napi_complete_done(napi, done);
+
+	return done;
+}
+
+/* must be called with tc->lock held and the NAPI not processing a batch */
+static void iwl_mvm_tx_compl_take_pending(struct iwl_mvm_tx_compl *tc,
+					  struct list_head *batch)
+{
+	lockdep_assert_held(&tc->lock);
+
+	list_splice_init(&tc->pending, batch);
+	tc->stats.pending = 0;
+}
+
+/*
+ * Process all pending notifications from the RX path. Only called with
+ * deferral stopped, so nothing new is queued meanwhile.
+ */
+static void iwl_mvm_tx_compl_drain(struct iwl_mvm *mvm)
+{
+	struct iwl_mvm_tx_compl *tc = &mvm->tx_compl;
+	LIST_HEAD(batch);
+
+	/*
+	 * A batch the NAPI already took precedes what is still pending, let
+	 * it finish first. It can't be running on this CPU, both run with
+	 * bottom halves disabled.
+	 */
+	spin_lock(&tc->lock);
+	while (tc->polling) {
+		spin_unlock(&tc->lock);
+		cpu_relax();
+		spin_lock(&tc->lock);
+	}
+	iwl_mvm_tx_compl_take_pending(tc, &batch);
+	spin_unlock(&tc->lock);
+
+	iwl_mvm_tx_compl_process(mvm, &batch);
+
+	spin_lock(&tc->lock);
+	tc->draining = false;
+	spin_unlock(&tc->lock);
+}
+
+bool iwl_mvm_tx_compl_queue(struct iwl_mvm *mvm, struct iwl_rx_cmd_buffer *rxb,
+			    void (*fn)(struct iwl_mvm *mvm,
+				       struct iwl_rx_cmd_buffer *rxb))
+{
+	struct iwl_mvm_tx_compl *tc = &mvm->tx_compl;
+	struct iwl_mvm_tx_compl_entry *entry;
+
+	if (!tc->enabled)
+		return false;
+
+	spin_lock(&tc->lock);
+	if (!tc->active || tc->draining) {
+		spin_unlock(&tc->lock);
+		return false;
+	}
+
+	entry = list_first_entry_or_null(&tc->free,
+					 struct iwl_mvm_tx_compl_entry, list);
+	if (entry) {
+		list_del(&entry->list);
+	} else {
+		tc->stats.pool_misses++;
+		entry = kzalloc(sizeof(*entry), GFP_ATOMIC);
+		if (!entry) {
+			/*
+			 * TX status must never be lost, but processing this
+			 * one inline right away could reorder it with the
+			 * pending ones: stop deferring, catch up with those
+			 * and then have the caller handle it inline.
+			 */
+			tc->stats.inline_fallbacks++;
+			tc->draining = true;
+			spin_unlock(&tc->lock);
+
+			iwl_mvm_tx_compl_drain(mvm);
+			return false;
+		}
+	}
+
+	entry->rxb._page = rxb_steal_page(rxb);
+	entry->rxb._offset = rxb->_offset;
+	entry->rxb._rx_page_order = rxb->_rx_page_order;
+	entry->fn = fn;
+	entry->ts = ktime_get_ns();
+	list_add_tail(&entry->list, &tc->pending);
+
+	tc->stats.pending++;
+	if (tc->stats.pending > tc->stats.max_pending)
+		tc->stats.max_pending = tc->stats.pending;
+	spin_unlock(&tc->lock);
+
+	napi_schedule(&tc->napi);
+
+	return true;
+}
+
+/* process, from process context, what was queued before the call */
+static void iwl_mvm_tx_compl_flush(struct iwl_mvm *mvm)
+{
+	struct iwl_mvm_tx_compl *tc = &mvm->tx_compl;
+	LIST_HEAD(batch);
+	bool resched;
+
+	/* waits for a batch the NAPI may be processing */
+	napi_disable(&tc->napi);
+
+	spin_lock_bh(&tc->lock);
+	iwl_mvm_tx_compl_take_pending(tc, &batch);
+	spin_unlock_bh(&tc->lock);
+
+	local_bh_disable();
+	iwl_mvm_tx_compl_process(mvm, &batch);
+	local_bh_enable();
+
+	napi_enable(&tc->napi);
+
+	/* scheduling was a no-op while disabled, pick up what came since */
+	spin_lock_bh(&tc->lock);
+	resched = !list_empty(&tc->pending);
+	spin_unlock_bh(&tc->lock);
+	if (resched) {
+		local_bh_disable();
+		napi_schedule(&tc->napi);
+		local_bh_enable();
+	}
+}
+
+/*
+ * Called before TX queues are flushed and reclaimed, or freed: older TX
+ * status notifications still pending for them must not be processed after
+ * that, or they would reclaim from a queue that is gone, or that already
+ * belongs to another station.
+ */
+void iwl_mvm_tx_compl_sync(struct iwl_mvm *mvm)
+{
+	if (!mvm->tx_compl.enabled)
+		return;
+
+	might_sleep();
+
+	iwl_mvm_tx_compl_flush(mvm);
+}
+
+/*
+ * Called before the transport stops and frees the TX queues: process what
+ * is pending and have new notifications handled inline until restarted.
+ */
+void iwl_mvm_tx_compl_stop(struct iwl_mvm *mvm)
+{
+	struct iwl_mvm_tx_compl *tc = &mvm->tx_compl;
+
+	if (!tc->enabled)
+		return;
+
+	spin_lock_bh(&tc->lock);
+	tc->active = false;
+	spin_unlock_bh(&tc->lock);
+
+	iwl_mvm_tx_compl_flush(mvm);
+}
+
+void iwl_mvm_tx_compl_start(struct iwl_mvm *mvm)
+{
+	struct iwl_mvm_tx_compl *tc = &mvm->tx_compl;
+
+	if (!tc->enabled)
+		return;
+
+	spin_lock_bh(&tc->lock);
+	tc->active = true;
+	spin_unlock_bh(&tc->lock);
+}
+
+void iwl_mvm_tx_compl_init(struct iwl_mvm *mvm)
+{
+	struct iwl_mvm_tx_compl *tc = &mvm->tx_compl;
+	int i;
+
+	if (!iwlmvm_mod_params.tx_compl_napi)
+		return;
+
+	spin_lock_init(&tc->lock);
+	INIT_LIST_HEAD(&tc->pending);
+	INIT_LIST_HEAD(&tc->free);
+	for (i = 0; i < ARRAY_SIZE(tc->pool); i++) {
+		tc->pool[i].pooled = true;
+		list_add_tail(&tc->pool[i].list, &tc->free);
+	}
+
+	init_dummy_netdev(&tc->napi_dev);
+	snprintf(tc->napi_dev.name, sizeof(tc->napi_dev.name), "%s-txc",
+		 dev_name(mvm->dev));
+	netif_napi_add(&tc->napi_dev, &tc->napi, iwl_mvm_tx_compl_poll,
+		       NAPI_POLL_WEIGHT);
+	napi_enable(&tc->napi);
+
+#if LINUX_VERSION_IS_GEQ(5,12,0)
+	/* follow the RX queues, so completions can move off the IRQ CPU */
+	if (iwlwifi_mod_params.napi_threaded &&
+	    dev_set_threaded(&tc->napi_dev, true))
+		IWL_WARN(mvm, "Failed to enable threaded TX completion NAPI\n");
+#endif
+
+	tc->enabled = true;
+	tc->active = true;
+}
+
+void iwl_mvm_tx_compl_free(struct iwl_mvm *mvm)
+{
+	struct iwl_mvm_tx_compl *tc = &mvm->tx_compl;
+	struct iwl_mvm_tx_compl_entry *entry, *tmp;
+
+	if (!tc->enabled)
+		return;
+
+	napi_disable(&tc->napi);
+	netif_napi_del(&tc->napi);
+	tc->enabled = false;
+
+	/* the device is stopped, nothing left to reclaim */
+	list_for_each_entry_safe(entry, tmp, &tc->pending, list) {
+		list_del(&entry->list);
+		iwl_free_rxb(&entry->rxb);
+		if (!entry->pooled)
+			kfree(entry);
+	}
+}
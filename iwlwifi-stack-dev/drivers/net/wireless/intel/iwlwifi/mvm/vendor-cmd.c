@@ -216,7 +216,7 @@ static int iwl_mvm_set_country(struct wiphy *wiphy,
 		goto unlock;
 	}
 
-	retval = regulatory_set_wiphy_regd(wiphy, regd);
+	retval = iwl_mvm_set_wiphy_regd(mvm, regd, false);
 	kfree(regd);
 unlock:
 	mutex_unlock(&mvm->mutex);
@@ -253,7 +253,7 @@ void iwl_pcie_ctxt_info_gen3_free(struct iwl_trans *trans, bool alive)
 		trans_pcie->iml = NULL;
 	}
 
-	iwl_pcie_ctxt_info_free_fw_img(trans);
+	iwl_pcie_ctxt_info_release_fw_img(trans);
 
 	if (alive)
 		return;
@@ -297,6 +297,9 @@ int iwl_trans_pcie_ctx_info_gen3_set_pnvm(struct iwl_trans *trans,
 		if (WARN_ON(prph_sc_ctrl->pnvm_cfg.pnvm_size))
 			return -EBUSY;
 
+		/* reloaded for a different SKU, drop the old copy */
+		iwl_pcie_ctxt_info_free_dram(trans, &trans_pcie->pnvm_dram);
+
 		ret = iwl_pcie_ctxt_info_alloc_dma(trans, data, len,
 						   &trans_pcie->pnvm_dram);
 		if (ret < 0) {
@@ -330,6 +333,9 @@ int iwl_trans_pcie_ctx_info_gen3_set_reduce_power(struct iwl_trans *trans,
 		if (WARN_ON(prph_sc_ctrl->reduce_power_cfg.size))
 			return -EBUSY;
 
+		iwl_pcie_ctxt_info_free_dram(trans,
+					     &trans_pcie->reduce_power_dram);
+
 		ret = iwl_pcie_ctxt_info_alloc_dma(trans, data, len,
 					   &trans_pcie->reduce_power_dram);
 		if (ret < 0) {
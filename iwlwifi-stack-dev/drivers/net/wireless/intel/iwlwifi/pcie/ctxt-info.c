@@ -60,6 +60,16 @@ int iwl_pcie_ctxt_info_alloc_dma(struct iwl_trans *trans,
 	return 0;
 }
 
+void iwl_pcie_ctxt_info_free_dram(struct iwl_trans *trans,
+				  struct iwl_dram_data *dram)
+{
+	if (!dram->size)
+		return;
+
+	dma_free_coherent(trans->dev, dram->size, dram->block, dram->physical);
+	memset(dram, 0, sizeof(*dram));
+}
+
 void iwl_pcie_ctxt_info_free_paging(struct iwl_trans *trans)
 {
 	struct iwl_self_init_dram *dram = &trans->init_dram;
@@ -81,6 +91,39 @@ void iwl_pcie_ctxt_info_free_paging(struct iwl_trans *trans)
 	dram->paging = NULL;
 }
 
+/*
+ * The image is still in DRAM from a previous load. LMAC/UMAC sections are
+ * only read by the device so the context info can just point to them
+ * again, but the paging memory is written by the firmware at runtime and
+ * has to be refreshed from the image.
+ */
+static void iwl_pcie_reuse_fw_sec(struct iwl_trans *trans,
+				  const struct fw_img *fw,
+				  struct iwl_context_info_dram *ctxt_dram)
+{
+	struct iwl_self_init_dram *dram = &trans->init_dram;
+	int i, lmac_cnt = iwl_pcie_get_num_sections(fw, 0);
+
+	for (i = 0; i < dram->fw_cnt; i++) {
+		__le64 addr = cpu_to_le64(dram->fw[i].physical);
+
+		if (i < lmac_cnt)
+			ctxt_dram->lmac_img[i] = addr;
+		else
+			ctxt_dram->umac_img[i - lmac_cnt] = addr;
+	}
+
+	for (i = 0; i < dram->paging_cnt; i++) {
+		/* access FW with +2 to make up for lmac & umac separators */
+		int fw_idx = dram->fw_cnt + i + 2;
+
+		memcpy(dram->paging[i].block, fw->sec[fw_idx].data,
+		       fw->sec[fw_idx].len);
+		ctxt_dram->virtual_img[i] =
+			cpu_to_le64(dram->paging[i].physical);
+	}
+}
+
 int iwl_pcie_init_fw_sec(struct iwl_trans *trans,
 			 const struct fw_img *fw,
 			 struct iwl_context_info_dram *ctxt_dram)
@@ -88,6 +131,17 @@ int iwl_pcie_init_fw_sec(struct iwl_trans *trans,
 	struct iwl_self_init_dram *dram = &trans->init_dram;
 	int i, ret, lmac_cnt, umac_cnt, paging_cnt;
 
+	if (dram->img) {
+		if (dram->img == fw) {
+			iwl_pcie_reuse_fw_sec(trans, fw, ctxt_dram);
+			return 0;
+		}
+
+		/* a different image is loaded now, drop the old one */
+		iwl_pcie_ctxt_info_free_fw_img(trans);
+		iwl_pcie_ctxt_info_free_paging(trans);
+	}
+
 	if (WARN(dram->paging,
 		 "paging shouldn't already be initialized (%d pages)\n",
 		 dram->paging_cnt))
@@ -157,6 +211,9 @@ int iwl_pcie_init_fw_sec(struct iwl_trans *trans,
 		dram->paging_cnt++;
 	}
 
+	if (iwlwifi_mod_params.fw_dram_persist)
+		dram->img = fw;
+
 	return 0;
 }
 
@@ -259,5 +316,5 @@ void iwl_pcie_ctxt_info_free(struct iwl_trans *trans)
 	trans_pcie->ctxt_info_dma_addr = 0;
 	trans_pcie->ctxt_info = NULL;
 
-	iwl_pcie_ctxt_info_free_fw_img(trans);
+	iwl_pcie_ctxt_info_release_fw_img(trans);
 }
@@ -138,6 +138,11 @@ struct iwl_rx_completion_desc_bz {
  * @queue: actual rx queue. Not used for multi-rx queue.
  * @next_rb_is_fragment: indicates that the previous RB that we handled set
  *	the fragmented flag, so the next one is still another fragment
+ * @moder_start: start of the current RX rate sample, in jiffies
+ * @moder_pkts: packets received in the current RX rate sample
+ * @moder_bytes: bytes received in the current RX rate sample
+ * @moder_level: interrupt moderation profile this queue's RX rate asks for
+ * @lat_cnt: RBs handled since the last latency sample
  *
  * NOTE:  rx_free and rx_used are used as a FIFO for iwl_rx_mem_buffers
  */
@@ -161,6 +166,11 @@ struct iwl_rxq {
 	spinlock_t lock;
 	struct napi_struct napi;
 	struct iwl_rx_mem_buffer *queue[RX_QUEUE_SIZE];
+	unsigned long moder_start;
+	u32 moder_pkts;
+	u32 moder_bytes;
+	u8 moder_level;
+	u32 lat_cnt;
 };
 
 /**
@@ -185,6 +195,18 @@ struct iwl_rb_allocator {
 	struct work_struct rx_alloc;
 };
 
+/**
+ * struct iwl_pcie_rx_moder - RX interrupt moderation
+ * @lock: protects the fields below and writes to CSR_INT_COALESCING
+ * @adaptive: derive the coalescing timeout from the RX rate of the queues
+ * @timeout: coalescing timeout in use, in 32 usec units
+ */
+struct iwl_pcie_rx_moder {
+	spinlock_t lock;
+	bool adaptive;
+	u8 timeout;
+};
+
 /**
  * iwl_get_closed_rb_stts - get closed rb stts from different structs
  * @rxq - the rxq to get the rb stts from
@@ -307,6 +329,8 @@ enum iwl_pcie_imr_status {
  * @scd_base_addr: scheduler sram base address in SRAM
  * @kw: keep warm address
  * @pnvm_dram: DRAM area that contains the PNVM data
+ * @fw_load_chunk: DMA bounce buffer kept for loading firmware sections on
+ *	devices without context info when fw_dram_persist is set
  * @pci_dev: basic pci-network driver stuff
  * @hw_base: pci hardware address support
  * @ucode_write_complete: indicates that the ucode has been copied.
@@ -344,6 +368,7 @@ enum iwl_pcie_imr_status {
  * @imr_status: imr dma state machine
  * @wait_queue_head_t: imr wait queue for dma completion
  * @rf_name: name/version of the CRF, if any
+ * @rx_moder: RX interrupt moderation state
  */
 struct iwl_trans_pcie {
 	struct iwl_rxq *rxq;
@@ -382,6 +407,7 @@ struct iwl_trans_pcie {
 
 	struct iwl_dram_data pnvm_dram;
 	struct iwl_dram_data reduce_power_dram;
+	struct iwl_dram_data fw_load_chunk;
 
 	struct iwl_txq *txq_memory;
 
@@ -440,6 +466,7 @@ struct iwl_trans_pcie {
 	enum iwl_pcie_imr_status imr_status;
 	wait_queue_head_t imr_waitq;
 	char rf_name[32];
+	struct iwl_pcie_rx_moder rx_moder;
 };
 
 static inline struct iwl_trans_pcie *
@@ -496,6 +523,10 @@ int iwl_pcie_rx_stop(struct iwl_trans *trans);
 void iwl_pcie_rx_free(struct iwl_trans *trans);
 void iwl_pcie_free_rbs_pool(struct iwl_trans *trans);
 void iwl_pcie_rx_init_rxb_lists(struct iwl_rxq *rxq);
+int iwl_trans_pcie_set_coalesce(struct iwl_trans *trans, u32 rx_usecs,
+				bool adaptive);
+void iwl_trans_pcie_get_coalesce(struct iwl_trans *trans, u32 *rx_usecs,
+				 bool *adaptive);
 void iwl_pcie_rx_napi_sync(struct iwl_trans *trans);
 void iwl_pcie_rxq_alloc_rbs(struct iwl_trans *trans, gfp_t priority,
 			    struct iwl_rxq *rxq);
@@ -594,6 +625,21 @@ static inline void iwl_pcie_ctxt_info_free_fw_img(struct iwl_trans *trans)
 	kfree(dram->fw);
 	dram->fw_cnt = 0;
 	dram->fw = NULL;
+	dram->img = NULL;
+}
+
+/*
+ * Called once the firmware image is no longer needed by the device, i.e.
+ * on alive or when the load failed. With fw_dram_persist the image is
+ * kept until the next load of a different image or until the transport
+ * is freed.
+ */
+static inline void iwl_pcie_ctxt_info_release_fw_img(struct iwl_trans *trans)
+{
+	if (trans->init_dram.img)
+		return;
+
+	iwl_pcie_ctxt_info_free_fw_img(trans);
 }
 
 static inline void iwl_disable_interrupts(struct iwl_trans *trans)
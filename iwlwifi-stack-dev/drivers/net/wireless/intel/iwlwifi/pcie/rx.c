@@ -12,6 +12,7 @@
 #include "iwl-io.h"
 #include "internal.h"
 #include "iwl-op-mode.h"
+#include "iwl-modparams.h"
 #include "iwl-context-info-gen3.h"
 
 /******************************************************************************
@@ -826,6 +827,141 @@ err:
 	return ret;
 }
 
+/*
+ * RX interrupt moderation profiles, from lowest to highest RX rate. Each RX
+ * queue samples its packet and byte rate and picks the first profile whose
+ * limits it doesn't exceed. CSR_INT_COALESCING is shared by all queues, so
+ * the busiest one decides the timeout that is actually programmed.
+ */
+static const struct iwl_pcie_rx_moder_profile {
+	u32 pkts_per_sec;
+	u32 bytes_per_sec;
+	u8 timeout; /* 32 usec units */
+} iwl_pcie_rx_moder_profiles[] = {
+	{ 2000, 2000000, 0 },
+	{ 10000, 10000000, 2 },
+	{ 40000, 50000000, 8 },
+	{ 100000, 150000000, 0x10 },
+	{ U32_MAX, U32_MAX, IWL_HOST_INT_TIMEOUT_DEF },
+};
+
+#define IWL_PCIE_RX_MODER_DEF_LEVEL	(ARRAY_SIZE(iwl_pcie_rx_moder_profiles) - 1)
+#define IWL_PCIE_RX_MODER_INTERVAL	(HZ / 10)
+
+static void iwl_pcie_rx_moder_init(struct iwl_trans *trans)
+{
+	struct iwl_trans_pcie *trans_pcie = IWL_TRANS_GET_PCIE_TRANS(trans);
+	struct iwl_pcie_rx_moder *moder = &trans_pcie->rx_moder;
+
+	spin_lock_bh(&moder->lock);
+	/* the 7260/3160 W/A below relies on the default timeout */
+	if (trans->cfg->host_interrupt_operation_mode)
+		moder->adaptive = false;
+	if (moder->adaptive)
+		moder->timeout = IWL_HOST_INT_TIMEOUT_DEF;
+	iwl_write8(trans, CSR_INT_COALESCING, moder->timeout);
+	spin_unlock_bh(&moder->lock);
+}
+
+static void iwl_pcie_rx_moder_update(struct iwl_trans *trans,
+				     struct iwl_rxq *rxq)
+{
+	struct iwl_trans_pcie *trans_pcie = IWL_TRANS_GET_PCIE_TRANS(trans);
+	struct iwl_pcie_rx_moder *moder = &trans_pcie->rx_moder;
+	unsigned long now = jiffies;
+	unsigned long elapsed = now - rxq->moder_start;
+	u64 pkts_per_sec, bytes_per_sec;
+	u8 level = 0, timeout;
+	int i;
+
+	if (!READ_ONCE(moder->adaptive) ||
+	    elapsed < IWL_PCIE_RX_MODER_INTERVAL)
+		return;
+
+	pkts_per_sec = div_u64((u64)rxq->moder_pkts * HZ, elapsed);
+	bytes_per_sec = div_u64((u64)rxq->moder_bytes * HZ, elapsed);
+
+	while (level < IWL_PCIE_RX_MODER_DEF_LEVEL &&
+	       (pkts_per_sec > iwl_pcie_rx_moder_profiles[level].pkts_per_sec ||
+		bytes_per_sec > iwl_pcie_rx_moder_profiles[level].bytes_per_sec))
+		level++;
+
+	/*
+	 * Move by one profile per sample to not flap on bursty traffic, but
+	 * follow right away after the queue was idle for a while.
+	 */
+	if (elapsed < 2 * IWL_PCIE_RX_MODER_INTERVAL) {
+		if (level > rxq->moder_level)
+			level = rxq->moder_level + 1;
+		else if (level < rxq->moder_level)
+			level = rxq->moder_level - 1;
+	}
+
+	rxq->moder_start = now;
+	rxq->moder_pkts = 0;
+	rxq->moder_bytes = 0;
+	WRITE_ONCE(rxq->moder_level, level);
+
+	for (i = 0; i < trans->num_rx_queues; i++) {
+		struct iwl_rxq *q = &trans_pcie->rxq[i];
+
+		/* a queue that hasn't sampled recently is idle */
+		if (time_after(now, READ_ONCE(q->moder_start) +
+				    2 * IWL_PCIE_RX_MODER_INTERVAL))
+			continue;
+
+		level = max(level, READ_ONCE(q->moder_level));
+	}
+
+	timeout = iwl_pcie_rx_moder_profiles[level].timeout;
+
+	spin_lock(&moder->lock);
+	if (moder->adaptive && moder->timeout != timeout) {
+		IWL_DEBUG_TPT(trans, "RX interrupt coalescing %d -> %d usec\n",
+			      moder->timeout * 32, timeout * 32);
+		moder->timeout = timeout;
+		iwl_write8(trans, CSR_INT_COALESCING, timeout);
+	}
+	spin_unlock(&moder->lock);
+}
+
+int iwl_trans_pcie_set_coalesce(struct iwl_trans *trans, u32 rx_usecs,
+				bool adaptive)
+{
+	struct iwl_trans_pcie *trans_pcie = IWL_TRANS_GET_PCIE_TRANS(trans);
+	struct iwl_pcie_rx_moder *moder = &trans_pcie->rx_moder;
+	u32 timeout = DIV_ROUND_UP(rx_usecs, 32);
+
+	/* the 7260/3160 W/A needs the timeout as it is set up on init */
+	if (trans->cfg->host_interrupt_operation_mode)
+		return -EOPNOTSUPP;
+
+	if (!adaptive && timeout > IWL_HOST_INT_TIMEOUT_MAX)
+		return -EINVAL;
+
+	spin_lock_bh(&moder->lock);
+	if (!adaptive || !moder->adaptive) {
+		moder->timeout = adaptive ? IWL_HOST_INT_TIMEOUT_DEF : timeout;
+		iwl_write8(trans, CSR_INT_COALESCING, moder->timeout);
+	}
+	moder->adaptive = adaptive;
+	spin_unlock_bh(&moder->lock);
+
+	return 0;
+}
+
+void iwl_trans_pcie_get_coalesce(struct iwl_trans *trans, u32 *rx_usecs,
+				 bool *adaptive)
+{
+	struct iwl_trans_pcie *trans_pcie = IWL_TRANS_GET_PCIE_TRANS(trans);
+	struct iwl_pcie_rx_moder *moder = &trans_pcie->rx_moder;
+
+	spin_lock_bh(&moder->lock);
+	*rx_usecs = moder->timeout * 32;
+	*adaptive = moder->adaptive;
+	spin_unlock_bh(&moder->lock);
+}
+
 static void iwl_pcie_rx_hw_init(struct iwl_trans *trans, struct iwl_rxq *rxq)
 {
 	struct iwl_trans_pcie *trans_pcie = IWL_TRANS_GET_PCIE_TRANS(trans);
@@ -886,8 +1022,8 @@ static void iwl_pcie_rx_hw_init(struct iwl_trans *trans, struct iwl_rxq *rxq)
 
 	iwl_trans_release_nic_access(trans);
 
-	/* Set interrupt coalescing timer to default (2048 usecs) */
-	iwl_write8(trans, CSR_INT_COALESCING, IWL_HOST_INT_TIMEOUT_DEF);
+	/* Set interrupt coalescing timer, 2048 usecs unless configured */
+	iwl_pcie_rx_moder_init(trans);
 
 	/* W/A for interrupt coalescing bug in 7260 and 3160 */
 	if (trans->cfg->host_interrupt_operation_mode)
@@ -978,8 +1114,8 @@ static void iwl_pcie_rx_mq_hw_init(struct iwl_trans *trans)
 
 	iwl_trans_release_nic_access(trans);
 
-	/* Set interrupt coalescing timer to default (2048 usecs) */
-	iwl_write8(trans, CSR_INT_COALESCING, IWL_HOST_INT_TIMEOUT_DEF);
+	/* Set interrupt coalescing timer, 2048 usecs unless configured */
+	iwl_pcie_rx_moder_init(trans);
 }
 
 void iwl_pcie_rx_init_rxb_lists(struct iwl_rxq *rxq)
@@ -1009,13 +1145,15 @@ static int iwl_pcie_napi_poll(struct napi_struct *napi, int budget)
 	IWL_DEBUG_ISR(trans, "[%d] handled %d, budget %d\n",
 		      rxq->id, ret, budget);
 
-	if (ret < budget) {
+	/*
+	 * Only re-enable the interrupt if NAPI is really done, a busy
+	 * polling socket may still own it and will poll again.
+	 */
+	if (ret < budget && napi_complete_done(&rxq->napi, ret)) {
 		spin_lock(&trans_pcie->irq_lock);
 		if (test_bit(STATUS_INT_ENABLED, &trans->status))
 			_iwl_enable_interrupts(trans);
 		spin_unlock(&trans_pcie->irq_lock);
-
-		napi_complete_done(&rxq->napi, ret);
 	}
 
 	return ret;
@@ -1035,7 +1173,7 @@ static int iwl_pcie_napi_poll_msix(struct napi_struct *napi, int budget)
 	IWL_DEBUG_ISR(trans, "[%d] handled %d, budget %d\n", rxq->id, ret,
 		      budget);
 
-	if (ret < budget) {
+	if (ret < budget && napi_complete_done(&rxq->napi, ret)) {
 		int irq_line = rxq->id;
 
 		/* FIRST_RSS is shared with line 0 */
@@ -1046,8 +1184,6 @@ static int iwl_pcie_napi_poll_msix(struct napi_struct *napi, int budget)
 		spin_lock(&trans_pcie->irq_lock);
 		iwl_pcie_clear_irq(trans, irq_line);
 		spin_unlock(&trans_pcie->irq_lock);
-
-		napi_complete_done(&rxq->napi, ret);
 	}
 
 	return ret;
@@ -1066,6 +1202,54 @@ void iwl_pcie_rx_napi_sync(struct iwl_trans *trans)
 	}
 }
 
+/*
+ * Move RX processing out of softirq context into per-queue NAPI kthreads,
+ * so it can be given its own CPUs and scheduling policy rather than
+ * competing with applications on the interrupt CPU.
+ */
+static void iwl_pcie_rx_napi_set_threaded(struct iwl_trans *trans)
+{
+#if LINUX_VERSION_IS_GEQ(5,12,0)
+	struct iwl_trans_pcie *trans_pcie = IWL_TRANS_GET_PCIE_TRANS(trans);
+	cpumask_var_t cpus;
+	int i, ret;
+
+	if (!iwlwifi_mod_params.napi_threaded || trans_pcie->napi_dev.threaded)
+		return;
+
+	ret = dev_set_threaded(&trans_pcie->napi_dev, true);
+	if (ret) {
+		IWL_WARN(trans, "Failed to enable threaded NAPI: %d\n", ret);
+		return;
+	}
+
+	if (!zalloc_cpumask_var(&cpus, GFP_KERNEL))
+		return;
+
+	if (iwlwifi_mod_params.napi_cpus &&
+	    (cpulist_parse(iwlwifi_mod_params.napi_cpus, cpus) ||
+	     !cpumask_intersects(cpus, cpu_online_mask))) {
+		IWL_WARN(trans, "Invalid napi_cpus '%s', ignoring\n",
+			 iwlwifi_mod_params.napi_cpus);
+		cpumask_clear(cpus);
+	}
+
+	for (i = 0; i < trans->num_rx_queues; i++) {
+		struct task_struct *thread = trans_pcie->rxq[i].napi.thread;
+
+		if (!thread)
+			continue;
+
+		if (iwlwifi_mod_params.napi_rt)
+			sched_set_fifo_low(thread);
+		if (!cpumask_empty(cpus))
+			set_cpus_allowed_ptr(thread, cpus);
+	}
+
+	free_cpumask_var(cpus);
+#endif
+}
+
 static int _iwl_pcie_rx_init(struct iwl_trans *trans)
 {
 	struct iwl_trans_pcie *trans_pcie = IWL_TRANS_GET_PCIE_TRANS(trans);
@@ -1112,6 +1296,11 @@ static int _iwl_pcie_rx_init(struct iwl_trans *trans)
 			IWL_DEVICE_FAMILY_AX210) ?
 		       sizeof(__le16) : sizeof(struct iwl_rb_status));
 
+		rxq->moder_start = jiffies;
+		rxq->moder_pkts = 0;
+		rxq->moder_bytes = 0;
+		rxq->moder_level = IWL_PCIE_RX_MODER_DEF_LEVEL;
+
 		iwl_pcie_rx_init_rxb_lists(rxq);
 		spin_unlock_bh(&rxq->lock);
 
@@ -1127,6 +1316,8 @@ static int _iwl_pcie_rx_init(struct iwl_trans *trans)
 		}
 	}
 
+	iwl_pcie_rx_napi_set_threaded(trans);
+
 	/* move the pool to the default queue and allocator ownerships */
 	queue_size = trans->trans_cfg->mq_rx_supported ?
 			trans_pcie->num_rx_bufs - 1 : RX_QUEUE_SIZE;
@@ -1175,8 +1366,8 @@ int iwl_pcie_rx_init(struct iwl_trans *trans)
 
 int iwl_pcie_gen2_rx_init(struct iwl_trans *trans)
 {
-	/* Set interrupt coalescing timer to default (2048 usecs) */
-	iwl_write8(trans, CSR_INT_COALESCING, IWL_HOST_INT_TIMEOUT_DEF);
+	/* Set interrupt coalescing timer, 2048 usecs unless configured */
+	iwl_pcie_rx_moder_init(trans);
 
 	/*
 	 * We don't configure the RFH.
@@ -1290,11 +1481,18 @@ static void iwl_pcie_rx_handle_rb(struct iwl_trans *trans,
 	struct iwl_txq *txq = trans->txqs.txq[trans->txqs.cmd.q_id];
 	bool page_stolen = false;
 	int max_len = trans_pcie->rx_buf_bytes;
+	u32 lat_sample = READ_ONCE(trans->rx_lat_sample);
+	u64 rb_done_ns = 0;
 	u32 offset = 0;
 
 	if (WARN_ON(!rxb))
 		return;
 
+	if (unlikely(lat_sample) && ++rxq->lat_cnt >= lat_sample) {
+		rxq->lat_cnt = 0;
+		rb_done_ns = ktime_get_ns();
+	}
+
 	dma_unmap_page(trans->dev, rxb->page_dma, max_len, DMA_FROM_DEVICE);
 
 	while (offset + sizeof(u32) + sizeof(struct iwl_cmd_header) < max_len) {
@@ -1307,6 +1505,7 @@ static void iwl_pcie_rx_handle_rb(struct iwl_trans *trans,
 			._page = rxb->page,
 			._page_stolen = false,
 			.truesize = max_len,
+			.rb_done_ns = rb_done_ns,
 		};
 
 		pkt = rxb_addr(&rxcb);
@@ -1345,6 +1544,9 @@ static void iwl_pcie_rx_handle_rb(struct iwl_trans *trans,
 		trace_iwlwifi_dev_rx(trans->dev, trans, pkt, len);
 		trace_iwlwifi_dev_rx_data(trans->dev, trans, pkt, len);
 
+		rxq->moder_pkts++;
+		rxq->moder_bytes += len;
+
 		/* Reclaim a command buffer only if this packet is a response
 		 *   to a (driver-originated) command.
 		 * If the packet (e.g. Rx frame) originated from uCode,
@@ -1611,6 +1813,8 @@ out:
 
 	iwl_pcie_rxq_restock(trans, rxq);
 
+	iwl_pcie_rx_moder_update(trans, rxq);
+
 	return handled;
 }
 
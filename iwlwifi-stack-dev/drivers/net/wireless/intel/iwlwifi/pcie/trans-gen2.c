@@ -161,7 +161,9 @@ void _iwl_trans_pcie_gen2_stop_device(struct iwl_trans *trans)
 		iwl_pcie_rx_stop(trans);
 	}
 
-	iwl_pcie_ctxt_info_free_paging(trans);
+	/* a persistent image is refreshed from the fw image on the next load */
+	if (!trans->init_dram.img)
+		iwl_pcie_ctxt_info_free_paging(trans);
 	if (trans->trans_cfg->device_family >= IWL_DEVICE_FAMILY_AX210)
 		iwl_pcie_ctxt_info_gen3_free(trans, false);
 	else
@@ -716,6 +716,8 @@ static int iwl_pcie_load_firmware_chunk(struct iwl_trans *trans,
 static int iwl_pcie_load_section(struct iwl_trans *trans, u8 section_num,
 			    const struct fw_desc *section)
 {
+	struct iwl_trans_pcie *trans_pcie = IWL_TRANS_GET_PCIE_TRANS(trans);
+	struct iwl_dram_data *persist = &trans_pcie->fw_load_chunk;
 	u8 *v_addr;
 	dma_addr_t p_addr;
 	u32 offset, chunk_sz = min_t(u32, FH_MEM_TB_MAX_LENGTH, section->len);
@@ -724,6 +726,21 @@ static int iwl_pcie_load_section(struct iwl_trans *trans, u8 section_num,
 	IWL_DEBUG_FW(trans, "[%d] uCode section being loaded...\n",
 		     section_num);
 
+	if (iwlwifi_mod_params.fw_dram_persist && !persist->block) {
+		persist->block = dma_alloc_coherent(trans->dev,
+						    FH_MEM_TB_MAX_LENGTH,
+						    &persist->physical,
+						    GFP_KERNEL | __GFP_NOWARN);
+		if (persist->block)
+			persist->size = FH_MEM_TB_MAX_LENGTH;
+	}
+
+	if (persist->block) {
+		v_addr = persist->block;
+		p_addr = persist->physical;
+		goto load;
+	}
+
 	v_addr = dma_alloc_coherent(trans->dev, chunk_sz, &p_addr,
 				    GFP_KERNEL | __GFP_NOWARN);
 	if (!v_addr) {
@@ -735,6 +752,7 @@ static int iwl_pcie_load_section(struct iwl_trans *trans, u8 section_num,
 			return -ENOMEM;
 	}
 
+load:
 	for (offset = 0; offset < section->len; offset += chunk_sz) {
 		u32 copy_size, dst_addr;
 		bool extended_addr = false;
@@ -766,7 +784,8 @@ static int iwl_pcie_load_section(struct iwl_trans *trans, u8 section_num,
 		}
 	}
 
-	dma_free_coherent(trans->dev, chunk_sz, v_addr, p_addr);
+	if (v_addr != persist->block)
+		dma_free_coherent(trans->dev, chunk_sz, v_addr, p_addr);
 	return ret;
 }
 
@@ -1772,10 +1791,12 @@ static void iwl_pcie_irq_set_affinity(struct iwl_trans *trans)
 	offset = 1 + i;
 	for (; i < iter_rx_q ; i++) {
 		/*
-		 * Get the cpu prior to the place to search
-		 * (i.e. return will be > i - 1).
+		 * Spread the RSS queues over the CPUs closest to the device,
+		 * rather than simply the first online ones.
 		 */
-		cpu = cpumask_next(i - offset, cpu_online_mask);
+		cpu = cpumask_local_spread(i - offset + 1,
+					   dev_to_node(trans->dev));
+		cpumask_clear(&trans_pcie->affinity_mask[i]);
 		cpumask_set_cpu(cpu, &trans_pcie->affinity_mask[i]);
 		ret = irq_set_affinity_hint(trans_pcie->msix_entries[i].vector,
 					    &trans_pcie->affinity_mask[i]);
@@ -2038,8 +2059,12 @@ static void iwl_trans_pcie_configure(struct iwl_trans *trans,
 	 * As this function may be called again in some corner cases don't
 	 * do anything if NAPI was already initialized.
 	 */
-	if (trans_pcie->napi_dev.reg_state != NETREG_DUMMY)
+	if (trans_pcie->napi_dev.reg_state != NETREG_DUMMY) {
 		init_dummy_netdev(&trans_pcie->napi_dev);
+		/* names the threaded NAPI kthreads */
+		strscpy(trans_pcie->napi_dev.name, dev_name(trans->dev),
+			sizeof(trans_pcie->napi_dev.name));
+	}
 
 	trans_pcie->fw_reset_handshake = trans_cfg->fw_reset_handshake;
 }
@@ -2087,6 +2112,15 @@ void iwl_trans_pcie_free(struct iwl_trans *trans)
 				  trans_pcie->reduce_power_dram.block,
 				  trans_pcie->reduce_power_dram.physical);
 
+	if (trans_pcie->fw_load_chunk.size)
+		dma_free_coherent(trans->dev, trans_pcie->fw_load_chunk.size,
+				  trans_pcie->fw_load_chunk.block,
+				  trans_pcie->fw_load_chunk.physical);
+
+	/* the image may have been kept in DRAM across firmware restarts */
+	iwl_pcie_ctxt_info_free_fw_img(trans);
+	iwl_pcie_ctxt_info_free_paging(trans);
+
 	mutex_destroy(&trans_pcie->mutex);
 	iwl_trans_free(trans);
 }
@@ -2677,13 +2711,19 @@ static int iwl_dbgfs_tx_queue_seq_show(struct seq_file *seq, void *v)
 		   (unsigned int)state->pos,
 		   !!test_bit(state->pos, trans->txqs.queue_used),
 		   !!test_bit(state->pos, trans->txqs.queue_stopped));
-	if (txq)
+	if (txq) {
 		seq_printf(seq,
 			   "read=%u write=%u need_update=%d frozen=%d n_window=%d ampdu=%d",
 			   txq->read_ptr, txq->write_ptr,
 			   txq->need_update, txq->frozen,
 			   txq->n_window, txq->ampdu);
-	else
+		if (txq->bql)
+			seq_printf(seq,
+				   " bql_limit=%u bql_inflight=%u bql_max=%u",
+				   txq->dql.limit,
+				   txq->dql.num_queued - txq->dql.num_completed,
+				   txq->dql.max_limit);
+	} else
 		seq_puts(seq, "(unallocated)");
 
 	if (state->pos == trans->txqs.cmd.q_id)
@@ -2724,7 +2764,7 @@ static ssize_t iwl_dbgfs_rx_queue_read(struct file *file,
 	int pos = 0, i, ret;
 	size_t bufsz;
 
-	bufsz = sizeof(char) * 121 * trans->num_rx_queues;
+	bufsz = sizeof(char) * 141 * trans->num_rx_queues;
 
 	if (!trans_pcie->rxq)
 		return -EAGAIN;
@@ -2748,6 +2788,11 @@ static ssize_t iwl_dbgfs_rx_queue_read(struct file *file,
 				 rxq->need_update);
 		pos += scnprintf(buf + pos, bufsz - pos, "\tfree_count: %u\n",
 				 rxq->free_count);
+#ifdef CONFIG_NET_RX_BUSY_POLL
+		/* for matching SO_INCOMING_NAPI_ID of busy polling sockets */
+		pos += scnprintf(buf + pos, bufsz - pos, "\tnapi_id: %u\n",
+				 rxq->napi.napi_id);
+#endif
 		if (rxq->rb_stts) {
 			u32 r =	__le16_to_cpu(iwl_get_closed_rb_stts(trans,
 								     rxq));
@@ -3660,7 +3705,9 @@ static int iwl_trans_pci_request_firmware(struct iwl_trans *trans,
 	.d3_resume = iwl_trans_pcie_d3_resume,				\
 	.interrupts = iwl_trans_pci_interrupts,				\
 	.sync_nmi = iwl_trans_pcie_sync_nmi,				\
-	.imr_dma_data = iwl_trans_pcie_copy_imr				\
+	.imr_dma_data = iwl_trans_pcie_copy_imr,			\
+	.set_coalesce = iwl_trans_pcie_set_coalesce,			\
+	.get_coalesce = iwl_trans_pcie_get_coalesce			\
 
 static const struct iwl_trans_ops trans_ops_pcie = {
 	IWL_TRANS_COMMON_OPS,
@@ -3742,6 +3789,9 @@ struct iwl_trans *iwl_trans_pcie_alloc(struct pci_dev *pdev,
 	spin_lock_init(&trans_pcie->irq_lock);
 	spin_lock_init(&trans_pcie->reg_lock);
 	spin_lock_init(&trans_pcie->alloc_page_lock);
+	spin_lock_init(&trans_pcie->rx_moder.lock);
+	trans_pcie->rx_moder.adaptive = true;
+	trans_pcie->rx_moder.timeout = IWL_HOST_INT_TIMEOUT_DEF;
 	mutex_init(&trans_pcie->mutex);
 	init_waitqueue_head(&trans_pcie->ucode_write_waitq);
 	init_waitqueue_head(&trans_pcie->fw_reset_waitq);
@@ -13,6 +13,7 @@
 #include "queue/tx.h"
 #include "iwl-fh.h"
 #include "iwl-scd.h"
+#include "iwl-modparams.h"
 #include <linux/dmapool.h>
 
 /*
@@ -787,6 +788,7 @@ int iwl_txq_gen2_tx(struct iwl_trans *trans, struct sk_buff *skb,
 	/* Tell device the write index *just past* this latest filled TFD */
 	txq->write_ptr = iwl_txq_inc_wrap(trans, txq->write_ptr);
 	iwl_txq_inc_wr_ptr(trans, txq);
+	iwl_txq_bql_queued(trans, txq, skb->len);
 	/*
 	 * At this point the frame is "transmitted" successfully
 	 * and we will get a TX status notification eventually.
@@ -826,6 +828,9 @@ void iwl_txq_gen2_unmap(struct iwl_trans *trans, int txq_id)
 		iwl_op_mode_free_skb(trans->op_mode, skb);
 	}
 
+	if (txq->bql)
+		dql_reset(&txq->dql);
+
 	spin_unlock_bh(&txq->lock);
 
 	/* just in case - this queue may have been stopped */
@@ -950,6 +955,10 @@ int iwl_txq_init(struct iwl_trans *trans, struct iwl_txq *txq, int slots_num,
 
 	__skb_queue_head_init(&txq->overflow_q);
 
+	txq->bql = !cmd_queue && iwlwifi_mod_params.txq_bql;
+	if (txq->bql)
+		dql_init(&txq->dql, HZ);
+
 	return 0;
 }
 
@@ -1560,6 +1569,7 @@ void iwl_txq_reclaim(struct iwl_trans *trans, int txq_id, int ssn,
 {
 	struct iwl_txq *txq = trans->txqs.txq[txq_id];
 	int tfd_num, read_ptr, last_to_free;
+	unsigned int bytes = 0;
 
 	/* This function is not meant to release cmd queue*/
 	if (WARN_ON(txq_id == trans->txqs.cmd.q_id))
@@ -1616,6 +1626,7 @@ void iwl_txq_reclaim(struct iwl_trans *trans, int txq_id, int ssn,
 
 		iwl_txq_free_tso_page(trans, skb);
 
+		bytes += skb->len;
 		__skb_queue_tail(skbs, skb);
 
 		txq->entries[read_ptr].skb = NULL;
@@ -1628,7 +1639,10 @@ void iwl_txq_reclaim(struct iwl_trans *trans, int txq_id, int ssn,
 
 	iwl_txq_progress(txq);
 
-	if (iwl_txq_space(trans, txq) > txq->low_mark &&
+	if (txq->bql)
+		dql_completed(&txq->dql, bytes);
+
+	if (iwl_txq_can_wake(trans, txq) &&
 	    test_bit(txq_id, trans->txqs.queue_stopped)) {
 		struct sk_buff_head overflow_skbs;
 
@@ -1668,7 +1682,7 @@ void iwl_txq_reclaim(struct iwl_trans *trans, int txq_id, int ssn,
 			iwl_trans_tx(trans, skb, dev_cmd_ptr, txq_id);
 		}
 
-		if (iwl_txq_space(trans, txq) > txq->low_mark)
+		if (iwl_txq_can_wake(trans, txq))
 			iwl_wake_queue(trans, txq);
 
 		spin_lock_bh(&txq->lock);
@@ -69,6 +69,31 @@ static inline void iwl_txq_stop(struct iwl_trans *trans, struct iwl_txq *txq)
 	}
 }
 
+/*
+ * Account a frame that was put on the ring, and stop the queue once the
+ * byte limit is exceeded. The frame that crosses the limit is still sent,
+ * as with BQL. Must be called with the txq lock held.
+ */
+static inline void iwl_txq_bql_queued(struct iwl_trans *trans,
+				      struct iwl_txq *txq, unsigned int bytes)
+{
+	if (!txq->bql)
+		return;
+
+	dql_queued(&txq->dql, bytes);
+	if (dql_avail(&txq->dql) < 0)
+		iwl_txq_stop(trans, txq);
+}
+
+static inline bool iwl_txq_can_wake(struct iwl_trans *trans,
+				    const struct iwl_txq *txq)
+{
+	if (iwl_txq_space(trans, txq) <= txq->low_mark)
+		return false;
+
+	return !txq->bql || dql_avail(&txq->dql) >= 0;
+}
+
 /**
  * iwl_txq_inc_wrap - increment queue index, wrap back to beginning
  * @index -- current index
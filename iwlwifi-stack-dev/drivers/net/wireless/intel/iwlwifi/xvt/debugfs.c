@@ -5,6 +5,7 @@
  */
 #include "xvt.h"
 #include "fw/dbg.h"
+#include "iwl-tm-infc.h"
 
 #define XVT_DEBUGFS_WRITE_WRAPPER(name, buflen, argtype)		\
 static ssize_t _iwl_dbgfs_##name##_write(struct file *file,		\
@@ -109,6 +110,170 @@ XVT_DEBUGFS_WRITE_FILE_OPS(fw_restart, 10);
 XVT_DEBUGFS_WRITE_FILE_OPS(fw_nmi, 10);
 XVT_DEBUGFS_WRITE_FILE_OPS(set_profile, 10);
 
+#ifdef CONFIG_RELAY
+#define IWL_XVT_RX_RELAY_MIN_SUBBUF	(32 * 1024)
+
+/*
+ * Each sub-buffer starts with the amount of padding at its end, so
+ * that user space knows where the last record of the sub-buffer ends.
+ */
+static int iwl_xvt_rx_relay_subbuf_start(struct rchan_buf *buf, void *subbuf,
+					 void *prev_subbuf,
+					 size_t prev_padding)
+{
+	if (prev_subbuf)
+		*(u32 *)prev_subbuf = prev_padding;
+
+	if (relay_buf_full(buf))
+		return 0;
+
+	subbuf_start_reserve(buf, sizeof(u32));
+
+	return 1;
+}
+
+static struct dentry *
+iwl_xvt_rx_relay_create_buf_file(const char *filename, struct dentry *parent,
+				 umode_t mode, struct rchan_buf *buf,
+				 int *is_global)
+{
+	/* all the notifications are handled under notif_lock anyway */
+	*is_global = 1;
+
+	return debugfs_create_file(filename, mode, parent, buf,
+				   &relay_file_operations);
+}
+
+static int iwl_xvt_rx_relay_remove_buf_file(struct dentry *dentry)
+{
+	debugfs_remove(dentry);
+	return 0;
+}
+
+static struct rchan_callbacks iwl_xvt_rx_relay_cbs = {
+	.subbuf_start = iwl_xvt_rx_relay_subbuf_start,
+	.create_buf_file = iwl_xvt_rx_relay_create_buf_file,
+	.remove_buf_file = iwl_xvt_rx_relay_remove_buf_file,
+};
+
+/*
+ * Returns true if the notification was consumed by the relay, even if it
+ * had to be dropped because the relay was full.
+ */
+bool iwl_xvt_rx_relay_write(struct iwl_xvt *xvt, u32 cmd,
+			    const void *data, u32 len)
+{
+	struct iwl_xvt_rx_relay_hdr *hdr;
+
+	lockdep_assert_held(&xvt->notif_lock);
+
+	if (!xvt->rx_relay && !xvt->rx_relay_flushing)
+		return false;
+
+	/* while detached for a flush, count the notifications as dropped */
+	hdr = xvt->rx_relay ?
+	      relay_reserve(xvt->rx_relay, sizeof(*hdr) + ALIGN(len, 4)) :
+	      NULL;
+	if (!hdr) {
+		xvt->rx_relay_seq++;
+		xvt->rx_relay_dropped++;
+		return true;
+	}
+
+	hdr->cmd = cmd;
+	hdr->len = len;
+	hdr->seq = xvt->rx_relay_seq++;
+	hdr->dropped = xvt->rx_relay_dropped;
+	memcpy(hdr->data, data, len);
+	xvt->rx_relay_dropped = 0;
+
+	return true;
+}
+
+void iwl_xvt_rx_relay_close(struct iwl_xvt *xvt)
+{
+	struct rchan *chan;
+
+	spin_lock_bh(&xvt->notif_lock);
+	chan = xvt->rx_relay;
+	xvt->rx_relay = NULL;
+	spin_unlock_bh(&xvt->notif_lock);
+
+	if (chan)
+		relay_close(chan);
+}
+
+/*
+ * "open <subbuf_size> <n_subbufs>" - start writing RX notifications to the
+ *	relay, user space is woken up each time a sub-buffer is filled
+ * "flush" - hand the partially filled sub-buffer over to user space
+ * "close" - go back to sending the notifications over netlink
+ */
+static ssize_t iwl_dbgfs_rx_notif_relay_write(struct iwl_xvt *xvt, char *buf,
+					      size_t count, loff_t *ppos)
+{
+	unsigned int subbuf_size, n_subbufs;
+	struct rchan *chan;
+	int ret = count;
+
+	mutex_lock(&xvt->mutex);
+
+	if (sscanf(buf, "open %u %u", &subbuf_size, &n_subbufs) == 2) {
+		if (xvt->rx_relay) {
+			ret = -EBUSY;
+			goto out;
+		}
+
+		if (subbuf_size < IWL_XVT_RX_RELAY_MIN_SUBBUF || n_subbufs < 2) {
+			ret = -EINVAL;
+			goto out;
+		}
+
+		chan = relay_open("rx_notif", xvt->debugfs_dir, subbuf_size,
+				  n_subbufs, &iwl_xvt_rx_relay_cbs, NULL);
+		if (!chan) {
+			ret = -ENOMEM;
+			goto out;
+		}
+
+		spin_lock_bh(&xvt->notif_lock);
+		xvt->rx_relay_seq = 0;
+		xvt->rx_relay_dropped = 0;
+		xvt->rx_relay = chan;
+		spin_unlock_bh(&xvt->notif_lock);
+	} else if (!strncmp(buf, "flush", 5)) {
+		/*
+		 * relay_flush() switches sub-buffers and may sleep, detach the
+		 * channel so it can't race with relay_reserve() meanwhile
+		 */
+		spin_lock_bh(&xvt->notif_lock);
+		chan = xvt->rx_relay;
+		xvt->rx_relay = NULL;
+		xvt->rx_relay_flushing = !!chan;
+		spin_unlock_bh(&xvt->notif_lock);
+
+		if (chan) {
+			relay_flush(chan);
+
+			spin_lock_bh(&xvt->notif_lock);
+			xvt->rx_relay = chan;
+			xvt->rx_relay_flushing = false;
+			spin_unlock_bh(&xvt->notif_lock);
+		}
+	} else if (!strncmp(buf, "close", 5)) {
+		iwl_xvt_rx_relay_close(xvt);
+	} else {
+		ret = -EINVAL;
+	}
+
+out:
+	mutex_unlock(&xvt->mutex);
+	return ret;
+}
+
+XVT_DEBUGFS_WRITE_FILE_OPS(rx_notif_relay, 32);
+#endif /* CONFIG_RELAY */
+
 #ifdef CPTCFG_IWLWIFI_DEBUGFS
 int iwl_xvt_dbgfs_register(struct iwl_xvt *xvt, struct dentry *dbgfs_dir)
 {
@@ -118,6 +283,9 @@ int iwl_xvt_dbgfs_register(struct iwl_xvt *xvt, struct dentry *dbgfs_dir)
 	XVT_DEBUGFS_ADD_FILE(fw_restart, xvt->debugfs_dir, S_IWUSR);
 	XVT_DEBUGFS_ADD_FILE(fw_nmi, xvt->debugfs_dir, S_IWUSR);
 	XVT_DEBUGFS_ADD_FILE(set_profile, xvt->debugfs_dir, S_IWUSR);
+#ifdef CONFIG_RELAY
+	XVT_DEBUGFS_ADD_FILE(rx_notif_relay, xvt->debugfs_dir, S_IWUSR);
+#endif
 
 	return 0;
 err:
@@ -42,6 +42,20 @@
 #define XVT_LMAC_1_STA_ID (2) /* must be aligned with station id added in USC */
 #define XVT_STOP_TX (IEEE80211_SCTL_FRAG + 1)
 
+/*
+ * Once user space opened the RX relay, notifications are written there
+ * rather than sent one netlink message each, which can't keep up with
+ * high notification rates.
+ */
+static void iwl_xvt_user_send_rx_notif(struct iwl_xvt *xvt, u32 cmd,
+				       void *data, u32 size)
+{
+	if (iwl_xvt_rx_relay_write(xvt, cmd, data, size))
+		return;
+
+	iwl_xvt_user_send_notif(xvt, cmd, data, size, GFP_ATOMIC);
+}
+
 void iwl_xvt_send_user_rx_notif(struct iwl_xvt *xvt,
 				struct iwl_rx_cmd_buffer *rxb)
 {
@@ -55,87 +69,85 @@ void iwl_xvt_send_user_rx_notif(struct iwl_xvt *xvt,
 	switch (WIDE_ID(pkt->hdr.group_id, pkt->hdr.cmd)) {
 	case WIDE_ID(LONG_GROUP, GET_SET_PHY_DB_CMD):
 	case WIDE_ID(XVT_GROUP, GRP_XVT_GET_SET_PHY_DB_CMD):
+		/* part of the init flow, always goes over netlink */
 		iwl_xvt_user_send_notif(xvt, IWL_TM_USER_CMD_NOTIF_PHY_DB,
 					data, size, GFP_ATOMIC);
 		break;
 	case DTS_MEASUREMENT_NOTIFICATION:
 	case WIDE_ID(PHY_OPS_GROUP, DTS_MEASUREMENT_NOTIF_WIDE):
-		iwl_xvt_user_send_notif(xvt,
-					IWL_TM_USER_CMD_NOTIF_DTS_MEASUREMENTS,
-					data, size, GFP_ATOMIC);
+		iwl_xvt_user_send_rx_notif(xvt,
+					   IWL_TM_USER_CMD_NOTIF_DTS_MEASUREMENTS,
+					   data, size);
 		break;
 	case REPLY_RX_DSP_EXT_INFO:
 		if (!xvt->rx_hdr_enabled)
 			break;
 
-		iwl_xvt_user_send_notif(xvt, IWL_TM_USER_CMD_NOTIF_RX_HDR,
-					data, size, GFP_ATOMIC);
+		iwl_xvt_user_send_rx_notif(xvt, IWL_TM_USER_CMD_NOTIF_RX_HDR,
+					   data, size);
 		break;
 	case APMG_PD_SV_CMD:
 		if (!xvt->apmg_pd_en)
 			break;
 
-		iwl_xvt_user_send_notif(xvt, IWL_TM_USER_CMD_NOTIF_APMG_PD,
-					data, size, GFP_ATOMIC);
+		iwl_xvt_user_send_rx_notif(xvt, IWL_TM_USER_CMD_NOTIF_APMG_PD,
+					   data, size);
 		break;
 	case REPLY_RX_MPDU_CMD:
 		if (!xvt->send_rx_mpdu)
 			break;
 
-		iwl_xvt_user_send_notif(xvt, IWL_TM_USER_CMD_NOTIF_UCODE_RX_PKT,
-					data, size, GFP_ATOMIC);
+		iwl_xvt_user_send_rx_notif(xvt,
+					   IWL_TM_USER_CMD_NOTIF_UCODE_RX_PKT,
+					   data, size);
 		break;
 	case NVM_COMMIT_COMPLETE_NOTIFICATION:
-		iwl_xvt_user_send_notif(xvt,
-					IWL_TM_USER_CMD_NOTIF_COMMIT_STATISTICS,
-					data, size, GFP_ATOMIC);
+		iwl_xvt_user_send_rx_notif(xvt,
+					   IWL_TM_USER_CMD_NOTIF_COMMIT_STATISTICS,
+					   data, size);
 		break;
 	case REPLY_HD_PARAMS_CMD:
-		iwl_xvt_user_send_notif(xvt, IWL_TM_USER_CMD_NOTIF_BFE,
-					data, size, GFP_ATOMIC);
+		iwl_xvt_user_send_rx_notif(xvt, IWL_TM_USER_CMD_NOTIF_BFE,
+					   data, size);
 		break;
 	case DEBUG_LOG_MSG:
 		iwl_dnt_dispatch_collect_ucode_message(xvt->trans, rxb);
 		break;
 	case WIDE_ID(LOCATION_GROUP, TOF_MCSI_DEBUG_NOTIF):
-		iwl_xvt_user_send_notif(xvt,
-					IWL_TM_USER_CMD_NOTIF_LOC_MCSI,
-					data, size, GFP_ATOMIC);
+		iwl_xvt_user_send_rx_notif(xvt, IWL_TM_USER_CMD_NOTIF_LOC_MCSI,
+					   data, size);
 		break;
 	case WIDE_ID(LOCATION_GROUP, TOF_RANGE_RESPONSE_NOTIF):
-		iwl_xvt_user_send_notif(xvt,
-					IWL_TM_USER_CMD_NOTIF_LOC_RANGE,
-					data, size, GFP_ATOMIC);
+		iwl_xvt_user_send_rx_notif(xvt, IWL_TM_USER_CMD_NOTIF_LOC_RANGE,
+					   data, size);
 		break;
 	case WIDE_ID(XVT_GROUP, IQ_CALIB_CONFIG_NOTIF):
-		iwl_xvt_user_send_notif(xvt,
-					IWL_TM_USER_CMD_NOTIF_IQ_CALIB,
-					data, size, GFP_ATOMIC);
+		iwl_xvt_user_send_rx_notif(xvt, IWL_TM_USER_CMD_NOTIF_IQ_CALIB,
+					   data, size);
 		break;
 	case WIDE_ID(XVT_GROUP, DTS_MEASUREMENT_TRIGGER_NOTIF):
-		iwl_xvt_user_send_notif(xvt,
-					IWL_TM_USER_CMD_NOTIF_DTS_MEASUREMENTS_XVT,
-					data, size, GFP_ATOMIC);
+		iwl_xvt_user_send_rx_notif(xvt,
+					   IWL_TM_USER_CMD_NOTIF_DTS_MEASUREMENTS_XVT,
+					   data, size);
 		break;
 	case WIDE_ID(XVT_GROUP, MPAPD_EXEC_DONE_NOTIF):
-		iwl_xvt_user_send_notif(xvt,
-					IWL_TM_USER_CMD_NOTIF_MPAPD_EXEC_DONE,
-					data, size, GFP_ATOMIC);
+		iwl_xvt_user_send_rx_notif(xvt,
+					   IWL_TM_USER_CMD_NOTIF_MPAPD_EXEC_DONE,
+					   data, size);
 		break;
 	case WIDE_ID(XVT_GROUP, RUN_TIME_CALIB_DONE_NOTIF):
-		iwl_xvt_user_send_notif(xvt,
-					IWL_TM_USER_CMD_NOTIF_RUN_TIME_CALIB_DONE,
-					data, size, GFP_ATOMIC);
+		iwl_xvt_user_send_rx_notif(xvt,
+					   IWL_TM_USER_CMD_NOTIF_RUN_TIME_CALIB_DONE,
+					   data, size);
 		break;
 	case WIDE_ID(PHY_OPS_GROUP, CT_KILL_NOTIFICATION):
-		iwl_xvt_user_send_notif(xvt,
-					IWL_TM_USER_CMD_NOTIF_CT_KILL,
-					data, size, GFP_ATOMIC);
+		iwl_xvt_user_send_rx_notif(xvt, IWL_TM_USER_CMD_NOTIF_CT_KILL,
+					   data, size);
 		break;
 	case STATISTICS_NOTIFICATION:
-		iwl_xvt_user_send_notif(xvt,
-					IWL_TM_USER_CMD_NOTIF_STATISTICS,
-					data, size, GFP_ATOMIC);
+		iwl_xvt_user_send_rx_notif(xvt,
+					   IWL_TM_USER_CMD_NOTIF_STATISTICS,
+					   data, size);
 		break;
 	case REPLY_RX_PHY_CMD:
 		IWL_DEBUG_INFO(xvt,
@@ -146,8 +158,9 @@ void iwl_xvt_send_user_rx_notif(struct iwl_xvt *xvt,
 		break;
 	case TX_CMD:
 		if (xvt->send_tx_resp)
-			iwl_xvt_user_send_notif(xvt, IWL_XVT_CMD_TX_CMD_RESP,
-						data, size, GFP_ATOMIC);
+			iwl_xvt_user_send_rx_notif(xvt,
+						   IWL_XVT_CMD_TX_CMD_RESP,
+						   data, size);
 		break;
 	default:
 		IWL_DEBUG_INFO(xvt, "xVT mode RX command 0x%x not handled\n",
@@ -1128,6 +1141,24 @@ static struct sk_buff *iwl_xvt_get_skb(struct iwl_xvt *xvt,
 					   fragment_size, frag_num);
 }
 
+static struct iwl_device_tx_cmd *
+iwl_xvt_set_enhanced_tx_params(struct iwl_xvt *xvt, struct sk_buff *skb,
+			       struct iwl_xvt_tx_start *tx_start,
+			       u8 packet_index)
+{
+	u32 rate_flags = tx_start->tx_data.rate_flags;
+	u32 tx_flags = tx_start->tx_data.tx_flags;
+
+	if (!iwl_xvt_is_unified_fw(xvt))
+		return iwl_xvt_set_tx_params(xvt, skb, tx_start, packet_index);
+
+	if (xvt->trans->trans_cfg->device_family >= IWL_DEVICE_FAMILY_AX210)
+		return iwl_xvt_set_tx_params_gen3(xvt, skb, rate_flags,
+						  tx_flags);
+
+	return iwl_xvt_set_tx_params_gen2(xvt, skb, rate_flags, tx_flags);
+}
+
 static int iwl_xvt_transmit_packet(struct iwl_xvt *xvt,
 				   struct sk_buff *skb,
 				   struct iwl_xvt_tx_start *tx_start,
@@ -1139,27 +1170,13 @@ static int iwl_xvt_transmit_packet(struct iwl_xvt *xvt,
 	int time_remain, err = 0;
 	u8 queue = tx_start->frames_data[packet_index].queue;
 	struct tx_queue_data *queue_data = &xvt->queue_data[queue];
-	u32 rate_flags = tx_start->tx_data.rate_flags;
-	u32 tx_flags = tx_start->tx_data.tx_flags;
 
 	/* set tx number */
 	iwl_xvt_set_seq_number(xvt, &xvt->tx_meta_data[XVT_LMAC_0_ID], skb,
 			       frag_num);
 
-	if (iwl_xvt_is_unified_fw(xvt)) {
-		if (xvt->trans->trans_cfg->device_family >=
-		    IWL_DEVICE_FAMILY_AX210)
-			dev_cmd = iwl_xvt_set_tx_params_gen3(xvt, skb,
-							     rate_flags,
-							     tx_flags);
-		else
-			dev_cmd = iwl_xvt_set_tx_params_gen2(xvt, skb,
-							     rate_flags,
-							     tx_flags);
-	} else {
-		dev_cmd = iwl_xvt_set_tx_params(xvt, skb, tx_start,
-						packet_index);
-	}
+	dev_cmd = iwl_xvt_set_enhanced_tx_params(xvt, skb, tx_start,
+						 packet_index);
 	if (!dev_cmd) {
 		kfree_skb(skb);
 		*status = XVT_TX_DRIVER_ABORTED;
@@ -1553,6 +1570,386 @@ static int iwl_xvt_stop_tx(struct iwl_xvt *xvt)
 	return err;
 }
 
+/*
+ * The generator builds each frame once: the MAC header in the linear part,
+ * which is private to each copy since the sequence number is set in it,
+ * and the payload in a page that all the copies share.
+ */
+static struct sk_buff *iwl_xvt_tx_gen_template(struct iwl_xvt *xvt,
+					       struct ieee80211_hdr *hdr,
+					       struct tx_payload *payload)
+{
+	u32 header_size = ieee80211_hdrlen(hdr->frame_control);
+	struct sk_buff *skb;
+	struct page *page;
+	unsigned int order;
+
+	skb = alloc_skb(header_size, GFP_KERNEL);
+	if (!skb)
+		return NULL;
+
+	skb_put_data(skb, hdr, header_size);
+
+	if (!payload->length)
+		return skb;
+
+	order = get_order(payload->length);
+	page = alloc_pages(GFP_KERNEL | __GFP_COMP, order);
+	if (!page) {
+		kfree_skb(skb);
+		return NULL;
+	}
+
+	memcpy(page_address(page), payload->payload, payload->length);
+	skb_add_rx_frag(skb, 0, page, 0, payload->length, PAGE_SIZE << order);
+
+	return skb;
+}
+
+static void iwl_xvt_tx_gen_free(struct iwl_xvt_tx_gen_data *task_data)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(task_data->templates); i++)
+		kfree_skb(task_data->templates[i]);
+	kfree(task_data);
+}
+
+static int iwl_xvt_tx_gen_send_summary(struct iwl_xvt *xvt, u32 status,
+				       bool final, unsigned long start)
+{
+	struct iwl_xvt_tx_gen_summary *summary;
+	u32 i, j, size, num_of_queues = 0;
+	int err;
+
+	for (i = 0; i < IWL_MAX_HW_QUEUES; i++) {
+		if (xvt->queue_data[i].allocated_queue)
+			num_of_queues++;
+	}
+
+	size = struct_size(summary, queues, num_of_queues);
+	summary = kzalloc(size, GFP_KERNEL);
+	if (!summary)
+		return -ENOMEM;
+
+	summary->status = status;
+	summary->final = final;
+	summary->elapsed_ms = jiffies_to_msecs(jiffies - start);
+	summary->num_of_queues = num_of_queues;
+
+	for (i = 0, j = 0; i < IWL_MAX_HW_QUEUES && j < num_of_queues; i++) {
+		struct tx_queue_data *queue_data = &xvt->queue_data[i];
+		struct iwl_xvt_tx_gen_queue_stats *stats = &summary->queues[j];
+
+		if (!queue_data->allocated_queue)
+			continue;
+
+		stats->queue = i;
+		stats->queued = queue_data->gen_queued;
+		stats->completed = READ_ONCE(queue_data->tx_counter);
+		stats->failed = READ_ONCE(queue_data->tx_failed);
+		stats->ba_txed = READ_ONCE(queue_data->ba_txed);
+		stats->ba_acked = READ_ONCE(queue_data->ba_acked);
+		stats->credits = max(atomic_read(&queue_data->gen_credits), 0);
+		j++;
+	}
+
+	err = iwl_xvt_user_send_notif(xvt, IWL_XVT_CMD_TX_GEN_SUMMARY,
+				      summary, size, GFP_KERNEL);
+	kfree(summary);
+	return err;
+}
+
+static bool iwl_xvt_tx_gen_has_credits(struct iwl_xvt *xvt,
+				       struct iwl_xvt_tx_start *tx_start,
+				       const u16 *left)
+{
+	u16 i;
+
+	for (i = 0; i < tx_start->num_of_different_frames; i++) {
+		u8 queue = tx_start->frames_data[i].queue;
+
+		if (left[i] &&
+		    atomic_read(&xvt->queue_data[queue].gen_credits) > 0)
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * Queue up to @count copies of frame @frame_index, as long as its queue has
+ * credits. Returns the number of frames queued or a negative error.
+ */
+static int iwl_xvt_tx_gen_burst(struct iwl_xvt *xvt,
+				struct iwl_xvt_tx_gen_data *task_data,
+				u8 frame_index, u16 count, u32 *status)
+{
+	struct iwl_xvt_tx_start *tx_start = &task_data->gen_start.tx_start;
+	u8 queue = tx_start->frames_data[frame_index].queue;
+	struct tx_queue_data *queue_data = &xvt->queue_data[queue];
+	int sent;
+
+	for (sent = 0; sent < count; sent++) {
+		struct iwl_device_tx_cmd *dev_cmd;
+		struct sk_buff *skb;
+		int err;
+
+		if (atomic_dec_if_positive(&queue_data->gen_credits) < 0)
+			break;
+
+		skb = pskb_copy(task_data->templates[frame_index], GFP_KERNEL);
+		if (!skb) {
+			atomic_inc(&queue_data->gen_credits);
+			*status = XVT_TX_DRIVER_ABORTED;
+			return -ENOMEM;
+		}
+
+		iwl_xvt_set_seq_number(xvt, &xvt->tx_meta_data[XVT_LMAC_0_ID],
+				       skb, 0);
+
+		dev_cmd = iwl_xvt_set_enhanced_tx_params(xvt, skb, tx_start,
+							 frame_index);
+		if (!dev_cmd) {
+			kfree_skb(skb);
+			atomic_inc(&queue_data->gen_credits);
+			*status = XVT_TX_DRIVER_ABORTED;
+			return -ENOMEM;
+		}
+
+		local_bh_disable();
+		err = iwl_trans_tx(xvt->trans, skb, dev_cmd, queue);
+		local_bh_enable();
+		if (err) {
+			IWL_ERR(xvt, "Tx command failed (error %d)\n", err);
+			iwl_trans_free_tx_cmd(xvt->trans, dev_cmd);
+			kfree_skb(skb);
+			atomic_inc(&queue_data->gen_credits);
+			*status = XVT_TX_DRIVER_ABORTED;
+			return err;
+		}
+
+		queue_data->gen_queued++;
+	}
+
+	return sent;
+}
+
+static int iwl_xvt_tx_gen_handler(void *data)
+{
+	struct iwl_xvt_tx_gen_data *task_data = data;
+	struct iwl_xvt_tx_start *tx_start = &task_data->gen_start.tx_start;
+	struct iwl_xvt *xvt = task_data->xvt;
+	u16 num_of_frames = tx_start->num_of_different_frames;
+	unsigned long interval =
+		msecs_to_jiffies(task_data->gen_start.summary_interval_ms);
+	unsigned long start = jiffies, next_summary = start + interval;
+	u16 left[IWL_XVT_MAX_NUM_OF_FRAMES];
+	u64 cycle, num_of_cycles = tx_start->num_of_cycles;
+	u64 sent_packets = 0;
+	u32 status = XVT_TX_DRIVER_SUCCESSFUL;
+	int time_remain, err = 0;
+	u16 i;
+
+	if (num_of_cycles == IWL_XVT_TX_MODULATED_INFINITE)
+		num_of_cycles = XVT_MAX_TX_COUNT;
+
+	for (cycle = 0; cycle < num_of_cycles && !kthread_should_stop();
+	     cycle++) {
+		bool pending = true;
+
+		for (i = 0; i < num_of_frames; i++)
+			left[i] = tx_start->frames_data[i].times;
+
+		while (pending && !kthread_should_stop()) {
+			bool progress = false;
+
+			if (xvt->fw_error) {
+				IWL_ERR(xvt, "FW Error during TX\n");
+				status = XVT_TX_DRIVER_ABORTED;
+				err = -ENODEV;
+				goto on_exit;
+			}
+
+			/*
+			 * Fill all the queues in turn, a queue that ran out of
+			 * credits doesn't hold the others back.
+			 */
+			pending = false;
+			for (i = 0; i < num_of_frames; i++) {
+				int ret;
+
+				if (!left[i])
+					continue;
+
+				ret = iwl_xvt_tx_gen_burst(xvt, task_data, i,
+							   left[i], &status);
+				if (ret < 0) {
+					err = ret;
+					goto on_exit;
+				}
+
+				left[i] -= ret;
+				sent_packets += ret;
+				progress |= ret > 0;
+				pending |= left[i] > 0;
+			}
+
+			if (interval && time_after_eq(jiffies, next_summary)) {
+				iwl_xvt_tx_gen_send_summary(xvt, status, false,
+							    start);
+				next_summary = jiffies + interval;
+			}
+
+			if (!pending || progress)
+				continue;
+
+			/* all the queues are full, wait for reclaim */
+			time_remain = wait_event_interruptible_timeout(
+				xvt->tx_gen_wq,
+				iwl_xvt_tx_gen_has_credits(xvt, tx_start,
+							   left) ||
+				xvt->fw_error || kthread_should_stop(),
+				HZ);
+			if (time_remain <= 0) {
+				IWL_ERR(xvt, "Error while sending Tx - queue full\n");
+				status = XVT_TX_DRIVER_QUEUE_FULL;
+				err = -EIO;
+				goto on_exit;
+			}
+		}
+	}
+
+on_exit:
+	if (kthread_should_stop())
+		iwl_xvt_flush_sta_tids(xvt);
+
+	/* only now the amount is known, let the reclaim path wake us up */
+	xvt->expected_tx_amount = sent_packets;
+
+	if (sent_packets > 0 && !xvt->fw_error) {
+		time_remain = wait_event_interruptible_timeout(xvt->tx_done_wq,
+					xvt->num_of_tx_resp == sent_packets ||
+					kthread_should_stop(),
+					5 * HZ * CPTCFG_IWL_TIMEOUT_FACTOR);
+		if (time_remain <= 0) {
+			iwl_xvt_flush_sta_tids(xvt);
+			IWL_ERR(xvt, "err %d: Not all Tx messages were sent\n",
+				time_remain);
+			if (status == XVT_TX_DRIVER_SUCCESSFUL)
+				status = XVT_TX_DRIVER_TIMEOUT;
+		}
+	}
+
+	iwl_xvt_tx_gen_send_summary(xvt, status, true, start);
+	err = iwl_xvt_send_tx_done_notif(xvt, status);
+
+	xvt->is_tx_gen = false;
+	xvt->is_enhanced_tx = false;
+	iwl_xvt_tx_gen_free(task_data);
+	kthread_complete_and_exit(&xvt->tx_task_completion, err);
+}
+
+static int iwl_xvt_start_tx_gen(struct iwl_xvt *xvt,
+				struct iwl_xvt_driver_command_req *req)
+{
+	struct iwl_xvt_tx_gen_data *task_data;
+	struct iwl_xvt_tx_start *tx_start;
+	struct task_struct *task;
+	u64 packets_in_cycle = 0;
+	int i, err;
+
+	if (WARN(xvt->is_enhanced_tx ||
+		 xvt->tx_meta_data[XVT_LMAC_0_ID].tx_task_operating ||
+		 xvt->tx_meta_data[XVT_LMAC_1_ID].tx_task_operating,
+		 "TX is already in progress\n"))
+		return -EINVAL;
+
+	task_data = kzalloc(sizeof(*task_data), GFP_KERNEL);
+	if (!task_data)
+		return -ENOMEM;
+
+	task_data->xvt = xvt;
+	memcpy(&task_data->gen_start, req->input_data,
+	       sizeof(task_data->gen_start));
+	tx_start = &task_data->gen_start.tx_start;
+
+	if (tx_start->tx_data.fragment_size ||
+	    !tx_start->num_of_different_frames ||
+	    tx_start->num_of_different_frames > IWL_XVT_MAX_NUM_OF_FRAMES) {
+		err = -EINVAL;
+		goto err_free;
+	}
+
+	for (i = 0; i < tx_start->num_of_different_frames; i++) {
+		struct tx_cmd_frame_data *frame = &tx_start->frames_data[i];
+		struct tx_payload *payload;
+
+		if (frame->payload_index >= IWL_XVT_MAX_PAYLOADS_AMOUNT ||
+		    frame->queue >= IWL_MAX_HW_QUEUES ||
+		    !xvt->queue_data[frame->queue].allocated_queue) {
+			err = -EINVAL;
+			goto err_free;
+		}
+
+		payload = xvt->payloads[frame->payload_index];
+		if (!payload) {
+			err = -EINVAL;
+			goto err_free;
+		}
+
+		task_data->templates[i] =
+			iwl_xvt_tx_gen_template(xvt, (void *)frame->header,
+						payload);
+		if (!task_data->templates[i]) {
+			err = -ENOMEM;
+			goto err_free;
+		}
+
+		packets_in_cycle += frame->times;
+	}
+
+	if (!packets_in_cycle) {
+		err = -EINVAL;
+		goto err_free;
+	}
+
+	for (i = 0; i < IWL_MAX_HW_QUEUES; i++) {
+		struct tx_queue_data *queue_data = &xvt->queue_data[i];
+		u32 credits = queue_data->queue_size ?:
+			xvt->trans->trans_cfg->base_params->max_tfd_queue_size;
+
+		queue_data->tx_counter = 0;
+		queue_data->gen_queued = 0;
+		queue_data->tx_failed = 0;
+		queue_data->ba_txed = 0;
+		queue_data->ba_acked = 0;
+		atomic_set(&queue_data->gen_credits, credits);
+	}
+
+	xvt->num_of_tx_resp = 0;
+	xvt->expected_tx_amount = 0;
+	xvt->send_tx_resp = tx_start->send_tx_resp;
+	xvt->is_enhanced_tx = true;
+	xvt->is_tx_gen = true;
+
+	init_completion(&xvt->tx_task_completion);
+	task = kthread_run(iwl_xvt_tx_gen_handler, task_data, "xvt tx gen");
+	if (IS_ERR(task)) {
+		xvt->is_tx_gen = false;
+		xvt->is_enhanced_tx = false;
+		err = PTR_ERR(task);
+		goto err_free;
+	}
+	xvt->tx_task = task;
+
+	return 0;
+
+err_free:
+	iwl_xvt_tx_gen_free(task_data);
+	return err;
+}
+
 static int iwl_xvt_set_tx_payload(struct iwl_xvt *xvt,
 				  struct iwl_xvt_driver_command_req *req)
 {
@@ -1841,6 +2238,7 @@ static int iwl_xvt_add_txq(struct iwl_xvt *xvt, u32 sta_mask,
 	xvt->queue_data[queue_id].allocated_queue = true;
 	xvt->queue_data[queue_id].sta_mask = sta_mask;
 	xvt->queue_data[queue_id].tid = cmd->tid;
+	xvt->queue_data[queue_id].queue_size = size;
 	init_waitqueue_head(&xvt->queue_data[queue_id].tx_wq);
 
 	return queue_id;
@@ -2160,6 +2558,9 @@ static int iwl_xvt_handle_driver_cmd(struct iwl_xvt *xvt,
 	case IWL_DRV_CMD_ECHO_NOTIF:
 		err = iwl_xvt_echo_notif(xvt);
 		break;
+	case IWL_DRV_CMD_TX_GEN_START:
+		err = iwl_xvt_start_tx_gen(xvt, req);
+		break;
 	default:
 		IWL_ERR(xvt, "no command handler found for cmd_id[%u]\n",
 			cmd_id);
@@ -9,6 +9,18 @@
 #include "iwl-tm-infc.h"
 #include "xvt.h"
 
+/**
+ * struct iwl_xvt_tx_gen_data - Data for the TX generator task
+ * @xvt: pointer to the xvt op mode
+ * @gen_start: IWL_DRV_CMD_TX_GEN_START command's input
+ * @templates: one frame per frames_data entry, copied for each transmission
+ */
+struct iwl_xvt_tx_gen_data {
+	struct iwl_xvt *xvt;
+	struct iwl_xvt_tx_gen_start gen_start;
+	struct sk_buff *templates[IWL_XVT_MAX_NUM_OF_FRAMES];
+};
+
 /*
  * iwl_xvt_user_send_notif masks the usage of iwl-tm-gnl
  * If there is a need in replacing the interface, it
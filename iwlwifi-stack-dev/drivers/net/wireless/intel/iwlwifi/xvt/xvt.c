@@ -302,6 +302,8 @@ static struct iwl_op_mode *iwl_xvt_start(struct iwl_trans *trans,
 	xvt->send_rx_mpdu = true;
 	memset(xvt->queue_data, 0, sizeof(xvt->queue_data));
 	init_waitqueue_head(&xvt->tx_done_wq);
+	xvt->is_tx_gen = false;
+	init_waitqueue_head(&xvt->tx_gen_wq);
 
 	trans->dbg.dest_tlv = xvt->fw->dbg.dest_tlv;
 	trans->dbg.n_dest_reg = xvt->fw->dbg.n_dest_reg;
@@ -331,6 +333,7 @@ static void iwl_xvt_stop(struct iwl_op_mode *op_mode)
 	int i;
 
 	iwl_fw_cancel_timestamp(&xvt->fwrt);
+	iwl_xvt_rx_relay_close(xvt);
 
 	if (xvt->state != IWL_XVT_STATE_UNINITIALIZED) {
 		if (xvt->fw_running) {
@@ -369,6 +372,13 @@ static void iwl_xvt_reclaim_and_free(struct iwl_xvt *xvt,
 
 	iwl_trans_reclaim(xvt->trans, txq_id, ssn, &skbs);
 
+	/* give the generator its credits back before freeing the frames */
+	if (xvt->is_tx_gen && !skb_queue_empty(&skbs)) {
+		atomic_add(skb_queue_len(&skbs),
+			   &xvt->queue_data[txq_id].gen_credits);
+		wake_up_interruptible(&xvt->tx_gen_wq);
+	}
+
 	while (!skb_queue_empty(&skbs)) {
 		skb = __skb_dequeue(&skbs);
 		skb_info = (void *)skb->cb;
@@ -484,8 +494,11 @@ static void iwl_xvt_rx_tx_cmd_single(struct iwl_xvt *xvt,
 	if (!tx_data)
 		return;
 
-	if (unlikely(status != TX_STATUS_SUCCESS))
+	if (unlikely(status != TX_STATUS_SUCCESS)) {
 		IWL_WARN(xvt, "got error TX_RSP status %#x\n", status);
+		if (xvt->is_enhanced_tx)
+			xvt->queue_data[txq_id].tx_failed++;
+	}
 
 	iwl_xvt_reclaim_and_free(xvt, tx_data, txq_id, ssn);
 }
@@ -524,6 +537,13 @@ static void iwl_xvt_rx_ba_notif(struct iwl_xvt *xvt,
 		if (!tx_data)
 			return;
 
+		if (xvt->is_enhanced_tx && queue < IWL_MAX_HW_QUEUES) {
+			xvt->queue_data[queue].ba_txed +=
+				le16_to_cpu(ba_res->txed);
+			xvt->queue_data[queue].ba_acked +=
+				le16_to_cpu(ba_res->done);
+		}
+
 		iwl_xvt_reclaim_and_free(xvt, tx_data, queue, tfd_idx);
 out:
 		IWL_DEBUG_TX_REPLY(xvt,
@@ -542,6 +562,11 @@ out:
 	if (!tx_data)
 		return;
 
+	if (xvt->is_enhanced_tx && scd_flow < IWL_MAX_HW_QUEUES) {
+		xvt->queue_data[scd_flow].ba_txed += ba_notif->txed;
+		xvt->queue_data[scd_flow].ba_acked += ba_notif->txed_2_done;
+	}
+
 	iwl_xvt_reclaim_and_free(xvt, tx_data, scd_flow, scd_ssn);
 
 	IWL_DEBUG_TX_REPLY(xvt, "ba_notif from %pM, sta_id = %d\n",
@@ -8,6 +8,7 @@
 
 #include <linux/spinlock.h>
 #include <linux/if_ether.h>
+#include <linux/relay.h>
 #include "iwl-drv.h"
 #include "iwl-trans.h"
 #include "iwl-op-mode.h"
@@ -118,6 +119,13 @@ struct iwl_xvt_reorder_buffer {
  * @allocated_queue: Whether queue is allocated
  * @sta_mask: Station id mask
  * @tid: TID
+ * @queue_size: Size the queue was allocated with
+ * @gen_credits: Frames the generator can still queue without overrunning
+ *	the queue, given back when frames are reclaimed
+ * @gen_queued: Frames queued by the generator
+ * @tx_failed: Frames reported as failed in TX_RSP
+ * @ba_txed: MPDUs reported as sent in BA notifications
+ * @ba_acked: MPDUs reported as acked in BA notifications
  */
 struct tx_queue_data {
 	wait_queue_head_t tx_wq;
@@ -126,6 +134,12 @@ struct tx_queue_data {
 	bool allocated_queue;
 	u32 sta_mask;
 	u16 tid;
+	u16 queue_size;
+	atomic_t gen_credits;
+	u64 gen_queued;
+	u64 tx_failed;
+	u64 ba_txed;
+	u64 ba_acked;
 };
 
 /**
@@ -299,6 +313,16 @@ struct iwl_xvt {
 	u64 expected_tx_amount;
 	wait_queue_head_t tx_done_wq;
 	struct tx_queue_data queue_data[IWL_MAX_HW_QUEUES];
+
+	/* members for the TX generator, uses the enhanced tx members too */
+	bool is_tx_gen;
+	wait_queue_head_t tx_gen_wq;
+
+	/* RX notifications relay, protected by notif_lock */
+	struct rchan *rx_relay;
+	u32 rx_relay_seq;
+	u32 rx_relay_dropped;
+	bool rx_relay_flushing; /* rx_relay is detached for a flush */
 };
 
 #define IWL_OP_MODE_GET_XVT(_op_mode) \
@@ -403,6 +427,22 @@ static inline int iwl_xvt_dbgfs_register(struct iwl_xvt *xvt,
 }
 #endif /* CPTCFG_IWLWIFI_DEBUGFS */
 
+#if defined(CPTCFG_IWLWIFI_DEBUGFS) && defined(CONFIG_RELAY)
+bool iwl_xvt_rx_relay_write(struct iwl_xvt *xvt, u32 cmd,
+			    const void *data, u32 len);
+void iwl_xvt_rx_relay_close(struct iwl_xvt *xvt);
+#else
+static inline bool iwl_xvt_rx_relay_write(struct iwl_xvt *xvt, u32 cmd,
+					  const void *data, u32 len)
+{
+	return false;
+}
+
+static inline void iwl_xvt_rx_relay_close(struct iwl_xvt *xvt)
+{
+}
+#endif
+
 #endif
 
 int iwl_xvt_init_sar_tables(struct iwl_xvt *xvt);
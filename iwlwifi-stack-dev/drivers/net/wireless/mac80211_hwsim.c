@@ -1346,6 +1346,36 @@ static inline u16 trans_tx_rate_flags_ieee2hwsim(struct ieee80211_tx_rate *rate)
 		result |= MAC80211_HWSIM_TX_RC_USE_RTS_CTS;
 	if (rate->flags & IEEE80211_TX_RC_USE_CTS_PROTECT)
 		result |= MAC80211_HWSIM_TX_RC_USE_CTS_PROTECT;
+
+	/*
+	 * HE and EHT rates are encoded with otherwise invalid combinations
+	 * of the VHT, greenfield, DUP_DATA, short preamble and width flags,
+	 * don't export those as they are.
+	 */
+	if (ieee80211_rate_is_he(rate) || ieee80211_rate_is_eht(rate)) {
+		if (ieee80211_rate_is_eht(rate))
+			result |= MAC80211_HWSIM_TX_RC_EHT_MCS;
+		else
+			result |= MAC80211_HWSIM_TX_RC_HE_MCS;
+		if (ieee80211_rate_is_he(rate) &&
+		    rate->flags & IEEE80211_TX_RC_HE_DCM)
+			result |= MAC80211_HWSIM_TX_RC_HE_DCM;
+		if (rate->flags & IEEE80211_TX_RC_SHORT_GI)
+			result |= MAC80211_HWSIM_TX_RC_SHORT_GI;
+		if (ieee80211_rate_is_eht(rate) &&
+		    (rate->flags & IEEE80211_TX_RC_320_MHZ_WIDTH) ==
+		    IEEE80211_TX_RC_320_MHZ_WIDTH)
+			result |= MAC80211_HWSIM_TX_RC_320_MHZ_WIDTH;
+		else if (rate->flags & IEEE80211_TX_RC_40_MHZ_WIDTH)
+			result |= MAC80211_HWSIM_TX_RC_40_MHZ_WIDTH;
+		else if (rate->flags & IEEE80211_TX_RC_80_MHZ_WIDTH)
+			result |= MAC80211_HWSIM_TX_RC_80_MHZ_WIDTH;
+		else if (rate->flags & IEEE80211_TX_RC_160_MHZ_WIDTH)
+			result |= MAC80211_HWSIM_TX_RC_160_MHZ_WIDTH;
+
+		return result;
+	}
+
 	if (rate->flags & IEEE80211_TX_RC_USE_SHORT_PREAMBLE)
 		result |= MAC80211_HWSIM_TX_RC_USE_SHORT_PREAMBLE;
 	if (rate->flags & IEEE80211_TX_RC_MCS)
@@ -1620,7 +1650,29 @@ static bool mac80211_hwsim_tx_frame_no_nl(struct ieee80211_hw *hw,
 	rx_status.freq = chan->center_freq;
 	rx_status.freq_offset = chan->freq_offset ? 1 : 0;
 	rx_status.band = chan->band;
-	if (info->control.rates[0].flags & IEEE80211_TX_RC_VHT_MCS) {
+	if (ieee80211_rate_is_eht(&info->control.rates[0])) {
+		rx_status.rate_idx =
+			ieee80211_rate_get_vht_mcs(&info->control.rates[0]);
+		rx_status.nss =
+			ieee80211_rate_get_vht_nss(&info->control.rates[0]);
+		rx_status.encoding = RX_ENC_EHT;
+		rx_status.eht.gi =
+			info->control.rates[0].flags & IEEE80211_TX_RC_SHORT_GI ?
+			NL80211_RATE_INFO_EHT_GI_0_8 :
+			NL80211_RATE_INFO_EHT_GI_1_6;
+	} else if (ieee80211_rate_is_he(&info->control.rates[0])) {
+		rx_status.rate_idx =
+			ieee80211_rate_get_vht_mcs(&info->control.rates[0]);
+		rx_status.nss =
+			ieee80211_rate_get_vht_nss(&info->control.rates[0]);
+		rx_status.encoding = RX_ENC_HE;
+		rx_status.he_gi =
+			info->control.rates[0].flags & IEEE80211_TX_RC_SHORT_GI ?
+			NL80211_RATE_INFO_HE_GI_0_8 :
+			NL80211_RATE_INFO_HE_GI_1_6;
+		rx_status.he_dcm =
+			!!(info->control.rates[0].flags & IEEE80211_TX_RC_HE_DCM);
+	} else if (info->control.rates[0].flags & IEEE80211_TX_RC_VHT_MCS) {
 		rx_status.rate_idx =
 			ieee80211_rate_get_vht_mcs(&info->control.rates[0]);
 		rx_status.nss =
@@ -1631,7 +1683,10 @@ static bool mac80211_hwsim_tx_frame_no_nl(struct ieee80211_hw *hw,
 		if (info->control.rates[0].flags & IEEE80211_TX_RC_MCS)
 			rx_status.encoding = RX_ENC_HT;
 	}
-	if (info->control.rates[0].flags & IEEE80211_TX_RC_40_MHZ_WIDTH)
+	if ((info->control.rates[0].flags & IEEE80211_TX_RC_320_MHZ_WIDTH) ==
+	    IEEE80211_TX_RC_320_MHZ_WIDTH)
+		rx_status.bw = RATE_INFO_BW_320;
+	else if (info->control.rates[0].flags & IEEE80211_TX_RC_40_MHZ_WIDTH)
 		rx_status.bw = RATE_INFO_BW_40;
 	else if (info->control.rates[0].flags & IEEE80211_TX_RC_80_MHZ_WIDTH)
 		rx_status.bw = RATE_INFO_BW_80;
@@ -1639,7 +1694,8 @@ static bool mac80211_hwsim_tx_frame_no_nl(struct ieee80211_hw *hw,
 		rx_status.bw = RATE_INFO_BW_160;
 	else
 		rx_status.bw = RATE_INFO_BW_20;
-	if (info->control.rates[0].flags & IEEE80211_TX_RC_SHORT_GI)
+	if (info->control.rates[0].flags & IEEE80211_TX_RC_SHORT_GI &&
+	    rx_status.encoding != RX_ENC_HE && rx_status.encoding != RX_ENC_EHT)
 		rx_status.enc_flags |= RX_ENC_FLAG_SHORT_GI;
 	/* TODO: simulate optional packet loss */
 	rx_status.signal = data->rx_rssi;
@@ -222,7 +222,13 @@ struct hwsim_tx_rate {
  *	the adjacent 20 MHz channels, if the current channel type is
  *	NL80211_CHAN_HT40MINUS or NL80211_CHAN_HT40PLUS.
  * @MAC80211_HWSIM_TX_RC_SHORT_GI: Short Guard interval should be used for this
- *	rate.
+ *	rate. For HE and EHT rates this selects the 0.8us guard interval.
+ * @MAC80211_HWSIM_TX_RC_HE_MCS: HE MCS rate, the idx field is split the same
+ *	way as for VHT rates
+ * @MAC80211_HWSIM_TX_RC_EHT_MCS: EHT MCS rate, the idx field is split the same
+ *	way as for VHT rates
+ * @MAC80211_HWSIM_TX_RC_HE_DCM: HE dual carrier modulation is used
+ * @MAC80211_HWSIM_TX_RC_320_MHZ_WIDTH: Indicates 320 MHz transmission
  */
 enum hwsim_tx_rate_flags {
 	MAC80211_HWSIM_TX_RC_USE_RTS_CTS		= BIT(0),
@@ -238,6 +244,10 @@ enum hwsim_tx_rate_flags {
 	MAC80211_HWSIM_TX_RC_VHT_MCS			= BIT(8),
 	MAC80211_HWSIM_TX_RC_80_MHZ_WIDTH		= BIT(9),
 	MAC80211_HWSIM_TX_RC_160_MHZ_WIDTH		= BIT(10),
+	MAC80211_HWSIM_TX_RC_HE_MCS			= BIT(11),
+	MAC80211_HWSIM_TX_RC_EHT_MCS			= BIT(12),
+	MAC80211_HWSIM_TX_RC_HE_DCM			= BIT(13),
+	MAC80211_HWSIM_TX_RC_320_MHZ_WIDTH		= BIT(14),
 };
 
 /**
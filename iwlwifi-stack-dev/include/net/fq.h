@@ -7,11 +7,14 @@
 #ifndef __NET_SCHED_FQ_H
 #define __NET_SCHED_FQ_H
 
+#include <linux/atomic.h>
+#include <linux/cache.h>
 #include <linux/skbuff.h>
 #include <linux/spinlock.h>
 #include <linux/types.h>
 
 struct fq_tin;
+struct fq_shard;
 
 /**
  * struct fq_flow - per traffic flow queue
@@ -24,16 +27,21 @@ struct fq_tin;
  *	(deficit round robin) based round robin queuing similar to the one
  *	found in net/sched/sch_fq_codel.c
  * @queue: sk_buff queue to hold packets
+ * @backlogchain: links the flow into its shard's backlog bucket while it
+ *	holds packets
  * @backlog: number of bytes pending in the queue. The number of packets can be
  *	found in @queue.qlen
  * @deficit: used for DRR++
+ * @bucket: backlog bucket the flow is linked into plus one, 0 if none
  */
 struct fq_flow {
 	struct fq_tin *tin;
 	struct list_head flowchain;
+	struct list_head backlogchain;
 	struct sk_buff_head queue;
 	u32 backlog;
 	int deficit;
+	u8 bucket;
 };
 
 /**
@@ -42,13 +50,15 @@ struct fq_flow {
  * Used to group fq_flows into a logical aggregate. DRR++ scheme is used to
  * pull interleaved packets out of the associated flows.
  *
+ * @shard: the fq_shard this tin's flows are hashed into. All of the tin's
+ *	state is protected by the shard's lock
  * @new_flows: linked list of fq_flow
  * @old_flows: linked list of fq_flow
  */
 struct fq_tin {
+	struct fq_shard *shard;
 	struct list_head new_flows;
 	struct list_head old_flows;
-	struct list_head tin_list;
 	struct fq_flow default_flow;
 	u32 backlog_bytes;
 	u32 backlog_packets;
@@ -59,29 +69,98 @@ struct fq_tin {
 	u32 tx_packets;
 };
 
+/* one bucket per possible fls() of a non-zero u32 backlog */
+#define FQ_BACKLOG_BUCKETS	32
+
+/**
+ * struct fq_shard - independently locked slice of the flow table
+ *
+ * Tins are bound to a shard when they are initialized and only ever hash into
+ * that shard's flows, so enqueue and dequeue on tins of different shards do
+ * not serialize on a common lock.
+ *
+ * Flows holding packets, including the tins' default flows, are kept in
+ * @backlog_buckets indexed by fls(backlog) - 1, so a flow of the highest
+ * non-empty bucket is within a factor of two of the fattest one and can be
+ * found without walking the flow table.
+ *
+ * @lock: protects the shard's flows and backlog buckets as well as all tins
+ *	bound to the shard
+ * @flows: this shard's part of &fq.flows
+ * @backlog_buckets: lists of backlogged flows, by backlog order of magnitude
+ * @backlog_mask: bit n is set iff @backlog_buckets[n] is not empty
+ * @flows_cnt: number of entries in @flows
+ * @lock_acquired: number of times @lock was taken via fq_shard_lock()
+ * @lock_contended: number of those that had to wait for another holder
+ */
+struct fq_shard {
+	spinlock_t lock;
+	struct fq_flow *flows;
+	struct list_head backlog_buckets[FQ_BACKLOG_BUCKETS];
+	u32 backlog_mask;
+	u32 flows_cnt;
+
+	unsigned long lock_acquired;
+	unsigned long lock_contended;
+} ____cacheline_aligned_in_smp;
+
 /**
  * struct fq - main container for fair queuing purposes
  *
+ * The limits and counters here are global across all shards; the counters
+ * are atomic so that they can be updated under any single shard lock.
+ *
+ * @flows: flow table backing all shards
+ * @shards: array of @shards_cnt shards
+ * @flows_cnt: total number of flows across all shards
  * @limit: max number of packets that can be queued across all flows
  * @backlog: number of packets queued across all flows
  */
 struct fq {
 	struct fq_flow *flows;
-	unsigned long *flows_bitmap;
-
-	struct list_head tin_backlog;
-	spinlock_t lock;
+	struct fq_shard *shards;
+	u32 shards_cnt;
 	u32 flows_cnt;
 	u32 limit;
 	u32 memory_limit;
-	u32 memory_usage;
 	u32 quantum;
-	u32 backlog;
-	u32 overlimit;
-	u32 overmemory;
-	u32 collisions;
+	atomic_t memory_usage;
+	atomic_t backlog;
+	atomic_t overlimit;
+	atomic_t overmemory;
+	atomic_t collisions;
 };
 
+static inline void fq_shard_lock(struct fq_shard *shard)
+{
+	bool contended = false;
+
+	if (!spin_trylock(&shard->lock)) {
+		spin_lock(&shard->lock);
+		contended = true;
+	}
+
+	shard->lock_acquired++;
+	if (contended)
+		shard->lock_contended++;
+}
+
+static inline void fq_shard_unlock(struct fq_shard *shard)
+{
+	spin_unlock(&shard->lock);
+}
+
+static inline void fq_shard_lock_bh(struct fq_shard *shard)
+{
+	local_bh_disable();
+	fq_shard_lock(shard);
+}
+
+static inline void fq_shard_unlock_bh(struct fq_shard *shard)
+{
+	spin_unlock_bh(&shard->lock);
+}
+
 typedef struct sk_buff *fq_tin_dequeue_t(struct fq *,
 					 struct fq_tin *,
 					 struct fq_flow *flow);
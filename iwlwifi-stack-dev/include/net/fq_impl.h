@@ -12,29 +12,46 @@
 /* functions that are embedded into includer */
 
 
+/*
+ * Move @flow to the backlog bucket matching its current backlog. Must be
+ * called whenever flow->backlog changes while the flow is owned by a tin.
+ */
+static void fq_flow_update_backlog(struct fq_flow *flow)
+{
+	struct fq_shard *shard = flow->tin->shard;
+	unsigned int bucket = fls(flow->backlog);
+
+	if (bucket == flow->bucket)
+		return;
+
+	if (flow->bucket) {
+		list_del_init(&flow->backlogchain);
+		if (list_empty(&shard->backlog_buckets[flow->bucket - 1]))
+			shard->backlog_mask &= ~BIT(flow->bucket - 1);
+	}
+
+	if (bucket) {
+		list_add_tail(&flow->backlogchain,
+			      &shard->backlog_buckets[bucket - 1]);
+		shard->backlog_mask |= BIT(bucket - 1);
+	}
+
+	flow->bucket = bucket;
+}
+
 static void
 __fq_adjust_removal(struct fq *fq, struct fq_flow *flow, unsigned int packets,
 		    unsigned int bytes, unsigned int truesize)
 {
 	struct fq_tin *tin = flow->tin;
-	int idx;
 
 	tin->backlog_bytes -= bytes;
 	tin->backlog_packets -= packets;
 	flow->backlog -= bytes;
-	fq->backlog -= packets;
-	fq->memory_usage -= truesize;
+	atomic_sub(packets, &fq->backlog);
+	atomic_sub(truesize, &fq->memory_usage);
 
-	if (flow->backlog)
-		return;
-
-	if (flow == &tin->default_flow) {
-		list_del_init(&tin->tin_list);
-		return;
-	}
-
-	idx = flow - fq->flows;
-	__clear_bit(idx, fq->flows_bitmap);
+	fq_flow_update_backlog(flow);
 }
 
 static void fq_adjust_removal(struct fq *fq,
@@ -49,7 +66,7 @@ static struct sk_buff *fq_flow_dequeue(struct fq *fq,
 {
 	struct sk_buff *skb;
 
-	lockdep_assert_held(&fq->lock);
+	lockdep_assert_held(&flow->tin->shard->lock);
 
 	skb = __skb_dequeue(&flow->queue);
 	if (!skb)
@@ -68,7 +85,7 @@ static int fq_flow_drop(struct fq *fq, struct fq_flow *flow,
 	struct sk_buff *skb;
 	int pending;
 
-	lockdep_assert_held(&fq->lock);
+	lockdep_assert_held(&tin->shard->lock);
 
 	pending = min_t(int, 32, skb_queue_len(&flow->queue) / 2);
 	do {
@@ -95,7 +112,7 @@ static struct sk_buff *fq_tin_dequeue(struct fq *fq,
 	struct list_head *head;
 	struct sk_buff *skb;
 
-	lockdep_assert_held(&fq->lock);
+	lockdep_assert_held(&tin->shard->lock);
 
 begin:
 	head = &tin->new_flows;
@@ -134,11 +151,12 @@ begin:
 	return skb;
 }
 
-static u32 fq_flow_idx(struct fq *fq, struct sk_buff *skb)
+static u32 fq_flow_idx(struct fq *fq, struct fq_tin *tin,
+		       struct sk_buff *skb)
 {
 	u32 hash = skb_get_hash(skb);
 
-	return reciprocal_scale(hash, fq->flows_cnt);
+	return reciprocal_scale(hash, tin->shard->flows_cnt);
 }
 
 static struct fq_flow *fq_flow_classify(struct fq *fq,
@@ -147,13 +165,13 @@ static struct fq_flow *fq_flow_classify(struct fq *fq,
 {
 	struct fq_flow *flow;
 
-	lockdep_assert_held(&fq->lock);
+	lockdep_assert_held(&tin->shard->lock);
 
-	flow = &fq->flows[idx];
+	flow = &tin->shard->flows[idx];
 	if (flow->tin && flow->tin != tin) {
 		flow = &tin->default_flow;
 		tin->collisions++;
-		fq->collisions++;
+		atomic_inc(&fq->collisions);
 	}
 
 	if (!flow->tin)
@@ -162,33 +180,63 @@ static struct fq_flow *fq_flow_classify(struct fq *fq,
 	return flow;
 }
 
-static struct fq_flow *fq_find_fattest_flow(struct fq *fq)
+static struct fq_flow *fq_shard_find_fattest_flow(struct fq_shard *shard,
+						  u32 *len)
 {
-	struct fq_tin *tin;
-	struct fq_flow *flow = NULL;
+	struct fq_flow *flow;
+	int bucket;
+
+	if (!shard->backlog_mask)
+		return NULL;
+
+	bucket = fls(shard->backlog_mask) - 1;
+	flow = list_first_entry(&shard->backlog_buckets[bucket],
+				struct fq_flow, backlogchain);
+	if (flow->backlog <= *len)
+		return NULL;
+
+	*len = flow->backlog;
+
+	return flow;
+}
+
+/*
+ * Find the fattest flow across all shards. The caller holds the lock of
+ * @shard; other shards are only looked at if their lock can be taken without
+ * waiting, which also keeps this free of lock ordering constraints. If the
+ * returned flow lives in another shard, that shard is left locked and
+ * returned in @victim, and the caller must release it once done with the flow.
+ */
+static struct fq_flow *fq_find_fattest_flow(struct fq *fq,
+					    struct fq_shard *shard,
+					    struct fq_shard **victim)
+{
+	struct fq_flow *flow, *cur_flow;
 	u32 len = 0;
 	int i;
 
-	for_each_set_bit(i, fq->flows_bitmap, fq->flows_cnt) {
-		struct fq_flow *cur = &fq->flows[i];
-		unsigned int cur_len;
+	lockdep_assert_held(&shard->lock);
 
-		cur_len = cur->backlog;
-		if (cur_len <= len)
-			continue;
+	flow = fq_shard_find_fattest_flow(shard, &len);
+	*victim = shard;
 
-		flow = cur;
-		len = cur_len;
-	}
+	for (i = 0; i < fq->shards_cnt; i++) {
+		struct fq_shard *cur = &fq->shards[i];
 
-	list_for_each_entry(tin, &fq->tin_backlog, tin_list) {
-		unsigned int cur_len = tin->default_flow.backlog;
+		if (cur == shard || !spin_trylock(&cur->lock))
+			continue;
 
-		if (cur_len <= len)
+		cur_flow = fq_shard_find_fattest_flow(cur, &len);
+		if (!cur_flow) {
+			spin_unlock(&cur->lock);
 			continue;
+		}
 
-		flow = &tin->default_flow;
-		len = cur_len;
+		if (*victim != shard)
+			spin_unlock(&(*victim)->lock);
+
+		*victim = cur;
+		flow = cur_flow;
 	}
 
 	return flow;
@@ -199,26 +247,23 @@ static void fq_tin_enqueue(struct fq *fq,
 			   struct sk_buff *skb,
 			   fq_skb_free_t free_func)
 {
+	struct fq_shard *shard = tin->shard;
+	struct fq_shard *victim;
 	struct fq_flow *flow;
+	int dropped;
 	bool oom;
 
-	lockdep_assert_held(&fq->lock);
+	lockdep_assert_held(&shard->lock);
 
 	flow = fq_flow_classify(fq, tin, idx, skb);
 
-	if (!flow->backlog) {
-		if (flow != &tin->default_flow)
-			__set_bit(idx, fq->flows_bitmap);
-		else if (list_empty(&tin->tin_list))
-			list_add(&tin->tin_list, &fq->tin_backlog);
-	}
-
 	flow->tin = tin;
 	flow->backlog += skb->len;
+	fq_flow_update_backlog(flow);
 	tin->backlog_bytes += skb->len;
 	tin->backlog_packets++;
-	fq->memory_usage += skb->truesize;
-	fq->backlog++;
+	atomic_add(skb->truesize, &fq->memory_usage);
+	atomic_inc(&fq->backlog);
 
 	if (list_empty(&flow->flowchain)) {
 		flow->deficit = fq->quantum;
@@ -227,20 +272,27 @@ static void fq_tin_enqueue(struct fq *fq,
 	}
 
 	__skb_queue_tail(&flow->queue, skb);
-	oom = (fq->memory_usage > fq->memory_limit);
-	while (fq->backlog > fq->limit || oom) {
-		flow = fq_find_fattest_flow(fq);
+	oom = (atomic_read(&fq->memory_usage) > fq->memory_limit);
+	while (atomic_read(&fq->backlog) > fq->limit || oom) {
+		flow = fq_find_fattest_flow(fq, shard, &victim);
 		if (!flow)
 			return;
 
-		if (!fq_flow_drop(fq, flow, free_func))
+		dropped = fq_flow_drop(fq, flow, free_func);
+		if (dropped)
+			flow->tin->overlimit++;
+
+		if (victim != shard)
+			spin_unlock(&victim->lock);
+
+		if (!dropped)
 			return;
 
-		flow->tin->overlimit++;
-		fq->overlimit++;
+		atomic_inc(&fq->overlimit);
 		if (oom) {
-			fq->overmemory++;
-			oom = (fq->memory_usage > fq->memory_limit);
+			atomic_inc(&fq->overmemory);
+			oom = (atomic_read(&fq->memory_usage) >
+			       fq->memory_limit);
 		}
 	}
 }
@@ -254,7 +306,7 @@ static void fq_flow_filter(struct fq *fq,
 	struct fq_tin *tin = flow->tin;
 	struct sk_buff *skb, *tmp;
 
-	lockdep_assert_held(&fq->lock);
+	lockdep_assert_held(&tin->shard->lock);
 
 	skb_queue_walk_safe(&flow->queue, skb, tmp) {
 		if (!filter_func(fq, tin, flow, skb, filter_data))
@@ -274,7 +326,7 @@ static void fq_tin_filter(struct fq *fq,
 {
 	struct fq_flow *flow;
 
-	lockdep_assert_held(&fq->lock);
+	lockdep_assert_held(&tin->shard->lock);
 
 	list_for_each_entry(flow, &tin->new_flows, flowchain)
 		fq_flow_filter(fq, flow, filter_func, filter_data, free_func);
@@ -289,16 +341,14 @@ static void fq_flow_reset(struct fq *fq,
 	struct fq_tin *tin = flow->tin;
 	struct sk_buff *skb;
 
+	/* flows are only ever left without an owner once drained */
+	if (!tin)
+		return;
+
 	while ((skb = fq_flow_dequeue(fq, flow)))
 		free_func(fq, tin, flow, skb);
 
-	if (!list_empty(&flow->flowchain)) {
-		list_del_init(&flow->flowchain);
-		if (list_empty(&tin->new_flows) &&
-		    list_empty(&tin->old_flows))
-			list_del_init(&tin->tin_list);
-	}
-
+	list_del_init(&flow->flowchain);
 	flow->tin = NULL;
 
 	WARN_ON_ONCE(flow->backlog);
@@ -323,7 +373,6 @@ static void fq_tin_reset(struct fq *fq,
 		fq_flow_reset(fq, flow, free_func);
 	}
 
-	WARN_ON_ONCE(!list_empty(&tin->tin_list));
 	WARN_ON_ONCE(tin->backlog_bytes);
 	WARN_ON_ONCE(tin->backlog_packets);
 }
@@ -331,25 +380,39 @@ static void fq_tin_reset(struct fq *fq,
 static void fq_flow_init(struct fq_flow *flow)
 {
 	INIT_LIST_HEAD(&flow->flowchain);
+	INIT_LIST_HEAD(&flow->backlogchain);
 	__skb_queue_head_init(&flow->queue);
 }
 
-static void fq_tin_init(struct fq_tin *tin)
+static void fq_tin_init(struct fq *fq, struct fq_tin *tin, u32 shard)
 {
+	tin->shard = &fq->shards[shard % fq->shards_cnt];
 	INIT_LIST_HEAD(&tin->new_flows);
 	INIT_LIST_HEAD(&tin->old_flows);
-	INIT_LIST_HEAD(&tin->tin_list);
 	fq_flow_init(&tin->default_flow);
 }
 
-static int fq_init(struct fq *fq, int flows_cnt)
+static void fq_free(struct fq *fq)
 {
-	int i;
+	kfree(fq->shards);
+	fq->shards = NULL;
+
+	kvfree(fq->flows);
+	fq->flows = NULL;
+}
+
+/*
+ * Set up @shards_cnt independently locked shards of @flows_cnt flows each.
+ * Tins pick their shard in fq_tin_init().
+ */
+static int fq_init_shards(struct fq *fq, int flows_cnt, int shards_cnt)
+{
+	int i, j;
 
 	memset(fq, 0, sizeof(fq[0]));
-	spin_lock_init(&fq->lock);
-	INIT_LIST_HEAD(&fq->tin_backlog);
-	fq->flows_cnt = max_t(u32, flows_cnt, 1);
+	fq->shards_cnt = max_t(u32, shards_cnt, 1);
+	flows_cnt = max_t(u32, flows_cnt, 1);
+	fq->flows_cnt = flows_cnt * fq->shards_cnt;
 	fq->quantum = 300;
 	fq->limit = 8192;
 	fq->memory_limit = 16 << 20; /* 16 MBytes */
@@ -358,32 +421,44 @@ static int fq_init(struct fq *fq, int flows_cnt)
 	if (!fq->flows)
 		return -ENOMEM;
 
-	fq->flows_bitmap = bitmap_zalloc(fq->flows_cnt, GFP_KERNEL);
-	if (!fq->flows_bitmap) {
-		kvfree(fq->flows);
-		fq->flows = NULL;
+	fq->shards = kcalloc(fq->shards_cnt, sizeof(fq->shards[0]), GFP_KERNEL);
+	if (!fq->shards) {
+		fq_free(fq);
 		return -ENOMEM;
 	}
 
+	for (i = 0; i < fq->shards_cnt; i++) {
+		struct fq_shard *shard = &fq->shards[i];
+
+		spin_lock_init(&shard->lock);
+		for (j = 0; j < FQ_BACKLOG_BUCKETS; j++)
+			INIT_LIST_HEAD(&shard->backlog_buckets[j]);
+		shard->flows = &fq->flows[i * flows_cnt];
+		shard->flows_cnt = flows_cnt;
+	}
+
 	for (i = 0; i < fq->flows_cnt; i++)
 		fq_flow_init(&fq->flows[i]);
 
 	return 0;
 }
 
+/* Takes each shard's lock in turn, must be called without any held. */
 static void fq_reset(struct fq *fq,
 		     fq_skb_free_t free_func)
 {
-	int i;
+	int i, j;
 
-	for (i = 0; i < fq->flows_cnt; i++)
-		fq_flow_reset(fq, &fq->flows[i], free_func);
+	for (i = 0; i < fq->shards_cnt; i++) {
+		struct fq_shard *shard = &fq->shards[i];
 
-	kvfree(fq->flows);
-	fq->flows = NULL;
+		fq_shard_lock_bh(shard);
+		for (j = 0; j < shard->flows_cnt; j++)
+			fq_flow_reset(fq, &shard->flows[j], free_func);
+		fq_shard_unlock_bh(shard);
+	}
 
-	bitmap_free(fq->flows_bitmap);
-	fq->flows_bitmap = NULL;
+	fq_free(fq);
 }
 
 #endif
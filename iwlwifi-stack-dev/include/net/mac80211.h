@@ -965,6 +965,15 @@ enum mac80211_tx_status_flags {
  *	adjacent 20 MHz channels, if the current channel type is
  *	NL80211_CHAN_HT40MINUS or NL80211_CHAN_HT40PLUS.
  * @IEEE80211_TX_RC_SHORT_GI: Short Guard interval should be used for this rate.
+ *	For HE and EHT rates this selects the 0.8us guard interval, otherwise
+ *	the 1.6us guard interval is used.
+ *
+ * HE and EHT rates don't have flags of their own, since all bits of the
+ * @flags field in struct ieee80211_tx_rate are taken. They are encoded as
+ * combinations of the flags above that are not valid otherwise, see
+ * %IEEE80211_TX_RC_HE_MCS, %IEEE80211_TX_RC_EHT_MCS, %IEEE80211_TX_RC_HE_DCM
+ * and %IEEE80211_TX_RC_320_MHZ_WIDTH below, and should be checked using
+ * ieee80211_rate_is_he() and ieee80211_rate_is_eht().
  */
 enum mac80211_rate_control_flags {
 	IEEE80211_TX_RC_USE_RTS_CTS		= BIT(0),
@@ -982,6 +991,21 @@ enum mac80211_rate_control_flags {
 	IEEE80211_TX_RC_160_MHZ_WIDTH		= BIT(10),
 };
 
+/*
+ * HE MCS rate: a VHT MCS rate with the (HT only) greenfield flag set. The idx
+ * field is split the same way as for VHT rates.
+ */
+#define IEEE80211_TX_RC_HE_MCS		(IEEE80211_TX_RC_VHT_MCS | \
+					 IEEE80211_TX_RC_GREEN_FIELD)
+/* EHT MCS rate: an HE MCS rate with the (legacy only) duplicate flag set */
+#define IEEE80211_TX_RC_EHT_MCS		(IEEE80211_TX_RC_HE_MCS | \
+					 IEEE80211_TX_RC_DUP_DATA)
+/* HE dual carrier modulation, short preamble only applies to CCK rates */
+#define IEEE80211_TX_RC_HE_DCM		IEEE80211_TX_RC_USE_SHORT_PREAMBLE
+/* 320 MHz transmission, only valid for EHT rates */
+#define IEEE80211_TX_RC_320_MHZ_WIDTH	(IEEE80211_TX_RC_80_MHZ_WIDTH | \
+					 IEEE80211_TX_RC_160_MHZ_WIDTH)
+
 
 /* there are 40 bytes if you don't need the rateset to be kept */
 #define IEEE80211_TX_INFO_DRIVER_DATA_SIZE 40
@@ -1055,6 +1079,19 @@ ieee80211_rate_get_vht_nss(const struct ieee80211_tx_rate *rate)
 	return (rate->idx >> 4) + 1;
 }
 
+static inline bool
+ieee80211_rate_is_he(const struct ieee80211_tx_rate *rate)
+{
+	return (rate->flags & IEEE80211_TX_RC_EHT_MCS) == IEEE80211_TX_RC_HE_MCS;
+}
+
+static inline bool
+ieee80211_rate_is_eht(const struct ieee80211_tx_rate *rate)
+{
+	return (rate->flags & IEEE80211_TX_RC_EHT_MCS) ==
+	       IEEE80211_TX_RC_EHT_MCS;
+}
+
 /**
  * struct ieee80211_tx_info - skb transmit information
  *
@@ -1824,7 +1861,7 @@ struct ieee80211_vif_cfg {
  *	sizeof(void \*).
  * @txq: the multicast data TX queue (if driver uses the TXQ abstraction)
  * @txqs_stopped: per AC flag to indicate that intermediate TXQs are stopped,
- *	protected by fq->lock.
+ *	protected by the lock of the AC's FQ shard.
  * @offload_flags: 802.3 -> 802.11 enapsulation offload flags, see
  *	&enum ieee80211_offload_flags.
  * @mbssid_tx_vif: Pointer to the transmitting interface if MBSSID is enabled.
@@ -2784,6 +2821,11 @@ enum ieee80211_hw_flags {
  * 	The power level at idx 0 shall be the maximum positive power level.
  *
  * @max_txpwr_levels_idx: the maximum valid idx of 'tx_power_levels' list.
+ *
+ * @rxfh_indir_size: number of entries in the RX flow hash indirection table,
+ *	0 if the driver doesn't support configuring RX flow hashing.
+ *
+ * @rxfh_key_size: size of the RX flow hash key in bytes.
  */
 struct ieee80211_hw {
 	struct ieee80211_conf conf;
@@ -2822,6 +2864,8 @@ struct ieee80211_hw {
 	u32 max_mtu;
 	const s8 *tx_power_levels;
 	u8 max_txpwr_levels_idx;
+	u16 rxfh_indir_size;
+	u8 rxfh_key_size;
 };
 
 static inline bool _ieee80211_hw_check(struct ieee80211_hw *hw,
@@ -3915,6 +3959,35 @@ struct ieee80211_prep_tx_info {
  *
  * @get_ringparam: Get tx and rx ring current and maximum sizes.
  *
+ * @set_coalesce: Set the RX interrupt coalescing time in usecs, or let the
+ *	driver adapt it to the RX rate if @adaptive_rx is set, in which case
+ *	@rx_usecs is ignored. This callback may sleep.
+ *
+ * @get_coalesce: Get the RX interrupt coalescing time currently in use and
+ *	whether it is adapted by the driver. This callback may sleep.
+ *
+ * @get_rxfh: Get the RX flow hash indirection table and/or key, either may
+ *	be %NULL. The table has &ieee80211_hw.rxfh_indir_size entries, each
+ *	an RX ring index as reported by @get_rxnfc. This callback may sleep.
+ *
+ * @set_rxfh: Set the RX flow hash indirection table and/or key, either may
+ *	be %NULL to leave it unchanged. This callback may sleep.
+ *
+ * @get_rxnfc: Ethtool API to get the number of RX rings and the packet
+ *	fields used for RX flow hashing. This callback may sleep.
+ *
+ * @set_rxnfc: Ethtool API to set the packet fields used for RX flow hashing.
+ *	This callback may sleep.
+ *
+ * @get_channels: Get the current and maximum number of RX channels.
+ *	This callback may sleep.
+ *
+ * @set_channels: Set the number of RX channels. This callback may sleep.
+ *
+ * @get_ts_info: Get the SOF_TIMESTAMPING_* hardware capabilities and the
+ *	index of the PTP hardware clock that hardware timestamps are taken
+ *	from. Software timestamping capabilities are filled in by mac80211.
+ *
  * @tx_frames_pending: Check if there is any pending frame in the hardware
  *	queues before entering power save.
  *
@@ -4355,6 +4428,21 @@ struct ieee80211_ops {
 	int (*set_ringparam)(struct ieee80211_hw *hw, u32 tx, u32 rx);
 	void (*get_ringparam)(struct ieee80211_hw *hw,
 			      u32 *tx, u32 *tx_max, u32 *rx, u32 *rx_max);
+	int (*set_coalesce)(struct ieee80211_hw *hw, u32 rx_usecs,
+			    bool adaptive_rx);
+	int (*get_coalesce)(struct ieee80211_hw *hw, u32 *rx_usecs,
+			    bool *adaptive_rx);
+	int (*get_rxfh)(struct ieee80211_hw *hw, u32 *indir, u8 *key);
+	int (*set_rxfh)(struct ieee80211_hw *hw, const u32 *indir,
+			const u8 *key);
+	int (*get_rxnfc)(struct ieee80211_hw *hw, struct ethtool_rxnfc *info);
+	int (*set_rxnfc)(struct ieee80211_hw *hw, struct ethtool_rxnfc *info);
+	void (*get_channels)(struct ieee80211_hw *hw,
+			     struct ethtool_channels *ch);
+	int (*set_channels)(struct ieee80211_hw *hw,
+			    struct ethtool_channels *ch);
+	int (*get_ts_info)(struct ieee80211_hw *hw, u32 *so_timestamping,
+			   int *phc_index);
 	bool (*tx_frames_pending)(struct ieee80211_hw *hw);
 	int (*set_bitrate_mask)(struct ieee80211_hw *hw, struct ieee80211_vif *vif,
 				const struct cfg80211_bitrate_mask *mask);
@@ -5052,6 +5140,29 @@ void ieee80211_tx_rate_update(struct ieee80211_hw *hw,
 void ieee80211_tx_status(struct ieee80211_hw *hw,
 			 struct sk_buff *skb);
 
+/**
+ * ieee80211_tx_status_list - transmit status callback for a batch of frames
+ *
+ * Equivalent to calling ieee80211_tx_status() for each frame in @skbs,
+ * but meant for drivers that reclaim many frames for the same station
+ * at once (e.g. on a block-ack). The station is not looked up again for
+ * every frame, and the frames that need no further processing are freed
+ * together once the whole batch was reported.
+ *
+ * The same context and synchronization rules as for ieee80211_tx_status()
+ * apply. If @pubsta is given, the caller must hold the RCU read lock or
+ * otherwise guarantee the station stays valid across the call.
+ *
+ * @hw: the hardware the frames were transmitted by
+ * @pubsta: the station all frames were transmitted to, or %NULL to look
+ *	up the station for each frame
+ * @skbs: the frames that were transmitted; the queue is emptied and the
+ *	frames are owned by mac80211 after this call
+ */
+void ieee80211_tx_status_list(struct ieee80211_hw *hw,
+			      struct ieee80211_sta *pubsta,
+			      struct sk_buff_head *skbs);
+
 /**
  * ieee80211_tx_status_ext - extended transmit status callback
  *
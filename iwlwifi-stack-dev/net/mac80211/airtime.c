@@ -59,6 +59,7 @@
 #define BW_40			1
 #define BW_80			2
 #define BW_160			3
+#define BW_320			4
 
 /*
  * Define group sort order: HT40 -> SGI -> #streams
@@ -68,17 +69,22 @@
 #define IEEE80211_VHT_STREAM_GROUPS	8 /* BW(=4) * SGI(=2) */
 
 #define IEEE80211_HE_MAX_STREAMS	8
+#define IEEE80211_HE_STREAM_GROUPS	12 /* BW(=4) * GI(=3) */
+#define IEEE80211_EHT_STREAM_GROUPS	15 /* BW(=5) * GI(=3) */
 
 #define IEEE80211_HT_GROUPS_NB	(IEEE80211_MAX_STREAMS *	\
 				 IEEE80211_HT_STREAM_GROUPS)
 #define IEEE80211_VHT_GROUPS_NB	(IEEE80211_MAX_STREAMS *	\
 					 IEEE80211_VHT_STREAM_GROUPS)
+#define IEEE80211_HE_GROUPS_NB	(IEEE80211_HE_MAX_STREAMS *	\
+				 IEEE80211_HE_STREAM_GROUPS)
 
 #define IEEE80211_HT_GROUP_0	0
 #define IEEE80211_VHT_GROUP_0	(IEEE80211_HT_GROUP_0 + IEEE80211_HT_GROUPS_NB)
 #define IEEE80211_HE_GROUP_0	(IEEE80211_VHT_GROUP_0 + IEEE80211_VHT_GROUPS_NB)
+#define IEEE80211_EHT_GROUP_0	(IEEE80211_HE_GROUP_0 + IEEE80211_HE_GROUPS_NB)
 
-#define MCS_GROUP_RATES		12
+#define MCS_GROUP_RATES		14
 
 #define HT_GROUP_IDX(_streams, _sgi, _ht40)	\
 	IEEE80211_HT_GROUP_0 +			\
@@ -203,6 +209,58 @@
 #define HE_GROUP(_streams, _gi, _bw)					\
 	__HE_GROUP(_streams, _gi, _bw,				\
 		   HE_GROUP_SHIFT(_streams, _gi, _bw))
+
+#define EHT_GROUP_IDX(_streams, _gi, _bw)				\
+	(IEEE80211_EHT_GROUP_0 +					\
+	 IEEE80211_HE_MAX_STREAMS * 3 * (_bw) +			\
+	 IEEE80211_HE_MAX_STREAMS * (_gi) +				\
+	 (_streams) - 1)
+
+#define BW2VBPS_EHT(_bw, r5, r4, r3, r2, r1)				\
+	(_bw == BW_320 ? r5 : BW2VBPS(_bw, r4, r3, r2, r1))
+
+#define __EHT_GROUP(_streams, _gi, _bw, _s)				\
+	[EHT_GROUP_IDX(_streams, _gi, _bw)] = {			\
+	.shift = _s,							\
+	.duration = {							\
+		HE_DURATION_S(_s, _streams, _gi,			\
+			      BW2VBPS_EHT(_bw,  1960,   980,  490,  234,  117)), \
+		HE_DURATION_S(_s, _streams, _gi,			\
+			      BW2VBPS_EHT(_bw,  3920,  1960,  980,  468,  234)), \
+		HE_DURATION_S(_s, _streams, _gi,			\
+			      BW2VBPS_EHT(_bw,  5880,  2940, 1470,  702,  351)), \
+		HE_DURATION_S(_s, _streams, _gi,			\
+			      BW2VBPS_EHT(_bw,  7840,  3920, 1960,  936,  468)), \
+		HE_DURATION_S(_s, _streams, _gi,			\
+			      BW2VBPS_EHT(_bw, 11760,  5880, 2940, 1404,  702)), \
+		HE_DURATION_S(_s, _streams, _gi,			\
+			      BW2VBPS_EHT(_bw, 15680,  7840, 3920, 1872,  936)), \
+		HE_DURATION_S(_s, _streams, _gi,			\
+			      BW2VBPS_EHT(_bw, 17640,  8820, 4410, 2106, 1053)), \
+		HE_DURATION_S(_s, _streams, _gi,			\
+			      BW2VBPS_EHT(_bw, 19600,  9800, 4900, 2340, 1170)), \
+		HE_DURATION_S(_s, _streams, _gi,			\
+			      BW2VBPS_EHT(_bw, 23520, 11760, 5880, 2808, 1404)), \
+		HE_DURATION_S(_s, _streams, _gi,			\
+			      BW2VBPS_EHT(_bw, 26133, 13066, 6533, 3120, 1560)), \
+		HE_DURATION_S(_s, _streams, _gi,			\
+			      BW2VBPS_EHT(_bw, 29400, 14700, 7350, 3510, 1755)), \
+		HE_DURATION_S(_s, _streams, _gi,			\
+			      BW2VBPS_EHT(_bw, 32666, 16333, 8166, 3900, 1950)), \
+		HE_DURATION_S(_s, _streams, _gi,			\
+			      BW2VBPS_EHT(_bw, 35280, 17640, 8820, 4212, 2106)), \
+		HE_DURATION_S(_s, _streams, _gi,			\
+			      BW2VBPS_EHT(_bw, 39200, 19600, 9800, 4680, 2340))  \
+        }								\
+}
+
+#define EHT_GROUP_SHIFT(_streams, _gi, _bw)				\
+	GROUP_SHIFT(HE_DURATION(_streams, _gi,			\
+				BW2VBPS_EHT(_bw, 1960, 980, 490, 234, 117)))
+
+#define EHT_GROUP(_streams, _gi, _bw)					\
+	__EHT_GROUP(_streams, _gi, _bw,				\
+		    EHT_GROUP_SHIFT(_streams, _gi, _bw))
 struct mcs_group {
 	u8 shift;
 	u16 duration[MCS_GROUP_RATES];
@@ -376,6 +434,141 @@ static const struct mcs_group airtime_mcs_groups[] = {
 	HE_GROUP(6, HE_GI_32, BW_160),
 	HE_GROUP(7, HE_GI_32, BW_160),
 	HE_GROUP(8, HE_GI_32, BW_160),
+
+	EHT_GROUP(1, HE_GI_08, BW_20),
+	EHT_GROUP(2, HE_GI_08, BW_20),
+	EHT_GROUP(3, HE_GI_08, BW_20),
+	EHT_GROUP(4, HE_GI_08, BW_20),
+	EHT_GROUP(5, HE_GI_08, BW_20),
+	EHT_GROUP(6, HE_GI_08, BW_20),
+	EHT_GROUP(7, HE_GI_08, BW_20),
+	EHT_GROUP(8, HE_GI_08, BW_20),
+
+	EHT_GROUP(1, HE_GI_16, BW_20),
+	EHT_GROUP(2, HE_GI_16, BW_20),
+	EHT_GROUP(3, HE_GI_16, BW_20),
+	EHT_GROUP(4, HE_GI_16, BW_20),
+	EHT_GROUP(5, HE_GI_16, BW_20),
+	EHT_GROUP(6, HE_GI_16, BW_20),
+	EHT_GROUP(7, HE_GI_16, BW_20),
+	EHT_GROUP(8, HE_GI_16, BW_20),
+
+	EHT_GROUP(1, HE_GI_32, BW_20),
+	EHT_GROUP(2, HE_GI_32, BW_20),
+	EHT_GROUP(3, HE_GI_32, BW_20),
+	EHT_GROUP(4, HE_GI_32, BW_20),
+	EHT_GROUP(5, HE_GI_32, BW_20),
+	EHT_GROUP(6, HE_GI_32, BW_20),
+	EHT_GROUP(7, HE_GI_32, BW_20),
+	EHT_GROUP(8, HE_GI_32, BW_20),
+
+	EHT_GROUP(1, HE_GI_08, BW_40),
+	EHT_GROUP(2, HE_GI_08, BW_40),
+	EHT_GROUP(3, HE_GI_08, BW_40),
+	EHT_GROUP(4, HE_GI_08, BW_40),
+	EHT_GROUP(5, HE_GI_08, BW_40),
+	EHT_GROUP(6, HE_GI_08, BW_40),
+	EHT_GROUP(7, HE_GI_08, BW_40),
+	EHT_GROUP(8, HE_GI_08, BW_40),
+
+	EHT_GROUP(1, HE_GI_16, BW_40),
+	EHT_GROUP(2, HE_GI_16, BW_40),
+	EHT_GROUP(3, HE_GI_16, BW_40),
+	EHT_GROUP(4, HE_GI_16, BW_40),
+	EHT_GROUP(5, HE_GI_16, BW_40),
+	EHT_GROUP(6, HE_GI_16, BW_40),
+	EHT_GROUP(7, HE_GI_16, BW_40),
+	EHT_GROUP(8, HE_GI_16, BW_40),
+
+	EHT_GROUP(1, HE_GI_32, BW_40),
+	EHT_GROUP(2, HE_GI_32, BW_40),
+	EHT_GROUP(3, HE_GI_32, BW_40),
+	EHT_GROUP(4, HE_GI_32, BW_40),
+	EHT_GROUP(5, HE_GI_32, BW_40),
+	EHT_GROUP(6, HE_GI_32, BW_40),
+	EHT_GROUP(7, HE_GI_32, BW_40),
+	EHT_GROUP(8, HE_GI_32, BW_40),
+
+	EHT_GROUP(1, HE_GI_08, BW_80),
+	EHT_GROUP(2, HE_GI_08, BW_80),
+	EHT_GROUP(3, HE_GI_08, BW_80),
+	EHT_GROUP(4, HE_GI_08, BW_80),
+	EHT_GROUP(5, HE_GI_08, BW_80),
+	EHT_GROUP(6, HE_GI_08, BW_80),
+	EHT_GROUP(7, HE_GI_08, BW_80),
+	EHT_GROUP(8, HE_GI_08, BW_80),
+
+	EHT_GROUP(1, HE_GI_16, BW_80),
+	EHT_GROUP(2, HE_GI_16, BW_80),
+	EHT_GROUP(3, HE_GI_16, BW_80),
+	EHT_GROUP(4, HE_GI_16, BW_80),
+	EHT_GROUP(5, HE_GI_16, BW_80),
+	EHT_GROUP(6, HE_GI_16, BW_80),
+	EHT_GROUP(7, HE_GI_16, BW_80),
+	EHT_GROUP(8, HE_GI_16, BW_80),
+
+	EHT_GROUP(1, HE_GI_32, BW_80),
+	EHT_GROUP(2, HE_GI_32, BW_80),
+	EHT_GROUP(3, HE_GI_32, BW_80),
+	EHT_GROUP(4, HE_GI_32, BW_80),
+	EHT_GROUP(5, HE_GI_32, BW_80),
+	EHT_GROUP(6, HE_GI_32, BW_80),
+	EHT_GROUP(7, HE_GI_32, BW_80),
+	EHT_GROUP(8, HE_GI_32, BW_80),
+
+	EHT_GROUP(1, HE_GI_08, BW_160),
+	EHT_GROUP(2, HE_GI_08, BW_160),
+	EHT_GROUP(3, HE_GI_08, BW_160),
+	EHT_GROUP(4, HE_GI_08, BW_160),
+	EHT_GROUP(5, HE_GI_08, BW_160),
+	EHT_GROUP(6, HE_GI_08, BW_160),
+	EHT_GROUP(7, HE_GI_08, BW_160),
+	EHT_GROUP(8, HE_GI_08, BW_160),
+
+	EHT_GROUP(1, HE_GI_16, BW_160),
+	EHT_GROUP(2, HE_GI_16, BW_160),
+	EHT_GROUP(3, HE_GI_16, BW_160),
+	EHT_GROUP(4, HE_GI_16, BW_160),
+	EHT_GROUP(5, HE_GI_16, BW_160),
+	EHT_GROUP(6, HE_GI_16, BW_160),
+	EHT_GROUP(7, HE_GI_16, BW_160),
+	EHT_GROUP(8, HE_GI_16, BW_160),
+
+	EHT_GROUP(1, HE_GI_32, BW_160),
+	EHT_GROUP(2, HE_GI_32, BW_160),
+	EHT_GROUP(3, HE_GI_32, BW_160),
+	EHT_GROUP(4, HE_GI_32, BW_160),
+	EHT_GROUP(5, HE_GI_32, BW_160),
+	EHT_GROUP(6, HE_GI_32, BW_160),
+	EHT_GROUP(7, HE_GI_32, BW_160),
+	EHT_GROUP(8, HE_GI_32, BW_160),
+
+	EHT_GROUP(1, HE_GI_08, BW_320),
+	EHT_GROUP(2, HE_GI_08, BW_320),
+	EHT_GROUP(3, HE_GI_08, BW_320),
+	EHT_GROUP(4, HE_GI_08, BW_320),
+	EHT_GROUP(5, HE_GI_08, BW_320),
+	EHT_GROUP(6, HE_GI_08, BW_320),
+	EHT_GROUP(7, HE_GI_08, BW_320),
+	EHT_GROUP(8, HE_GI_08, BW_320),
+
+	EHT_GROUP(1, HE_GI_16, BW_320),
+	EHT_GROUP(2, HE_GI_16, BW_320),
+	EHT_GROUP(3, HE_GI_16, BW_320),
+	EHT_GROUP(4, HE_GI_16, BW_320),
+	EHT_GROUP(5, HE_GI_16, BW_320),
+	EHT_GROUP(6, HE_GI_16, BW_320),
+	EHT_GROUP(7, HE_GI_16, BW_320),
+	EHT_GROUP(8, HE_GI_16, BW_320),
+
+	EHT_GROUP(1, HE_GI_32, BW_320),
+	EHT_GROUP(2, HE_GI_32, BW_320),
+	EHT_GROUP(3, HE_GI_32, BW_320),
+	EHT_GROUP(4, HE_GI_32, BW_320),
+	EHT_GROUP(5, HE_GI_32, BW_320),
+	EHT_GROUP(6, HE_GI_32, BW_320),
+	EHT_GROUP(7, HE_GI_32, BW_320),
+	EHT_GROUP(8, HE_GI_32, BW_320),
 };
 
 static u32
@@ -422,6 +615,11 @@ static u32 ieee80211_get_rate_duration(struct ieee80211_hw *hw,
 	case RATE_INFO_BW_160:
 		bw = BW_160;
 		break;
+	case RATE_INFO_BW_320:
+		if (WARN_ON_ONCE(status->encoding != RX_ENC_EHT))
+			return 0;
+		bw = BW_320;
+		break;
 	default:
 		WARN_ON_ONCE(1);
 		return 0;
@@ -443,17 +641,28 @@ static u32 ieee80211_get_rate_duration(struct ieee80211_hw *hw,
 		idx = status->rate_idx;
 		group = HE_GROUP_IDX(streams, status->he_gi, bw);
 		break;
+	case RX_ENC_EHT:
+		streams = status->nss;
+		idx = status->rate_idx;
+		group = EHT_GROUP_IDX(streams, status->eht.gi, bw);
+		break;
 	default:
 		WARN_ON_ONCE(1);
 		return 0;
 	}
 
-	if (WARN_ON_ONCE((status->encoding != RX_ENC_HE && streams > 4) ||
-			 (status->encoding == RX_ENC_HE && streams > 8)))
+	if (WARN_ON_ONCE((status->encoding != RX_ENC_HE &&
+			  status->encoding != RX_ENC_EHT && streams > 4) ||
+			 streams > IEEE80211_HE_MAX_STREAMS))
 		return 0;
 
 	duration = airtime_mcs_groups[group].duration[idx];
 	duration <<= airtime_mcs_groups[group].shift;
+
+	/* DCM halves the data rate */
+	if (status->encoding == RX_ENC_HE && status->he_dcm)
+		duration <<= 1;
+
 	*overhead = 36 + (streams << 2);
 
 	return duration;
@@ -514,7 +723,9 @@ static bool ieee80211_fill_rate_info(struct ieee80211_hw *hw,
 	stat->nss = ri->nss;
 	stat->rate_idx = ri->mcs;
 
-	if (ri->flags & RATE_INFO_FLAGS_HE_MCS)
+	if (ri->flags & RATE_INFO_FLAGS_EHT_MCS)
+		stat->encoding = RX_ENC_EHT;
+	else if (ri->flags & RATE_INFO_FLAGS_HE_MCS)
 		stat->encoding = RX_ENC_HE;
 	else if (ri->flags & RATE_INFO_FLAGS_VHT_MCS)
 		stat->encoding = RX_ENC_VHT;
@@ -526,7 +737,12 @@ static bool ieee80211_fill_rate_info(struct ieee80211_hw *hw,
 	if (ri->flags & RATE_INFO_FLAGS_SHORT_GI)
 		stat->enc_flags |= RX_ENC_FLAG_SHORT_GI;
 
-	stat->he_gi = ri->he_gi;
+	if (stat->encoding == RX_ENC_EHT) {
+		stat->eht.gi = ri->eht_gi;
+	} else {
+		stat->he_gi = ri->he_gi;
+		stat->he_dcm = ri->he_dcm;
+	}
 
 	if (stat->encoding != RX_ENC_LEGACY)
 		return true;
@@ -557,7 +773,11 @@ static int ieee80211_fill_rx_status(struct ieee80211_rx_status *stat,
 	if (rate->idx < 0 || !rate->count)
 		return -1;
 
-	if (rate->flags & IEEE80211_TX_RC_160_MHZ_WIDTH)
+	if (ieee80211_rate_is_eht(rate) &&
+	    (rate->flags & IEEE80211_TX_RC_320_MHZ_WIDTH) ==
+	    IEEE80211_TX_RC_320_MHZ_WIDTH)
+		stat->bw = RATE_INFO_BW_320;
+	else if (rate->flags & IEEE80211_TX_RC_160_MHZ_WIDTH)
 		stat->bw = RATE_INFO_BW_160;
 	else if (rate->flags & IEEE80211_TX_RC_80_MHZ_WIDTH)
 		stat->bw = RATE_INFO_BW_80;
@@ -573,7 +793,24 @@ static int ieee80211_fill_rx_status(struct ieee80211_rx_status *stat,
 		stat->enc_flags |= RX_ENC_FLAG_SHORT_GI;
 
 	stat->rate_idx = rate->idx;
-	if (rate->flags & IEEE80211_TX_RC_VHT_MCS) {
+	if (ieee80211_rate_is_eht(rate)) {
+		stat->encoding = RX_ENC_EHT;
+		stat->enc_flags = 0;
+		stat->rate_idx = ieee80211_rate_get_vht_mcs(rate);
+		stat->nss = ieee80211_rate_get_vht_nss(rate);
+		stat->eht.gi = rate->flags & IEEE80211_TX_RC_SHORT_GI ?
+			       NL80211_RATE_INFO_EHT_GI_0_8 :
+			       NL80211_RATE_INFO_EHT_GI_1_6;
+	} else if (ieee80211_rate_is_he(rate)) {
+		stat->encoding = RX_ENC_HE;
+		stat->enc_flags = 0;
+		stat->rate_idx = ieee80211_rate_get_vht_mcs(rate);
+		stat->nss = ieee80211_rate_get_vht_nss(rate);
+		stat->he_gi = rate->flags & IEEE80211_TX_RC_SHORT_GI ?
+			      NL80211_RATE_INFO_HE_GI_0_8 :
+			      NL80211_RATE_INFO_HE_GI_1_6;
+		stat->he_dcm = !!(rate->flags & IEEE80211_TX_RC_HE_DCM);
+	} else if (rate->flags & IEEE80211_TX_RC_VHT_MCS) {
 		stat->encoding = RX_ENC_VHT;
 		stat->rate_idx = ieee80211_rate_get_vht_mcs(rate);
 		stat->nss = ieee80211_rate_get_vht_nss(rate);
@@ -675,7 +912,8 @@ u32 ieee80211_calc_expected_tx_airtime(struct ieee80211_hw *hw,
 			agg_shift = 3;
 		else if (duration > 70 * 1024) /* <= VHT20 MCS5 2S */
 			agg_shift = 4;
-		else if (stat.encoding != RX_ENC_HE ||
+		else if ((stat.encoding != RX_ENC_HE &&
+			  stat.encoding != RX_ENC_EHT) ||
 			 duration > 20 * 1024) /* <= HE40 MCS6 2S */
 			agg_shift = 5;
 		else
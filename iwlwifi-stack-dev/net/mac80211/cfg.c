@@ -819,6 +819,21 @@ void sta_set_rate_info_tx(struct sta_info *sta,
 	if (rate->flags & IEEE80211_TX_RC_MCS) {
 		rinfo->flags |= RATE_INFO_FLAGS_MCS;
 		rinfo->mcs = rate->idx;
+	} else if (ieee80211_rate_is_eht(rate)) {
+		rinfo->flags |= RATE_INFO_FLAGS_EHT_MCS;
+		rinfo->mcs = ieee80211_rate_get_vht_mcs(rate);
+		rinfo->nss = ieee80211_rate_get_vht_nss(rate);
+		rinfo->eht_gi = rate->flags & IEEE80211_TX_RC_SHORT_GI ?
+				NL80211_RATE_INFO_EHT_GI_0_8 :
+				NL80211_RATE_INFO_EHT_GI_1_6;
+	} else if (ieee80211_rate_is_he(rate)) {
+		rinfo->flags |= RATE_INFO_FLAGS_HE_MCS;
+		rinfo->mcs = ieee80211_rate_get_vht_mcs(rate);
+		rinfo->nss = ieee80211_rate_get_vht_nss(rate);
+		rinfo->he_gi = rate->flags & IEEE80211_TX_RC_SHORT_GI ?
+			       NL80211_RATE_INFO_HE_GI_0_8 :
+			       NL80211_RATE_INFO_HE_GI_1_6;
+		rinfo->he_dcm = !!(rate->flags & IEEE80211_TX_RC_HE_DCM);
 	} else if (rate->flags & IEEE80211_TX_RC_VHT_MCS) {
 		rinfo->flags |= RATE_INFO_FLAGS_VHT_MCS;
 		rinfo->mcs = ieee80211_rate_get_vht_mcs(rate);
@@ -835,7 +850,11 @@ void sta_set_rate_info_tx(struct sta_info *sta,
 			rinfo->legacy = DIV_ROUND_UP(brate, 1 << shift);
 		}
 	}
-	if (rate->flags & IEEE80211_TX_RC_40_MHZ_WIDTH)
+	if (ieee80211_rate_is_eht(rate) &&
+	    (rate->flags & IEEE80211_TX_RC_320_MHZ_WIDTH) ==
+	    IEEE80211_TX_RC_320_MHZ_WIDTH)
+		rinfo->bw = RATE_INFO_BW_320;
+	else if (rate->flags & IEEE80211_TX_RC_40_MHZ_WIDTH)
 		rinfo->bw = RATE_INFO_BW_40;
 	else if (rate->flags & IEEE80211_TX_RC_80_MHZ_WIDTH)
 		rinfo->bw = RATE_INFO_BW_80;
@@ -843,7 +862,8 @@ void sta_set_rate_info_tx(struct sta_info *sta,
 		rinfo->bw = RATE_INFO_BW_160;
 	else
 		rinfo->bw = RATE_INFO_BW_20;
-	if (rate->flags & IEEE80211_TX_RC_SHORT_GI)
+	if (rate->flags & IEEE80211_TX_RC_SHORT_GI &&
+	    !(rinfo->flags & (RATE_INFO_FLAGS_HE_MCS | RATE_INFO_FLAGS_EHT_MCS)))
 		rinfo->flags |= RATE_INFO_FLAGS_SHORT_GI;
 }
 
@@ -4335,12 +4355,12 @@ static int ieee80211_get_txq_stats(struct wiphy *wiphy,
 {
 	struct ieee80211_local *local = wiphy_priv(wiphy);
 	struct ieee80211_sub_if_data *sdata;
+	struct txq_info *txqi;
 	int ret = 0;
 
 	if (!local->ops->wake_tx_queue)
 		return 1;
 
-	spin_lock_bh(&local->fq.lock);
 	rcu_read_lock();
 
 	if (wdev) {
@@ -4349,7 +4369,10 @@ static int ieee80211_get_txq_stats(struct wiphy *wiphy,
 			ret = 1;
 			goto out;
 		}
-		ieee80211_fill_txq_stats(txqstats, to_txq_info(sdata->vif.txq));
+		txqi = to_txq_info(sdata->vif.txq);
+		fq_shard_lock_bh(txqi->tin.shard);
+		ieee80211_fill_txq_stats(txqstats, txqi);
+		fq_shard_unlock_bh(txqi->tin.shard);
 	} else {
 		/* phy stats */
 		txqstats->filled |= BIT(NL80211_TXQ_STATS_BACKLOG_PACKETS) |
@@ -4358,17 +4381,16 @@ static int ieee80211_get_txq_stats(struct wiphy *wiphy,
 				    BIT(NL80211_TXQ_STATS_OVERMEMORY) |
 				    BIT(NL80211_TXQ_STATS_COLLISIONS) |
 				    BIT(NL80211_TXQ_STATS_MAX_FLOWS);
-		txqstats->backlog_packets = local->fq.backlog;
-		txqstats->backlog_bytes = local->fq.memory_usage;
-		txqstats->overlimit = local->fq.overlimit;
-		txqstats->overmemory = local->fq.overmemory;
-		txqstats->collisions = local->fq.collisions;
+		txqstats->backlog_packets = atomic_read(&local->fq.backlog);
+		txqstats->backlog_bytes = atomic_read(&local->fq.memory_usage);
+		txqstats->overlimit = atomic_read(&local->fq.overlimit);
+		txqstats->overmemory = atomic_read(&local->fq.overmemory);
+		txqstats->collisions = atomic_read(&local->fq.collisions);
 		txqstats->max_flows = local->fq.flows_cnt;
 	}
 
 out:
 	rcu_read_unlock();
-	spin_unlock_bh(&local->fq.lock);
 
 	return ret;
 }
@@ -79,10 +79,10 @@ static ssize_t aqm_read(struct file *file,
 {
 	struct ieee80211_local *local = file->private_data;
 	struct fq *fq = &local->fq;
-	char buf[200];
+	char buf[600];
 	int len = 0;
+	int i;
 
-	spin_lock_bh(&local->fq.lock);
 	rcu_read_lock();
 
 	len = scnprintf(buf, sizeof(buf),
@@ -97,17 +97,23 @@ static ssize_t aqm_read(struct file *file,
 			"RW fq_limit %u\n"
 			"RW fq_quantum %u\n",
 			fq->flows_cnt,
-			fq->backlog,
-			fq->overmemory,
-			fq->overlimit,
-			fq->collisions,
-			fq->memory_usage,
+			atomic_read(&fq->backlog),
+			atomic_read(&fq->overmemory),
+			atomic_read(&fq->overlimit),
+			atomic_read(&fq->collisions),
+			atomic_read(&fq->memory_usage),
 			fq->memory_limit,
 			fq->limit,
 			fq->quantum);
 
+	for (i = 0; i < fq->shards_cnt; i++)
+		len += scnprintf(buf + len, sizeof(buf) - len,
+				 "R fq_shard%d_lock_acquired %lu\n"
+				 "R fq_shard%d_lock_contended %lu\n",
+				 i, READ_ONCE(fq->shards[i].lock_acquired),
+				 i, READ_ONCE(fq->shards[i].lock_contended));
+
 	rcu_read_unlock();
-	spin_unlock_bh(&local->fq.lock);
 
 	return simple_read_from_buffer(user_buf, count, ppos,
 				       buf, len);
@@ -477,7 +477,6 @@ IEEE80211_IF_FILE_R(num_buffered_multicast);
 static ssize_t ieee80211_if_fmt_aqm(
 	const struct ieee80211_sub_if_data *sdata, char *buf, int buflen)
 {
-	struct ieee80211_local *local = sdata->local;
 	struct txq_info *txqi;
 	int len;
 
@@ -486,7 +485,7 @@ static ssize_t ieee80211_if_fmt_aqm(
 
 	txqi = to_txq_info(sdata->vif.txq);
 
-	spin_lock_bh(&local->fq.lock);
+	fq_shard_lock_bh(txqi->tin.shard);
 	rcu_read_lock();
 
 	len = scnprintf(buf,
@@ -505,7 +504,7 @@ static ssize_t ieee80211_if_fmt_aqm(
 			txqi->tin.tx_packets);
 
 	rcu_read_unlock();
-	spin_unlock_bh(&local->fq.lock);
+	fq_shard_unlock_bh(txqi->tin.shard);
 
 	return len;
 }
@@ -575,9 +574,53 @@ IEEE80211_IF_FILE_RW(tsf);
 #ifdef CPTCFG_MAC80211_MESH
 IEEE80211_IF_FILE(estab_plinks, u.mesh.estab_plinks, ATOMIC);
 
+static ssize_t ieee80211_if_fmt_preq_max_targets(
+	const struct ieee80211_sub_if_data *sdata, char *buf, int buflen)
+{
+	return snprintf(buf, buflen, "%u\n", sdata->u.mesh.preq_max_targets);
+}
+
+static ssize_t ieee80211_if_parse_preq_max_targets(
+	struct ieee80211_sub_if_data *sdata, const char *buf, int buflen)
+{
+	u8 val;
+	int ret;
+
+	ret = kstrtou8(buf, 0, &val);
+	if (ret)
+		return -EINVAL;
+
+	if (val < 1 || val > MESH_PREQ_MAX_TARGETS)
+		return -ERANGE;
+
+	sdata->u.mesh.preq_max_targets = val;
+
+	return buflen;
+}
+IEEE80211_IF_FILE_RW(preq_max_targets);
+
 /* Mesh stats attributes */
 IEEE80211_IF_FILE(fwded_mcast, u.mesh.mshstats.fwded_mcast, DEC);
 IEEE80211_IF_FILE(fwded_unicast, u.mesh.mshstats.fwded_unicast, DEC);
+
+static ssize_t ieee80211_if_fmt_discovery_latency(
+	const struct ieee80211_sub_if_data *sdata, char *buf, int buflen)
+{
+	const struct mesh_stats *stats = &sdata->u.mesh.mshstats;
+	char *p = buf;
+	int i;
+
+	for (i = 0; i < MESH_DISC_LAT_BUCKETS - 1; i++)
+		p += scnprintf(p, buflen + buf - p, "<%ums: %u\n",
+			       MESH_DISC_LAT_BOUND_MS(i),
+			       stats->discovery_latency[i]);
+	p += scnprintf(p, buflen + buf - p, ">=%ums: %u\n",
+		       MESH_DISC_LAT_BOUND_MS(i),
+		       stats->discovery_latency[i]);
+
+	return p - buf;
+}
+IEEE80211_IF_FILE_R(discovery_latency);
 IEEE80211_IF_FILE(fwded_frames, u.mesh.mshstats.fwded_frames, DEC);
 IEEE80211_IF_FILE(dropped_frames_ttl, u.mesh.mshstats.dropped_frames_ttl, DEC);
 IEEE80211_IF_FILE(dropped_frames_congestion,
@@ -702,6 +745,7 @@ static void add_mesh_files(struct ieee80211_sub_if_data *sdata)
 {
 	DEBUGFS_ADD_MODE(tsf, 0600);
 	DEBUGFS_ADD_MODE(estab_plinks, 0400);
+	DEBUGFS_ADD_MODE(preq_max_targets, 0600);
 }
 
 static void add_mesh_stats(struct ieee80211_sub_if_data *sdata)
@@ -717,6 +761,7 @@ static void add_mesh_stats(struct ieee80211_sub_if_data *sdata)
 	MESHSTATS_ADD(dropped_frames_ttl);
 	MESHSTATS_ADD(dropped_frames_no_route);
 	MESHSTATS_ADD(dropped_frames_congestion);
+	MESHSTATS_ADD(discovery_latency);
 #undef MESHSTATS_ADD
 }
 
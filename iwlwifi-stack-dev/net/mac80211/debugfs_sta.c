@@ -139,7 +139,6 @@ static ssize_t sta_aqm_read(struct file *file, char __user *userbuf,
 			size_t count, loff_t *ppos)
 {
 	struct sta_info *sta = file->private_data;
-	struct ieee80211_local *local = sta->local;
 	size_t bufsz = AQM_TXQ_ENTRY_LEN * (IEEE80211_NUM_TIDS + 2);
 	char *buf = kzalloc(bufsz, GFP_KERNEL), *p = buf;
 	struct txq_info *txqi;
@@ -149,7 +148,6 @@ static ssize_t sta_aqm_read(struct file *file, char __user *userbuf,
 	if (!buf)
 		return -ENOMEM;
 
-	spin_lock_bh(&local->fq.lock);
 	rcu_read_lock();
 
 	p += scnprintf(p,
@@ -166,6 +164,7 @@ static ssize_t sta_aqm_read(struct file *file, char __user *userbuf,
 		if (!sta->sta.txq[i])
 			continue;
 		txqi = to_txq_info(sta->sta.txq[i]);
+		fq_shard_lock_bh(txqi->tin.shard);
 		p += scnprintf(p, bufsz + buf - p,
 			       "%d %d %u %u %u %u %u %u %u %u %u 0x%lx(%s%s%s)\n",
 			       txqi->txq.tid,
@@ -183,10 +182,10 @@ static ssize_t sta_aqm_read(struct file *file, char __user *userbuf,
 			       test_bit(IEEE80211_TXQ_STOP, &txqi->flags) ? "STOP" : "RUN",
 			       test_bit(IEEE80211_TXQ_AMPDU, &txqi->flags) ? " AMPDU" : "",
 			       test_bit(IEEE80211_TXQ_NO_AMSDU, &txqi->flags) ? " NO-AMSDU" : "");
+		fq_shard_unlock_bh(txqi->tin.shard);
 	}
 
 	rcu_read_unlock();
-	spin_unlock_bh(&local->fq.lock);
 
 	rv = simple_read_from_buffer(userbuf, count, ppos, buf, p - buf);
 	kfree(buf);
@@ -710,6 +710,138 @@ static inline void drv_get_ringparam(struct ieee80211_local *local,
 	trace_drv_return_void(local);
 }
 
+static inline int drv_set_coalesce(struct ieee80211_local *local,
+				   u32 rx_usecs, bool adaptive_rx)
+{
+	int ret = -EOPNOTSUPP;
+
+	might_sleep();
+
+	trace_drv_set_coalesce(local, rx_usecs, adaptive_rx);
+	if (local->ops->set_coalesce)
+		ret = local->ops->set_coalesce(&local->hw, rx_usecs,
+					       adaptive_rx);
+	trace_drv_return_int(local, ret);
+
+	return ret;
+}
+
+static inline int drv_get_coalesce(struct ieee80211_local *local,
+				   u32 *rx_usecs, bool *adaptive_rx)
+{
+	int ret = -EOPNOTSUPP;
+
+	might_sleep();
+
+	trace_drv_get_coalesce(local);
+	if (local->ops->get_coalesce)
+		ret = local->ops->get_coalesce(&local->hw, rx_usecs,
+					       adaptive_rx);
+	trace_drv_return_int(local, ret);
+
+	return ret;
+}
+
+static inline int drv_get_rxfh(struct ieee80211_local *local,
+			       u32 *indir, u8 *key)
+{
+	int ret = -EOPNOTSUPP;
+
+	might_sleep();
+
+	trace_drv_get_rxfh(local);
+	if (local->ops->get_rxfh)
+		ret = local->ops->get_rxfh(&local->hw, indir, key);
+	trace_drv_return_int(local, ret);
+
+	return ret;
+}
+
+static inline int drv_set_rxfh(struct ieee80211_local *local,
+			       const u32 *indir, const u8 *key)
+{
+	int ret = -EOPNOTSUPP;
+
+	might_sleep();
+
+	trace_drv_set_rxfh(local);
+	if (local->ops->set_rxfh)
+		ret = local->ops->set_rxfh(&local->hw, indir, key);
+	trace_drv_return_int(local, ret);
+
+	return ret;
+}
+
+static inline int drv_get_rxnfc(struct ieee80211_local *local,
+				struct ethtool_rxnfc *info)
+{
+	int ret = -EOPNOTSUPP;
+
+	might_sleep();
+
+	trace_drv_get_rxnfc(local);
+	if (local->ops->get_rxnfc)
+		ret = local->ops->get_rxnfc(&local->hw, info);
+	trace_drv_return_int(local, ret);
+
+	return ret;
+}
+
+static inline int drv_set_rxnfc(struct ieee80211_local *local,
+				struct ethtool_rxnfc *info)
+{
+	int ret = -EOPNOTSUPP;
+
+	might_sleep();
+
+	trace_drv_set_rxnfc(local);
+	if (local->ops->set_rxnfc)
+		ret = local->ops->set_rxnfc(&local->hw, info);
+	trace_drv_return_int(local, ret);
+
+	return ret;
+}
+
+static inline void drv_get_channels(struct ieee80211_local *local,
+				    struct ethtool_channels *ch)
+{
+	might_sleep();
+
+	trace_drv_get_channels(local);
+	if (local->ops->get_channels)
+		local->ops->get_channels(&local->hw, ch);
+	trace_drv_return_void(local);
+}
+
+static inline int drv_set_channels(struct ieee80211_local *local,
+				   struct ethtool_channels *ch)
+{
+	int ret = -EOPNOTSUPP;
+
+	might_sleep();
+
+	trace_drv_set_channels(local);
+	if (local->ops->set_channels)
+		ret = local->ops->set_channels(&local->hw, ch);
+	trace_drv_return_int(local, ret);
+
+	return ret;
+}
+
+static inline int drv_get_ts_info(struct ieee80211_local *local,
+				  u32 *so_timestamping, int *phc_index)
+{
+	int ret = -EOPNOTSUPP;
+
+	trace_drv_get_ts_info(local);
+	if (local->ops->get_ts_info)
+		ret = local->ops->get_ts_info(&local->hw, so_timestamping,
+					      phc_index);
+	trace_drv_return_int(local, ret);
+
+	return ret;
+}
+
 static inline bool drv_tx_frames_pending(struct ieee80211_local *local)
 {
 	bool ret = false;
@@ -8,6 +8,7 @@
  * Copyright (C) 2018, 2022 Intel Corporation
  */
 #include <linux/types.h>
+#include <linux/net_tstamp.h>
 #include <net/cfg80211.h>
 #include "ieee80211_i.h"
 #include "sta_info.h"
@@ -47,6 +48,166 @@ static void ieee80211_get_ringparam(struct net_device *dev,
 			  &rp->rx_pending, &rp->rx_max_pending);
 }
 
+static int ieee80211_set_coalesce(struct net_device *dev,
+				  struct ethtool_coalesce *ec
+#if LINUX_VERSION_IS_GEQ(5,15,0)
+,
+				  struct kernel_ethtool_coalesce *kernel_ec,
+				  struct netlink_ext_ack *extack
+#endif
+)
+{
+	struct ieee80211_local *local = wiphy_priv(dev->ieee80211_ptr->wiphy);
+
+	return drv_set_coalesce(local, ec->rx_coalesce_usecs,
+				ec->use_adaptive_rx_coalesce);
+}
+
+static int ieee80211_get_coalesce(struct net_device *dev,
+				  struct ethtool_coalesce *ec
+#if LINUX_VERSION_IS_GEQ(5,15,0)
+,
+				  struct kernel_ethtool_coalesce *kernel_ec,
+				  struct netlink_ext_ack *extack
+#endif
+)
+{
+	struct ieee80211_local *local = wiphy_priv(dev->ieee80211_ptr->wiphy);
+	bool adaptive_rx = false;
+	u32 rx_usecs = 0;
+	int ret;
+
+	ret = drv_get_coalesce(local, &rx_usecs, &adaptive_rx);
+	if (ret)
+		return ret;
+
+	ec->rx_coalesce_usecs = rx_usecs;
+	ec->use_adaptive_rx_coalesce = adaptive_rx;
+
+	return 0;
+}
+
+static u32 ieee80211_get_rxfh_indir_size(struct net_device *dev)
+{
+	struct ieee80211_local *local = wiphy_priv(dev->ieee80211_ptr->wiphy);
+
+	return local->hw.rxfh_indir_size;
+}
+
+static u32 ieee80211_get_rxfh_key_size(struct net_device *dev)
+{
+	struct ieee80211_local *local = wiphy_priv(dev->ieee80211_ptr->wiphy);
+
+	return local->hw.rxfh_key_size;
+}
+
+#if LINUX_VERSION_IS_GEQ(6,8,0)
+static int ieee80211_get_rxfh(struct net_device *dev,
+			      struct ethtool_rxfh_param *rxfh)
+{
+	struct ieee80211_local *local = wiphy_priv(dev->ieee80211_ptr->wiphy);
+
+	rxfh->hfunc = ETH_RSS_HASH_TOP;
+
+	return drv_get_rxfh(local, rxfh->indir, rxfh->key);
+}
+
+static int ieee80211_set_rxfh(struct net_device *dev,
+			      struct ethtool_rxfh_param *rxfh,
+			      struct netlink_ext_ack *extack)
+{
+	struct ieee80211_local *local = wiphy_priv(dev->ieee80211_ptr->wiphy);
+
+	if (rxfh->hfunc != ETH_RSS_HASH_NO_CHANGE &&
+	    rxfh->hfunc != ETH_RSS_HASH_TOP)
+		return -EOPNOTSUPP;
+
+	return drv_set_rxfh(local, rxfh->indir, rxfh->key);
+}
+#else
+static int ieee80211_get_rxfh(struct net_device *dev, u32 *indir, u8 *key,
+			      u8 *hfunc)
+{
+	struct ieee80211_local *local = wiphy_priv(dev->ieee80211_ptr->wiphy);
+
+	if (hfunc)
+		*hfunc = ETH_RSS_HASH_TOP;
+
+	return drv_get_rxfh(local, indir, key);
+}
+
+static int ieee80211_set_rxfh(struct net_device *dev, const u32 *indir,
+			      const u8 *key, const u8 hfunc)
+{
+	struct ieee80211_local *local = wiphy_priv(dev->ieee80211_ptr->wiphy);
+
+	if (hfunc != ETH_RSS_HASH_NO_CHANGE && hfunc != ETH_RSS_HASH_TOP)
+		return -EOPNOTSUPP;
+
+	return drv_set_rxfh(local, indir, key);
+}
+#endif
+
+static int ieee80211_get_rxnfc(struct net_device *dev,
+			       struct ethtool_rxnfc *info, u32 *rule_locs)
+{
+	struct ieee80211_local *local = wiphy_priv(dev->ieee80211_ptr->wiphy);
+
+	return drv_get_rxnfc(local, info);
+}
+
+static int ieee80211_set_rxnfc(struct net_device *dev,
+			       struct ethtool_rxnfc *info)
+{
+	struct ieee80211_local *local = wiphy_priv(dev->ieee80211_ptr->wiphy);
+
+	return drv_set_rxnfc(local, info);
+}
+
+static void ieee80211_get_channels(struct net_device *dev,
+				   struct ethtool_channels *ch)
+{
+	struct ieee80211_local *local = wiphy_priv(dev->ieee80211_ptr->wiphy);
+
+	drv_get_channels(local, ch);
+}
+
+static int ieee80211_set_channels(struct net_device *dev,
+				  struct ethtool_channels *ch)
+{
+	struct ieee80211_local *local = wiphy_priv(dev->ieee80211_ptr->wiphy);
+
+	return drv_set_channels(local, ch);
+}
+
+#if LINUX_VERSION_IS_GEQ(6,11,0)
+static int ieee80211_get_ts_info(struct net_device *dev,
+				 struct kernel_ethtool_ts_info *info)
+#else
+static int ieee80211_get_ts_info(struct net_device *dev,
+				 struct ethtool_ts_info *info)
+#endif
+{
+	struct ieee80211_local *local = wiphy_priv(dev->ieee80211_ptr->wiphy);
+	u32 so_timestamping = 0;
+	int phc_index = -1;
+	int ret;
+
+	ret = ethtool_op_get_ts_info(dev, info);
+	if (ret)
+		return ret;
+
+	if (drv_get_ts_info(local, &so_timestamping, &phc_index))
+		return 0;
+
+	info->so_timestamping |= so_timestamping;
+	info->phc_index = phc_index;
+	if (so_timestamping & SOF_TIMESTAMPING_RX_HARDWARE)
+		info->rx_filters = BIT(HWTSTAMP_FILTER_ALL);
+
+	return 0;
+}
+
 static const char ieee80211_gstrings_sta_stats[][ETH_GSTRING_LEN] = {
 	"rx_packets", "rx_bytes",
 	"rx_duplicates", "rx_fragments", "rx_dropped",
@@ -242,12 +403,27 @@ static void ieee80211_get_regs(struct net_device *dev,
 }
 
 const struct ethtool_ops ieee80211_ethtool_ops = {
+#if LINUX_VERSION_IS_GEQ(5,7,0)
+	.supported_coalesce_params = ETHTOOL_COALESCE_RX_USECS |
+				     ETHTOOL_COALESCE_USE_ADAPTIVE_RX,
+#endif
 	.get_drvinfo = cfg80211_get_drvinfo,
 	.get_regs_len = ieee80211_get_regs_len,
 	.get_regs = ieee80211_get_regs,
 	.get_link = ethtool_op_get_link,
 	.get_ringparam = ieee80211_get_ringparam,
 	.set_ringparam = ieee80211_set_ringparam,
+	.get_coalesce = ieee80211_get_coalesce,
+	.set_coalesce = ieee80211_set_coalesce,
+	.get_rxfh_indir_size = ieee80211_get_rxfh_indir_size,
+	.get_rxfh_key_size = ieee80211_get_rxfh_key_size,
+	.get_rxfh = ieee80211_get_rxfh,
+	.set_rxfh = ieee80211_set_rxfh,
+	.get_rxnfc = ieee80211_get_rxnfc,
+	.set_rxnfc = ieee80211_set_rxnfc,
+	.get_channels = ieee80211_get_channels,
+	.set_channels = ieee80211_set_channels,
+	.get_ts_info = ieee80211_get_ts_info,
 	.get_strings = ieee80211_get_strings,
 	.get_ethtool_stats = ieee80211_get_stats,
 	.get_sset_count = ieee80211_get_sset_count,
@@ -325,6 +325,13 @@ struct ieee80211_if_vlan {
 	atomic_t num_mcast_sta; /* number of stations receiving multicast */
 };
 
+/*
+ * Path discovery latency histogram: bucket i counts discoveries that took
+ * less than MESH_DISC_LAT_BOUND_MS(i), the last bucket counts the rest.
+ */
+#define MESH_DISC_LAT_BUCKETS		10
+#define MESH_DISC_LAT_BOUND_MS(i)	(10U << (i))
+
 struct mesh_stats {
 	__u32 fwded_mcast;		/* Mesh forwarded multicast frames */
 	__u32 fwded_unicast;		/* Mesh forwarded unicast frames */
@@ -332,10 +339,17 @@ struct mesh_stats {
 	__u32 dropped_frames_ttl;	/* Not transmitted since mesh_ttl == 0*/
 	__u32 dropped_frames_no_route;	/* Not transmitted, no route found */
 	__u32 dropped_frames_congestion;/* Not forwarded due to congestion */
+	/* Path discoveries completed, by latency (see MESH_DISC_LAT_BOUND_MS) */
+	__u32 discovery_latency[MESH_DISC_LAT_BUCKETS];
 };
 
 #define PREQ_Q_F_START		0x1
 #define PREQ_Q_F_REFRESH	0x2
+#define PREQ_Q_F_PRIO		0x4
+
+/* Maximum number of targets the standard allows in a single PREQ element */
+#define MESH_PREQ_MAX_TARGETS	20
+
 struct mesh_preq_queue {
 	struct list_head list;
 	u8 dst[ETH_ALEN];
@@ -645,6 +659,14 @@ struct mesh_csa_settings {
  * @walk_head: linked list containing all mesh_path objects
  * @walk_lock: lock protecting walk_head
  * @entries: number of entries in the table
+ * @last_hit: per-CPU pointer to the last path found by a lookup, checked
+ *	before the rhashtable; may be %NULL if the allocation failed
+ * @nexthop_lock: lock protecting the per-station next hop path lists
+ *	(&struct mesh_sta.nexthop_paths); nests inside all other path locks
+ * @nexthop_gen: incremented whenever a path moves between next hop lists,
+ *	so that RCU walkers of those lists can detect they need to restart
+ * @next_expire: no path can expire before this time, the expiry walk is
+ *	skipped until then
  */
 struct mesh_table {
 	struct hlist_head known_gates;
@@ -653,6 +675,24 @@ struct mesh_table {
 	struct hlist_head walk_head;
 	spinlock_t walk_lock;
 	atomic_t entries;		/* Up to MAX_MESH_NEIGHBOURS */
+	struct mesh_path * __percpu *last_hit;
+	spinlock_t nexthop_lock;
+	unsigned int nexthop_gen;
+	unsigned long next_expire;
+};
+
+/**
+ * struct mesh_tx_cache - mesh fast xmit header cache
+ *
+ * @rht: hash table containing struct ieee80211_mesh_fast_tx, using skb DA and
+ *	the type of the source address as key
+ * @walk_head: linked list containing all ieee80211_mesh_fast_tx objects
+ * @walk_lock: lock protecting walk_head and rht
+ */
+struct mesh_tx_cache {
+	struct rhashtable rht;
+	struct hlist_head walk_head;
+	spinlock_t walk_lock;
 };
 
 struct ieee80211_if_mesh {
@@ -692,6 +732,8 @@ struct ieee80211_if_mesh {
 	spinlock_t mesh_preq_queue_lock;
 	struct mesh_preq_queue preq_queue;
 	int preq_queue_len;
+	/* Max. number of queued targets sent in a single PREQ element */
+	u8 preq_max_targets;
 	struct mesh_stats mshstats;
 	struct mesh_config mshcfg;
 	atomic_t estab_plinks;
@@ -733,6 +775,7 @@ struct ieee80211_if_mesh {
 	struct mesh_table mpp_paths; /* Store paths for MPP&MAP */
 	int mesh_paths_generation;
 	int mpp_paths_generation;
+	struct mesh_tx_cache tx_cache;
 };
 
 #ifdef CPTCFG_MAC80211_MESH
@@ -45,9 +45,16 @@ static inline u16 u16_field_get(const u8 *preq_elem, int offset, bool ae)
 #define PREQ_IE_ORIG_SN(x)	u32_field_get(x, 13, 0)
 #define PREQ_IE_LIFETIME(x)	u32_field_get(x, 17, AE_F_SET(x))
 #define PREQ_IE_METRIC(x) 	u32_field_get(x, 21, AE_F_SET(x))
-#define PREQ_IE_TARGET_F(x)	(*(AE_F_SET(x) ? x + 32 : x + 26))
-#define PREQ_IE_TARGET_ADDR(x) 	(AE_F_SET(x) ? x + 33 : x + 27)
-#define PREQ_IE_TARGET_SN(x) 	u32_field_get(x, 33, AE_F_SET(x))
+#define PREQ_IE_TARGET_COUNT(x)	(*(AE_F_SET(x) ? x + 31 : x + 25))
+#define PREQ_IE_TARGET_F_N(x, n)	(*((AE_F_SET(x) ? x + 32 : x + 26) + 11 * (n)))
+#define PREQ_IE_TARGET_ADDR_N(x, n)	((AE_F_SET(x) ? x + 33 : x + 27) + 11 * (n))
+#define PREQ_IE_TARGET_SN_N(x, n)	u32_field_get(x, 33 + 11 * (n), AE_F_SET(x))
+#define PREQ_IE_TARGET_F(x)	PREQ_IE_TARGET_F_N(x, 0)
+#define PREQ_IE_TARGET_ADDR(x) 	PREQ_IE_TARGET_ADDR_N(x, 0)
+#define PREQ_IE_TARGET_SN(x) 	PREQ_IE_TARGET_SN_N(x, 0)
+
+/* PREQ element length without AE, for the given number of targets */
+#define PREQ_IE_LEN(n)		(26 + 11 * (n))
 
 
 #define PREP_IE_FLAGS(x)	PREQ_IE_FLAGS(x)
@@ -97,26 +104,27 @@ enum mpath_frame_type {
 
 static const u8 broadcast_addr[ETH_ALEN] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
 
-static int mesh_path_sel_frame_tx(enum mpath_frame_type action, u8 flags,
-				  const u8 *orig_addr, u32 orig_sn,
-				  u8 target_flags, const u8 *target,
-				  u32 target_sn, const u8 *da,
-				  u8 hop_count, u8 ttl,
-				  u32 lifetime, u32 metric, u32 preq_id,
-				  struct ieee80211_sub_if_data *sdata)
+struct hwmp_preq_target {
+	u8 flags;
+	u8 addr[ETH_ALEN];
+	u32 sn;
+};
+
+static struct sk_buff *
+mesh_path_sel_frame_alloc(struct ieee80211_sub_if_data *sdata,
+			  const u8 *da, int ie_len)
 {
 	struct ieee80211_local *local = sdata->local;
 	struct sk_buff *skb;
 	struct ieee80211_mgmt *mgmt;
-	u8 *pos, ie_len;
 	int hdr_len = offsetofend(struct ieee80211_mgmt,
 				  u.action.u.mesh_action);
 
 	skb = dev_alloc_skb(local->tx_headroom +
 			    hdr_len +
-			    2 + 37); /* max HWMP IE */
+			    2 + ie_len);
 	if (!skb)
-		return -1;
+		return NULL;
 	skb_reserve(skb, local->tx_headroom);
 	mgmt = skb_put_zero(skb, hdr_len);
 	mgmt->frame_control = cpu_to_le16(IEEE80211_FTYPE_MGMT |
@@ -130,13 +138,91 @@ static int mesh_path_sel_frame_tx(enum mpath_frame_type action, u8 flags,
 	mgmt->u.action.u.mesh_action.action_code =
 					WLAN_MESH_ACTION_HWMP_PATH_SELECTION;
 
+	return skb;
+}
+
+static int mesh_path_sel_preq_tx(struct ieee80211_sub_if_data *sdata,
+				 u8 flags, const u8 *orig_addr, u32 orig_sn,
+				 const struct hwmp_preq_target *targets,
+				 int n_targets, const u8 *da,
+				 u8 hop_count, u8 ttl, u32 lifetime,
+				 u32 metric, u32 preq_id)
+{
+	struct sk_buff *skb;
+	u8 *pos, ie_len;
+	int i;
+
+	if (WARN_ON(n_targets < 1 || n_targets > MESH_PREQ_MAX_TARGETS))
+		return -EINVAL;
+
+	ie_len = PREQ_IE_LEN(n_targets);
+	skb = mesh_path_sel_frame_alloc(sdata, da, ie_len);
+	if (!skb)
+		return -1;
+
+	if (n_targets == 1)
+		mhwmp_dbg(sdata, "sending PREQ to %pM\n", targets[0].addr);
+	else
+		mhwmp_dbg(sdata, "sending PREQ to %pM and %d more targets\n",
+			  targets[0].addr, n_targets - 1);
+
+	pos = skb_put(skb, 2 + ie_len);
+	*pos++ = WLAN_EID_PREQ;
+	*pos++ = ie_len;
+	*pos++ = flags;
+	*pos++ = hop_count;
+	*pos++ = ttl;
+	put_unaligned_le32(preq_id, pos);
+	pos += 4;
+	memcpy(pos, orig_addr, ETH_ALEN);
+	pos += ETH_ALEN;
+	put_unaligned_le32(orig_sn, pos);
+	pos += 4;
+	put_unaligned_le32(lifetime, pos);
+	pos += 4;
+	put_unaligned_le32(metric, pos);
+	pos += 4;
+	*pos++ = n_targets; /* destination count */
+	for (i = 0; i < n_targets; i++) {
+		*pos++ = targets[i].flags;
+		memcpy(pos, targets[i].addr, ETH_ALEN);
+		pos += ETH_ALEN;
+		put_unaligned_le32(targets[i].sn, pos);
+		pos += 4;
+	}
+
+	ieee80211_tx_skb(sdata, skb);
+	return 0;
+}
+
+static int mesh_path_sel_frame_tx(enum mpath_frame_type action, u8 flags,
+				  const u8 *orig_addr, u32 orig_sn,
+				  u8 target_flags, const u8 *target,
+				  u32 target_sn, const u8 *da,
+				  u8 hop_count, u8 ttl,
+				  u32 lifetime, u32 metric, u32 preq_id,
+				  struct ieee80211_sub_if_data *sdata)
+{
+	struct sk_buff *skb;
+	u8 *pos, ie_len;
+
+	if (action == MPATH_PREQ) {
+		struct hwmp_preq_target preq_target = {
+			.flags = target_flags,
+			.sn = target_sn,
+		};
+
+		memcpy(preq_target.addr, target, ETH_ALEN);
+		return mesh_path_sel_preq_tx(sdata, flags, orig_addr, orig_sn,
+					     &preq_target, 1, da, hop_count,
+					     ttl, lifetime, metric, preq_id);
+	}
+
+	skb = mesh_path_sel_frame_alloc(sdata, da, 37); /* max HWMP IE */
+	if (!skb)
+		return -1;
+
 	switch (action) {
-	case MPATH_PREQ:
-		mhwmp_dbg(sdata, "sending PREQ to %pM\n", target);
-		ie_len = 37;
-		pos = skb_put(skb, 2 + ie_len);
-		*pos++ = WLAN_EID_PREQ;
-		break;
 	case MPATH_PREP:
 		mhwmp_dbg(sdata, "sending PREP to %pM\n", orig_addr);
 		ie_len = 31;
@@ -163,10 +249,6 @@ static int mesh_path_sel_frame_tx(enum mpath_frame_type action, u8 flags,
 		put_unaligned_le32(target_sn, pos);
 		pos += 4;
 	} else {
-		if (action == MPATH_PREQ) {
-			put_unaligned_le32(preq_id, pos);
-			pos += 4;
-		}
 		memcpy(pos, orig_addr, ETH_ALEN);
 		pos += ETH_ALEN;
 		put_unaligned_le32(orig_sn, pos);
@@ -176,14 +258,7 @@ static int mesh_path_sel_frame_tx(enum mpath_frame_type action, u8 flags,
 	pos += 4;
 	put_unaligned_le32(metric, pos);
 	pos += 4;
-	if (action == MPATH_PREQ) {
-		*pos++ = 1; /* destination count */
-		*pos++ = target_flags;
-		memcpy(pos, target, ETH_ALEN);
-		pos += ETH_ALEN;
-		put_unaligned_le32(target_sn, pos);
-		pos += 4;
-	} else if (action == MPATH_PREP) {
+	if (action == MPATH_PREP) {
 		memcpy(pos, orig_addr, ETH_ALEN);
 		pos += ETH_ALEN;
 		put_unaligned_le32(orig_sn, pos);
@@ -365,6 +440,29 @@ u32 airtime_link_metric_get(struct ieee80211_local *local,
 	return (u32)result;
 }
 
+/*
+ * Account the time a path discovery took once the path is resolved.
+ *
+ * Locking: mpath->state_lock must be held when calling this function
+ */
+static void hwmp_discovery_done(struct ieee80211_sub_if_data *sdata,
+				struct mesh_path *mpath)
+{
+	unsigned int msecs;
+	int i;
+
+	if (!(mpath->flags & MESH_PATH_RESOLVING) || !mpath->discovery_start)
+		return;
+
+	msecs = jiffies_to_msecs(jiffies - mpath->discovery_start);
+	mpath->discovery_start = 0;
+
+	for (i = 0; i < MESH_DISC_LAT_BUCKETS - 1; i++)
+		if (msecs < MESH_DISC_LAT_BOUND_MS(i))
+			break;
+	sdata->u.mesh.mshstats.discovery_latency[i]++;
+}
+
 /**
  * hwmp_route_info_get - Update routing info to originator and transmitter
  *
@@ -500,6 +598,7 @@ static u32 hwmp_route_info_get(struct ieee80211_sub_if_data *sdata,
 			mpath->exp_time = time_after(mpath->exp_time, exp_time)
 					  ?  mpath->exp_time : exp_time;
 			mpath->hop_count = hopcount;
+			hwmp_discovery_done(sdata, mpath);
 			mesh_path_activate(mpath);
 			spin_unlock_bh(&mpath->state_lock);
 			ewma_mesh_fail_avg_init(&sta->mesh->fail_avg);
@@ -546,6 +645,7 @@ static u32 hwmp_route_info_get(struct ieee80211_sub_if_data *sdata,
 			mpath->exp_time = time_after(mpath->exp_time, exp_time)
 					  ?  mpath->exp_time : exp_time;
 			mpath->hop_count = 1;
+			hwmp_discovery_done(sdata, mpath);
 			mesh_path_activate(mpath);
 			spin_unlock_bh(&mpath->state_lock);
 			ewma_mesh_fail_avg_init(&sta->mesh->fail_avg);
@@ -566,95 +666,132 @@ static void hwmp_preq_frame_process(struct ieee80211_sub_if_data *sdata,
 				    const u8 *preq_elem, u32 orig_metric)
 {
 	struct ieee80211_if_mesh *ifmsh = &sdata->u.mesh;
+	struct hwmp_preq_target fwd_targets[MESH_PREQ_MAX_TARGETS];
 	struct mesh_path *mpath = NULL;
 	const u8 *target_addr, *orig_addr;
-	const u8 *da;
+	u8 da[ETH_ALEN];
 	u8 target_flags, ttl, flags;
 	u32 orig_sn, target_sn, lifetime, target_metric = 0;
-	bool reply = false;
-	bool forward = true;
+	int i, n_targets, n_fwd = 0;
+	bool reply;
+	bool forward;
 	bool root_is_gate;
 
-	/* Update target SN, if present */
-	target_addr = PREQ_IE_TARGET_ADDR(preq_elem);
 	orig_addr = PREQ_IE_ORIG_ADDR(preq_elem);
-	target_sn = PREQ_IE_TARGET_SN(preq_elem);
 	orig_sn = PREQ_IE_ORIG_SN(preq_elem);
-	target_flags = PREQ_IE_TARGET_F(preq_elem);
 	/* Proactive PREQ gate announcements */
 	flags = PREQ_IE_FLAGS(preq_elem);
 	root_is_gate = !!(flags & RANN_FLAG_IS_GATE);
+	n_targets = PREQ_IE_TARGET_COUNT(preq_elem);
 
 	mhwmp_dbg(sdata, "received PREQ from %pM\n", orig_addr);
 
-	if (ether_addr_equal(target_addr, sdata->vif.addr)) {
-		mhwmp_dbg(sdata, "PREQ is for us\n");
-		forward = false;
-		reply = true;
-		target_metric = 0;
+	for (i = 0; i < n_targets; i++) {
+		const u8 *fwd_da;
 
-		if (SN_GT(target_sn, ifmsh->sn))
-			ifmsh->sn = target_sn;
+		/* Update target SN, if present */
+		target_addr = PREQ_IE_TARGET_ADDR_N(preq_elem, i);
+		target_sn = PREQ_IE_TARGET_SN_N(preq_elem, i);
+		target_flags = PREQ_IE_TARGET_F_N(preq_elem, i);
+		reply = false;
+		forward = true;
+		mpath = NULL;
 
-		if (time_after(jiffies, ifmsh->last_sn_update +
-					net_traversal_jiffies(sdata)) ||
-		    time_before(jiffies, ifmsh->last_sn_update)) {
-			++ifmsh->sn;
-			ifmsh->last_sn_update = jiffies;
-		}
-		target_sn = ifmsh->sn;
-	} else if (is_broadcast_ether_addr(target_addr) &&
-		   (target_flags & IEEE80211_PREQ_TO_FLAG)) {
 		rcu_read_lock();
-		mpath = mesh_path_lookup(sdata, orig_addr);
-		if (mpath) {
-			if (flags & IEEE80211_PREQ_PROACTIVE_PREP_FLAG) {
-				reply = true;
-				target_addr = sdata->vif.addr;
-				target_sn = ++ifmsh->sn;
-				target_metric = 0;
+		if (ether_addr_equal(target_addr, sdata->vif.addr)) {
+			mhwmp_dbg(sdata, "PREQ is for us\n");
+			forward = false;
+			reply = true;
+			target_metric = 0;
+
+			if (SN_GT(target_sn, ifmsh->sn))
+				ifmsh->sn = target_sn;
+
+			if (time_after(jiffies, ifmsh->last_sn_update +
+						net_traversal_jiffies(sdata)) ||
+			    time_before(jiffies, ifmsh->last_sn_update)) {
+				++ifmsh->sn;
 				ifmsh->last_sn_update = jiffies;
 			}
-			if (root_is_gate)
-				mesh_path_add_gate(mpath);
+			target_sn = ifmsh->sn;
+		} else if (is_broadcast_ether_addr(target_addr) &&
+			   (target_flags & IEEE80211_PREQ_TO_FLAG)) {
+			mpath = mesh_path_lookup(sdata, orig_addr);
+			if (mpath) {
+				if (flags & IEEE80211_PREQ_PROACTIVE_PREP_FLAG) {
+					reply = true;
+					target_addr = sdata->vif.addr;
+					target_sn = ++ifmsh->sn;
+					target_metric = 0;
+					ifmsh->last_sn_update = jiffies;
+				}
+				if (root_is_gate)
+					mesh_path_add_gate(mpath);
+			}
+		} else {
+			mpath = mesh_path_lookup(sdata, target_addr);
+			if (mpath) {
+				if ((!(mpath->flags & MESH_PATH_SN_VALID)) ||
+						SN_LT(mpath->sn, target_sn)) {
+					mpath->sn = target_sn;
+					mpath->flags |= MESH_PATH_SN_VALID;
+				} else if ((!(target_flags & IEEE80211_PREQ_TO_FLAG)) &&
+						(mpath->flags & MESH_PATH_ACTIVE)) {
+					reply = true;
+					target_metric = mpath->metric;
+					target_sn = mpath->sn;
+					/* Case E2 of sec 13.10.9.3 IEEE 802.11-2012*/
+					target_flags |= IEEE80211_PREQ_TO_FLAG;
+				}
+			}
 		}
-		rcu_read_unlock();
-	} else {
-		rcu_read_lock();
-		mpath = mesh_path_lookup(sdata, target_addr);
-		if (mpath) {
-			if ((!(mpath->flags & MESH_PATH_SN_VALID)) ||
-					SN_LT(mpath->sn, target_sn)) {
-				mpath->sn = target_sn;
-				mpath->flags |= MESH_PATH_SN_VALID;
-			} else if ((!(target_flags & IEEE80211_PREQ_TO_FLAG)) &&
-					(mpath->flags & MESH_PATH_ACTIVE)) {
-				reply = true;
-				target_metric = mpath->metric;
-				target_sn = mpath->sn;
-				/* Case E2 of sec 13.10.9.3 IEEE 802.11-2012*/
-				target_flags |= IEEE80211_PREQ_TO_FLAG;
+
+		if (reply) {
+			lifetime = PREQ_IE_LIFETIME(preq_elem);
+			ttl = ifmsh->mshcfg.element_ttl;
+			if (ttl != 0) {
+				mhwmp_dbg(sdata, "replying to the PREQ\n");
+				mesh_path_sel_frame_tx(MPATH_PREP, 0, orig_addr,
+						       orig_sn, 0, target_addr,
+						       target_sn, mgmt->sa, 0, ttl,
+						       lifetime, target_metric, 0,
+						       sdata);
+			} else {
+				ifmsh->mshstats.dropped_frames_ttl++;
 			}
 		}
-		rcu_read_unlock();
-	}
 
-	if (reply) {
-		lifetime = PREQ_IE_LIFETIME(preq_elem);
-		ttl = ifmsh->mshcfg.element_ttl;
-		if (ttl != 0) {
-			mhwmp_dbg(sdata, "replying to the PREQ\n");
-			mesh_path_sel_frame_tx(MPATH_PREP, 0, orig_addr,
-					       orig_sn, 0, target_addr,
-					       target_sn, mgmt->sa, 0, ttl,
-					       lifetime, target_metric, 0,
-					       sdata);
-		} else {
-			ifmsh->mshstats.dropped_frames_ttl++;
+		if (!forward) {
+			rcu_read_unlock();
+			continue;
 		}
+
+		/* All targets that still need to be forwarded go out in a
+		 * single PREQ; it is only unicast towards a root if all of
+		 * them agree on the next hop.
+		 */
+		fwd_da = (mpath && mpath->is_root) ?
+			mpath->rann_snd_addr : broadcast_addr;
+		if (!n_fwd)
+			memcpy(da, fwd_da, ETH_ALEN);
+		else if (memcmp(da, fwd_da, ETH_ALEN))
+			eth_broadcast_addr(da);
+		rcu_read_unlock();
+
+		/* a proactive PREQ is forwarded as received, others carry
+		 * the target SN as updated above
+		 */
+		fwd_targets[n_fwd].flags = target_flags;
+		memcpy(fwd_targets[n_fwd].addr,
+		       PREQ_IE_TARGET_ADDR_N(preq_elem, i), ETH_ALEN);
+		if (flags & IEEE80211_PREQ_PROACTIVE_PREP_FLAG)
+			fwd_targets[n_fwd].sn = PREQ_IE_TARGET_SN_N(preq_elem, i);
+		else
+			fwd_targets[n_fwd].sn = target_sn;
+		n_fwd++;
 	}
 
-	if (forward && ifmsh->mshcfg.dot11MeshForwarding) {
+	if (n_fwd && ifmsh->mshcfg.dot11MeshForwarding) {
 		u32 preq_id;
 		u8 hopcount;
 
@@ -668,18 +805,10 @@ static void hwmp_preq_frame_process(struct ieee80211_sub_if_data *sdata,
 		--ttl;
 		preq_id = PREQ_IE_PREQ_ID(preq_elem);
 		hopcount = PREQ_IE_HOPCOUNT(preq_elem) + 1;
-		da = (mpath && mpath->is_root) ?
-			mpath->rann_snd_addr : broadcast_addr;
 
-		if (flags & IEEE80211_PREQ_PROACTIVE_PREP_FLAG) {
-			target_addr = PREQ_IE_TARGET_ADDR(preq_elem);
-			target_sn = PREQ_IE_TARGET_SN(preq_elem);
-		}
-
-		mesh_path_sel_frame_tx(MPATH_PREQ, flags, orig_addr,
-				       orig_sn, target_flags, target_addr,
-				       target_sn, da, hopcount, ttl, lifetime,
-				       orig_metric, preq_id, sdata);
+		mesh_path_sel_preq_tx(sdata, flags, orig_addr, orig_sn,
+				      fwd_targets, n_fwd, da, hopcount, ttl,
+				      lifetime, orig_metric, preq_id);
 		if (!is_multicast_ether_addr(da))
 			ifmsh->mshstats.fwded_unicast++;
 		else
@@ -937,8 +1066,13 @@ void mesh_rx_path_sel_frame(struct ieee80211_sub_if_data *sdata,
 		return;
 
 	if (elems->preq) {
-		if (elems->preq_len != 37)
-			/* Right now we support just 1 destination and no AE */
+		/* Right now we support no AE */
+		if (elems->preq_len < PREQ_IE_LEN(1) ||
+		    AE_F_SET(elems->preq) ||
+		    PREQ_IE_TARGET_COUNT(elems->preq) < 1 ||
+		    PREQ_IE_TARGET_COUNT(elems->preq) > MESH_PREQ_MAX_TARGETS ||
+		    elems->preq_len !=
+		    PREQ_IE_LEN(PREQ_IE_TARGET_COUNT(elems->preq)))
 			goto free;
 		path_metric = hwmp_route_info_get(sdata, mgmt, elems->preq,
 						  MPATH_PREQ);
@@ -981,7 +1115,7 @@ static void mesh_queue_preq(struct mesh_path *mpath, u8 flags)
 {
 	struct ieee80211_sub_if_data *sdata = mpath->sdata;
 	struct ieee80211_if_mesh *ifmsh = &sdata->u.mesh;
-	struct mesh_preq_queue *preq_node;
+	struct mesh_preq_queue *preq_node, *pos;
 
 	preq_node = kmalloc(sizeof(struct mesh_preq_queue), GFP_ATOMIC);
 	if (!preq_node) {
@@ -1009,10 +1143,22 @@ static void mesh_queue_preq(struct mesh_path *mpath, u8 flags)
 	memcpy(preq_node->dst, mpath->dst, ETH_ALEN);
 	preq_node->flags = flags;
 
+	/* discoveries that frames are waiting on go before path refreshes */
+	if ((flags & (PREQ_Q_F_START | PREQ_Q_F_REFRESH)) == PREQ_Q_F_START ||
+	    !skb_queue_empty(&mpath->frame_queue))
+		preq_node->flags |= PREQ_Q_F_PRIO;
+
 	mpath->flags |= MESH_PATH_REQ_QUEUED;
 	spin_unlock(&mpath->state_lock);
 
-	list_add_tail(&preq_node->list, &ifmsh->preq_queue.list);
+	if (preq_node->flags & PREQ_Q_F_PRIO) {
+		list_for_each_entry(pos, &ifmsh->preq_queue.list, list)
+			if (!(pos->flags & PREQ_Q_F_PRIO))
+				break;
+		list_add_tail(&preq_node->list, &pos->list);
+	} else {
+		list_add_tail(&preq_node->list, &ifmsh->preq_queue.list);
+	}
 	++ifmsh->preq_queue_len;
 	spin_unlock_bh(&ifmsh->mesh_preq_queue_lock);
 
@@ -1030,60 +1176,35 @@ static void mesh_queue_preq(struct mesh_path *mpath, u8 flags)
 						min_preq_int_jiff(sdata));
 }
 
-/**
- * mesh_path_start_discovery - launch a path discovery from the PREQ queue
- *
- * @sdata: local mesh subif
+/*
+ * Check that a queued PREQ is still needed and prepare its target; returns
+ * false if the node should be dropped.
  */
-void mesh_path_start_discovery(struct ieee80211_sub_if_data *sdata)
+static bool hwmp_preq_prepare_target(struct ieee80211_sub_if_data *sdata,
+				     struct mesh_preq_queue *preq_node,
+				     struct mesh_path *mpath,
+				     struct hwmp_preq_target *target)
 {
 	struct ieee80211_if_mesh *ifmsh = &sdata->u.mesh;
-	struct mesh_preq_queue *preq_node;
-	struct mesh_path *mpath;
-	u8 ttl, target_flags = 0;
-	const u8 *da;
-	u32 lifetime;
-
-	spin_lock_bh(&ifmsh->mesh_preq_queue_lock);
-	if (!ifmsh->preq_queue_len ||
-		time_before(jiffies, ifmsh->last_preq +
-				min_preq_int_jiff(sdata))) {
-		spin_unlock_bh(&ifmsh->mesh_preq_queue_lock);
-		return;
-	}
-
-	preq_node = list_first_entry(&ifmsh->preq_queue.list,
-			struct mesh_preq_queue, list);
-	list_del(&preq_node->list);
-	--ifmsh->preq_queue_len;
-	spin_unlock_bh(&ifmsh->mesh_preq_queue_lock);
-
-	rcu_read_lock();
-	mpath = mesh_path_lookup(sdata, preq_node->dst);
-	if (!mpath)
-		goto enddiscovery;
 
 	spin_lock_bh(&mpath->state_lock);
-	if (mpath->flags & (MESH_PATH_DELETED | MESH_PATH_FIXED)) {
-		spin_unlock_bh(&mpath->state_lock);
-		goto enddiscovery;
-	}
+	if (mpath->flags & (MESH_PATH_DELETED | MESH_PATH_FIXED))
+		goto drop;
+
 	mpath->flags &= ~MESH_PATH_REQ_QUEUED;
 	if (preq_node->flags & PREQ_Q_F_START) {
-		if (mpath->flags & MESH_PATH_RESOLVING) {
-			spin_unlock_bh(&mpath->state_lock);
-			goto enddiscovery;
-		} else {
-			mpath->flags &= ~MESH_PATH_RESOLVED;
-			mpath->flags |= MESH_PATH_RESOLVING;
-			mpath->discovery_retries = 0;
-			mpath->discovery_timeout = disc_timeout_jiff(sdata);
-		}
+		if (mpath->flags & MESH_PATH_RESOLVING)
+			goto drop;
+
+		mpath->flags &= ~MESH_PATH_RESOLVED;
+		mpath->flags |= MESH_PATH_RESOLVING;
+		mpath->discovery_retries = 0;
+		mpath->discovery_timeout = disc_timeout_jiff(sdata);
+		mpath->discovery_start = jiffies;
 	} else if (!(mpath->flags & MESH_PATH_RESOLVING) ||
 			mpath->flags & MESH_PATH_RESOLVED) {
 		mpath->flags &= ~MESH_PATH_RESOLVING;
-		spin_unlock_bh(&mpath->state_lock);
-		goto enddiscovery;
+		goto drop;
 	}
 
 	ifmsh->last_preq = jiffies;
@@ -1094,33 +1215,119 @@ void mesh_path_start_discovery(struct ieee80211_sub_if_data *sdata)
 		++ifmsh->sn;
 		sdata->u.mesh.last_sn_update = jiffies;
 	}
-	lifetime = default_lifetime(sdata);
-	ttl = sdata->u.mesh.mshcfg.element_ttl;
-	if (ttl == 0) {
+	if (sdata->u.mesh.mshcfg.element_ttl == 0) {
 		sdata->u.mesh.mshstats.dropped_frames_ttl++;
-		spin_unlock_bh(&mpath->state_lock);
-		goto enddiscovery;
+		goto drop;
 	}
 
+	target->flags = 0;
 	if (preq_node->flags & PREQ_Q_F_REFRESH)
-		target_flags |= IEEE80211_PREQ_TO_FLAG;
-	else
-		target_flags &= ~IEEE80211_PREQ_TO_FLAG;
-
+		target->flags |= IEEE80211_PREQ_TO_FLAG;
+	memcpy(target->addr, mpath->dst, ETH_ALEN);
+	target->sn = mpath->sn;
 	spin_unlock_bh(&mpath->state_lock);
-	da = (mpath->is_root) ? mpath->rann_snd_addr : broadcast_addr;
-	mesh_path_sel_frame_tx(MPATH_PREQ, 0, sdata->vif.addr, ifmsh->sn,
-			       target_flags, mpath->dst, mpath->sn, da, 0,
-			       ttl, lifetime, 0, ifmsh->preq_id++, sdata);
+	return true;
 
-	spin_lock_bh(&mpath->state_lock);
-	if (!(mpath->flags & MESH_PATH_DELETED))
-		mod_timer(&mpath->timer, jiffies + mpath->discovery_timeout);
+drop:
 	spin_unlock_bh(&mpath->state_lock);
+	return false;
+}
+
+static void hwmp_preq_arm_timers(struct mesh_path **mpaths, int n_mpaths)
+{
+	int i;
+
+	for (i = 0; i < n_mpaths; i++) {
+		struct mesh_path *mpath = mpaths[i];
+
+		spin_lock_bh(&mpath->state_lock);
+		if (!(mpath->flags & MESH_PATH_DELETED))
+			mod_timer(&mpath->timer,
+				  jiffies + mpath->discovery_timeout);
+		spin_unlock_bh(&mpath->state_lock);
+	}
+}
+
+/**
+ * mesh_path_start_discovery - launch a path discovery from the PREQ queue
+ *
+ * @sdata: local mesh subif
+ *
+ * Up to preq_max_targets queued destinations are sent in a single PREQ
+ * element. Since only one PREQ may be sent per dot11MeshHWMPpreqMinInterval,
+ * it only carries the destinations sharing the next hop of the first one:
+ * those reached through the same root announcement, whose PREQ is unicast
+ * to it, or else those that are broadcast. The others are left queued for
+ * the next interval.
+ */
+void mesh_path_start_discovery(struct ieee80211_sub_if_data *sdata)
+{
+	struct ieee80211_if_mesh *ifmsh = &sdata->u.mesh;
+	struct hwmp_preq_target targets[MESH_PREQ_MAX_TARGETS];
+	struct mesh_path *mpaths[MESH_PREQ_MAX_TARGETS];
+	struct mesh_preq_queue *preq_node, *tmp;
+	int max_targets, n_targets = 0;
+	struct mesh_path *mpath;
+	const u8 *da = NULL;
+	LIST_HEAD(batch);
+	u32 lifetime;
+
+	max_targets = clamp_t(int, ifmsh->preq_max_targets, 1,
+			      MESH_PREQ_MAX_TARGETS);
 
-enddiscovery:
+	rcu_read_lock();
+	spin_lock_bh(&ifmsh->mesh_preq_queue_lock);
+	if (!ifmsh->preq_queue_len ||
+		time_before(jiffies, ifmsh->last_preq +
+				min_preq_int_jiff(sdata))) {
+		spin_unlock_bh(&ifmsh->mesh_preq_queue_lock);
+		rcu_read_unlock();
+		return;
+	}
+
+	list_for_each_entry_safe(preq_node, tmp, &ifmsh->preq_queue.list,
+				 list) {
+		const u8 *node_da;
+
+		mpath = mesh_path_lookup(sdata, preq_node->dst);
+		if (mpath) {
+			node_da = mpath->is_root ? mpath->rann_snd_addr :
+						   broadcast_addr;
+			if (!da)
+				da = node_da;
+			else if (!ether_addr_equal(da, node_da))
+				continue;
+		}
+
+		/* nodes without a path are dropped below */
+		list_move_tail(&preq_node->list, &batch);
+		--ifmsh->preq_queue_len;
+		if (mpath && --max_targets == 0)
+			break;
+	}
+	spin_unlock_bh(&ifmsh->mesh_preq_queue_lock);
+
+	lifetime = default_lifetime(sdata);
+
+	list_for_each_entry_safe(preq_node, tmp, &batch, list) {
+		list_del(&preq_node->list);
+
+		mpath = mesh_path_lookup(sdata, preq_node->dst);
+		if (mpath &&
+		    hwmp_preq_prepare_target(sdata, preq_node, mpath,
+					     &targets[n_targets]))
+			mpaths[n_targets++] = mpath;
+		kfree(preq_node);
+	}
+
+	if (n_targets) {
+		mesh_path_sel_preq_tx(sdata, 0, sdata->vif.addr, ifmsh->sn,
+				      targets, n_targets, da, 0,
+				      ifmsh->mshcfg.element_ttl, lifetime, 0,
+				      ifmsh->preq_id++);
+		hwmp_preq_arm_timers(mpaths, n_targets);
+	}
 	rcu_read_unlock();
-	kfree(preq_node);
 }
 
 /**
@@ -1255,6 +1462,8 @@ int mesh_nexthop_lookup(struct ieee80211_sub_if_data *sdata,
 		memcpy(hdr->addr1, next_hop->sta.addr, ETH_ALEN);
 		memcpy(hdr->addr2, sdata->vif.addr, ETH_ALEN);
 		ieee80211_mps_set_frame_flags(sdata, next_hop, hdr);
+		if (ieee80211_hw_check(&sdata->local->hw, SUPPORT_FAST_XMIT))
+			mesh_fast_tx_cache(sdata, skb, mpath);
 		return 0;
 	}
 
@@ -32,6 +32,15 @@ static const struct rhashtable_params mesh_rht_params = {
 	.hashfn = mesh_table_hash,
 };
 
+static const struct rhashtable_params fast_tx_rht_params = {
+	.nelem_hint = 10,
+	.automatic_shrinking = true,
+	.key_len = sizeof(struct ieee80211_mesh_fast_tx_key),
+	.key_offset = offsetof(struct ieee80211_mesh_fast_tx, key),
+	.head_offset = offsetof(struct ieee80211_mesh_fast_tx, rhash),
+	.hashfn = mesh_table_hash,
+};
+
 static inline bool mpath_expired(struct mesh_path *mpath)
 {
 	return (mpath->flags & MESH_PATH_ACTIVE) &&
@@ -54,6 +63,11 @@ static void mesh_table_init(struct mesh_table *tbl)
 	atomic_set(&tbl->entries,  0);
 	spin_lock_init(&tbl->gates_lock);
 	spin_lock_init(&tbl->walk_lock);
+	spin_lock_init(&tbl->nexthop_lock);
+	tbl->next_expire = jiffies + MESH_PATH_EXPIRE;
+
+	/* lookups fall back to the rhashtable if this fails */
+	tbl->last_hit = alloc_percpu(struct mesh_path *);
 
 	/* rhashtable_init() may fail only in case of wrong
 	 * mesh_rht_params
@@ -65,6 +79,407 @@ static void mesh_table_free(struct mesh_table *tbl)
 {
 	rhashtable_free_and_destroy(&tbl->rhead,
 				    mesh_path_rht_free, tbl);
+	free_percpu(tbl->last_hit);
+}
+
+/*
+ * The per-CPU last hit cache holds plain pointers to paths, so it must never
+ * point to a path that can be freed. mesh_path_free_rcu() sets
+ * MESH_PATH_DELETED before evicting the path from all CPUs, and a lookup
+ * re-checks that flag after storing the path; with a full barrier on both
+ * sides either the eviction sees the new pointer or the lookup sees the flag.
+ */
+static void mesh_table_cache_store(struct mesh_table *tbl,
+				   struct mesh_path *mpath)
+{
+	struct mesh_path **slot;
+
+	if (!tbl->last_hit)
+		return;
+
+	slot = raw_cpu_ptr(tbl->last_hit);
+	WRITE_ONCE(*slot, mpath);
+	smp_mb();
+	if (unlikely(READ_ONCE(mpath->flags) & MESH_PATH_DELETED))
+		cmpxchg(slot, mpath, NULL);
+}
+
+static void mesh_table_cache_evict(struct mesh_table *tbl,
+				   struct mesh_path *mpath)
+{
+	int cpu;
+
+	if (!tbl->last_hit)
+		return;
+
+	smp_mb();
+	for_each_possible_cpu(cpu)
+		cmpxchg(per_cpu_ptr(tbl->last_hit, cpu), mpath, NULL);
+}
+
+/*
+ * Keep the next hop STA's list of paths up to date. A deleted path is never
+ * linked again, see mesh_path_free_rcu().
+ *
+ * Locking: mpath->state_lock must be held when calling this function
+ */
+static void mesh_path_move_nexthop(struct mesh_path *mpath,
+				   struct sta_info *sta)
+{
+	struct mesh_table *tbl = &mpath->sdata->u.mesh.mesh_paths;
+
+	spin_lock_bh(&tbl->nexthop_lock);
+	if (!hlist_unhashed(&mpath->nexthop_list)) {
+		hlist_del_init_rcu(&mpath->nexthop_list);
+		WRITE_ONCE(tbl->nexthop_gen, tbl->nexthop_gen + 1);
+	}
+	if (!(mpath->flags & MESH_PATH_DELETED))
+		hlist_add_head_rcu(&mpath->nexthop_list,
+				   &sta->mesh->nexthop_paths);
+	spin_unlock_bh(&tbl->nexthop_lock);
+}
+
+static void mesh_fast_tx_entry_free(struct mesh_tx_cache *cache,
+				    struct ieee80211_mesh_fast_tx *entry)
+{
+	hlist_del_rcu(&entry->walk_list);
+	rhashtable_remove_fast(&cache->rht, &entry->rhash, fast_tx_rht_params);
+	kfree_rcu(entry, fast_tx.rcu_head);
+}
+
+static void mesh_fast_tx_free(void *ptr, void *arg)
+{
+	struct ieee80211_mesh_fast_tx *entry = ptr;
+
+	kfree(entry);
+}
+
+static void mesh_fast_tx_init(struct ieee80211_sub_if_data *sdata)
+{
+	struct mesh_tx_cache *cache = &sdata->u.mesh.tx_cache;
+
+	INIT_HLIST_HEAD(&cache->walk_head);
+	spin_lock_init(&cache->walk_lock);
+
+	/* rhashtable_init() may fail only in case of wrong
+	 * fast_tx_rht_params
+	 */
+	WARN_ON(rhashtable_init(&cache->rht, &fast_tx_rht_params));
+}
+
+static void mesh_fast_tx_deinit(struct ieee80211_sub_if_data *sdata)
+{
+	struct mesh_tx_cache *cache = &sdata->u.mesh.tx_cache;
+
+	rhashtable_free_and_destroy(&cache->rht, mesh_fast_tx_free, NULL);
+}
+
+/**
+ * mesh_fast_tx_get - look up a cached fast xmit header
+ *
+ * @sdata: local subif
+ * @key: DA and source address type of the frame to transmit
+ *
+ * Returns: the cache entry, or NULL if not found or no longer usable.
+ *
+ * Locking: must be called within a read rcu section.
+ */
+struct ieee80211_mesh_fast_tx *
+mesh_fast_tx_get(struct ieee80211_sub_if_data *sdata,
+		 struct ieee80211_mesh_fast_tx_key *key)
+{
+	struct ieee80211_mesh_fast_tx *entry;
+	struct mesh_tx_cache *cache;
+	struct mesh_path *mpath;
+
+	cache = &sdata->u.mesh.tx_cache;
+	entry = rhashtable_lookup(&cache->rht, key, fast_tx_rht_params);
+	if (!entry)
+		return NULL;
+
+	mpath = entry->mpath;
+	if (!(mpath->flags & MESH_PATH_ACTIVE) || mpath_expired(mpath)) {
+		spin_lock_bh(&cache->walk_lock);
+		entry = rhashtable_lookup(&cache->rht, key, fast_tx_rht_params);
+		if (entry)
+			mesh_fast_tx_entry_free(cache, entry);
+		spin_unlock_bh(&cache->walk_lock);
+		return NULL;
+	}
+
+	/* let mesh_nexthop_lookup() take care of refreshing the path */
+	if (time_after(jiffies,
+		       mpath->exp_time -
+		       msecs_to_jiffies(sdata->u.mesh.mshcfg.path_refresh_time)) &&
+	    !(mpath->flags & (MESH_PATH_RESOLVING | MESH_PATH_FIXED)))
+		return NULL;
+
+	if (entry->mppath)
+		entry->mppath->exp_time = jiffies;
+	entry->timestamp = jiffies;
+
+	return entry;
+}
+
+/**
+ * mesh_fast_tx_cache - cache the header of a locally generated frame
+ *
+ * @sdata: local subif
+ * @skb: frame with the 802.11 and mesh headers filled in for @mpath
+ * @mpath: resolved mesh path to the mesh DA of the frame
+ *
+ * Called from the next hop lookup, so that subsequent frames towards the same
+ * destination can skip the header building and path lookups.
+ *
+ * Locking: must be called within a read rcu section.
+ */
+void mesh_fast_tx_cache(struct ieee80211_sub_if_data *sdata,
+			struct sk_buff *skb, struct mesh_path *mpath)
+{
+	struct ieee80211_hdr *hdr = (struct ieee80211_hdr *)skb->data;
+	struct ieee80211_mesh_fast_tx *entry, *prev;
+	struct ieee80211_mesh_fast_tx build = {};
+	struct ieee80211_chanctx_conf *chanctx_conf;
+	struct ieee80211s_hdr *meshhdr;
+	struct mesh_tx_cache *cache;
+	struct ieee80211_key *key;
+	struct mesh_path *mppath;
+	struct sta_info *sta;
+	u8 *qc;
+
+	if (sdata->noack_map ||
+	    !ieee80211_is_data_qos(hdr->frame_control) ||
+	    ieee80211_has_pm(hdr->frame_control))
+		return;
+
+	/* only cache frames originating from this interface */
+	if (!ether_addr_equal(hdr->addr4, sdata->vif.addr))
+		return;
+
+	build.fast_tx.hdr_len = ieee80211_hdrlen(hdr->frame_control);
+	meshhdr = (struct ieee80211s_hdr *)(skb->data + build.fast_tx.hdr_len);
+	build.hdrlen = ieee80211_get_mesh_hdrlen(meshhdr);
+
+	cache = &sdata->u.mesh.tx_cache;
+	if (atomic_read(&cache->rht.nelems) >= MESH_FAST_TX_CACHE_MAX_SIZE)
+		return;
+
+	chanctx_conf = rcu_dereference(sdata->vif.bss_conf.chanctx_conf);
+	if (!chanctx_conf)
+		return;
+
+	sta = rcu_dereference(mpath->next_hop);
+	if (!sta)
+		return;
+
+	switch (meshhdr->flags & MESH_FLAGS_AE) {
+	case 0:
+		build.key.type = MESH_FAST_TX_TYPE_LOCAL;
+		memcpy(build.key.addr, mpath->dst, ETH_ALEN);
+		break;
+	case MESH_FLAGS_AE_A5_A6:
+		if (ether_addr_equal(meshhdr->eaddr2, sdata->vif.addr))
+			build.key.type = MESH_FAST_TX_TYPE_LOCAL;
+		else
+			build.key.type = MESH_FAST_TX_TYPE_PROXIED;
+
+		/* keep the mpp entry of a proxied destination alive */
+		mppath = mpp_path_lookup(sdata, meshhdr->eaddr1);
+		if (mppath && !ether_addr_equal(mppath->mpp, mpath->dst))
+			return;
+
+		build.mppath = mppath;
+		memcpy(build.key.addr, meshhdr->eaddr1, ETH_ALEN);
+		break;
+	default:
+		return;
+	}
+
+	/* rate limit, in case fast xmit can't be enabled */
+	if (mpath->fast_tx_check == jiffies)
+		return;
+
+	mpath->fast_tx_check = jiffies;
+
+	/*
+	 * Same use of the sta lock as in ieee80211_check_fast_xmit, in order
+	 * to protect against concurrent sta key updates.
+	 */
+	spin_lock_bh(&sta->lock);
+	key = rcu_access_pointer(sta->ptk[sta->ptk_idx]);
+	if (!key)
+		key = rcu_access_pointer(sdata->default_unicast_key);
+	build.fast_tx.key = key;
+
+	if (key) {
+		bool gen_iv, iv_spc;
+
+		gen_iv = key->conf.flags & IEEE80211_KEY_FLAG_GENERATE_IV;
+		iv_spc = key->conf.flags & IEEE80211_KEY_FLAG_PUT_IV_SPACE;
+
+		if (!(key->flags & KEY_FLAG_UPLOADED_TO_HARDWARE) ||
+		    (key->flags & KEY_FLAG_TAINTED))
+			goto unlock_sta;
+
+		switch (key->conf.cipher) {
+		case WLAN_CIPHER_SUITE_CCMP:
+		case WLAN_CIPHER_SUITE_CCMP_256:
+			if (gen_iv)
+				build.fast_tx.pn_offs = build.fast_tx.hdr_len;
+			if (gen_iv || iv_spc)
+				build.fast_tx.hdr_len += IEEE80211_CCMP_HDR_LEN;
+			break;
+		case WLAN_CIPHER_SUITE_GCMP:
+		case WLAN_CIPHER_SUITE_GCMP_256:
+			if (gen_iv)
+				build.fast_tx.pn_offs = build.fast_tx.hdr_len;
+			if (gen_iv || iv_spc)
+				build.fast_tx.hdr_len += IEEE80211_GCMP_HDR_LEN;
+			break;
+		default:
+			goto unlock_sta;
+		}
+	}
+
+	build.timestamp = jiffies;
+	build.fast_tx.band = chanctx_conf->def.chan->band;
+	build.fast_tx.da_offs = offsetof(struct ieee80211_hdr, addr3);
+	build.fast_tx.sa_offs = offsetof(struct ieee80211_hdr, addr4);
+	build.mpath = mpath;
+	memcpy(build.hdr, meshhdr, build.hdrlen);
+	memcpy(build.hdr + build.hdrlen, rfc1042_header, sizeof(rfc1042_header));
+	build.hdrlen += sizeof(rfc1042_header);
+	memcpy(build.fast_tx.hdr, hdr, ieee80211_hdrlen(hdr->frame_control));
+
+	hdr = (struct ieee80211_hdr *)build.fast_tx.hdr;
+	if (build.fast_tx.key)
+		hdr->frame_control |= cpu_to_le16(IEEE80211_FCTL_PROTECTED);
+
+	qc = ieee80211_get_qos_ctl(hdr);
+	qc[1] |= IEEE80211_QOS_CTL_MESH_CONTROL_PRESENT >> 8;
+
+	entry = kmemdup(&build, sizeof(build), GFP_ATOMIC);
+	if (!entry)
+		goto unlock_sta;
+
+	spin_lock(&cache->walk_lock);
+
+	/* the path might have been removed while we were building the entry */
+	if ((mpath->flags & MESH_PATH_DELETED) ||
+	    (build.mppath && (build.mppath->flags & MESH_PATH_DELETED))) {
+		kfree(entry);
+		goto unlock_cache;
+	}
+
+	prev = rhashtable_lookup_get_insert_fast(&cache->rht,
+						 &entry->rhash,
+						 fast_tx_rht_params);
+	if (unlikely(IS_ERR(prev))) {
+		kfree(entry);
+		goto unlock_cache;
+	}
+
+	/*
+	 * replace any previous entry in the hash table, in case we're
+	 * replacing it with a different mpath or next hop
+	 */
+	if (unlikely(prev)) {
+		rhashtable_replace_fast(&cache->rht, &prev->rhash,
+					&entry->rhash, fast_tx_rht_params);
+		hlist_del_rcu(&prev->walk_list);
+		kfree_rcu(prev, fast_tx.rcu_head);
+	}
+
+	hlist_add_head(&entry->walk_list, &cache->walk_head);
+
+unlock_cache:
+	spin_unlock(&cache->walk_lock);
+unlock_sta:
+	spin_unlock_bh(&sta->lock);
+}
+
+/**
+ * mesh_fast_tx_gc - remove unused fast xmit cache entries
+ *
+ * @sdata: local subif
+ */
+void mesh_fast_tx_gc(struct ieee80211_sub_if_data *sdata)
+{
+	struct mesh_tx_cache *cache = &sdata->u.mesh.tx_cache;
+	struct ieee80211_mesh_fast_tx *entry;
+	struct hlist_node *n;
+
+	spin_lock_bh(&cache->walk_lock);
+	hlist_for_each_entry_safe(entry, n, &cache->walk_head, walk_list)
+		if (time_after(jiffies,
+			       entry->timestamp + MESH_FAST_TX_CACHE_TIMEOUT))
+			mesh_fast_tx_entry_free(cache, entry);
+	spin_unlock_bh(&cache->walk_lock);
+}
+
+/**
+ * mesh_fast_tx_flush_mpath - remove cache entries using a mesh path
+ *
+ * @mpath: mesh or mpp path that was changed or removed
+ */
+void mesh_fast_tx_flush_mpath(struct mesh_path *mpath)
+{
+	struct ieee80211_sub_if_data *sdata = mpath->sdata;
+	struct mesh_tx_cache *cache = &sdata->u.mesh.tx_cache;
+	struct ieee80211_mesh_fast_tx *entry;
+	struct hlist_node *n;
+
+	spin_lock_bh(&cache->walk_lock);
+	hlist_for_each_entry_safe(entry, n, &cache->walk_head, walk_list)
+		if (entry->mpath == mpath || entry->mppath == mpath)
+			mesh_fast_tx_entry_free(cache, entry);
+	spin_unlock_bh(&cache->walk_lock);
+}
+
+/**
+ * mesh_fast_tx_flush_sta - remove cache entries using a next hop station
+ *
+ * @sdata: local subif
+ * @sta: next hop whose keys or state changed
+ */
+void mesh_fast_tx_flush_sta(struct ieee80211_sub_if_data *sdata,
+			    struct sta_info *sta)
+{
+	struct mesh_tx_cache *cache = &sdata->u.mesh.tx_cache;
+	struct ieee80211_mesh_fast_tx *entry;
+	struct hlist_node *n;
+
+	spin_lock_bh(&cache->walk_lock);
+	hlist_for_each_entry_safe(entry, n, &cache->walk_head, walk_list)
+		if (rcu_access_pointer(entry->mpath->next_hop) == sta)
+			mesh_fast_tx_entry_free(cache, entry);
+	spin_unlock_bh(&cache->walk_lock);
+}
+
+/**
+ * mesh_fast_tx_flush_addr - remove the cache entries for a destination
+ *
+ * @sdata: local subif
+ * @addr: Ethernet DA of the entries to remove
+ */
+void mesh_fast_tx_flush_addr(struct ieee80211_sub_if_data *sdata,
+			     const u8 *addr)
+{
+	struct mesh_tx_cache *cache = &sdata->u.mesh.tx_cache;
+	struct ieee80211_mesh_fast_tx_key key = {};
+	struct ieee80211_mesh_fast_tx *entry;
+	int i;
+
+	ether_addr_copy(key.addr, addr);
+	spin_lock_bh(&cache->walk_lock);
+	for (i = 0; i < NUM_MESH_FAST_TX_TYPE; i++) {
+		key.type = i;
+		entry = rhashtable_lookup_fast(&cache->rht, &key,
+					       fast_tx_rht_params);
+		if (entry)
+			mesh_fast_tx_entry_free(cache, entry);
+	}
+	spin_unlock_bh(&cache->walk_lock);
 }
 
 /**
@@ -81,6 +496,11 @@ void mesh_path_assign_nexthop(struct mesh_path *mpath, struct sta_info *sta)
 	struct ieee80211_hdr *hdr;
 	unsigned long flags;
 
+	if (rcu_access_pointer(mpath->next_hop) != sta) {
+		mesh_fast_tx_flush_mpath(mpath);
+		mesh_path_move_nexthop(mpath, sta);
+	}
+
 	rcu_assign_pointer(mpath->next_hop, sta);
 
 	spin_lock_irqsave(&mpath->frame_queue.lock, flags);
@@ -206,9 +626,17 @@ static void mesh_path_move_to_queue(struct mesh_path *gate_mpath,
 static struct mesh_path *mpath_lookup(struct mesh_table *tbl, const u8 *dst,
 				      struct ieee80211_sub_if_data *sdata)
 {
-	struct mesh_path *mpath;
+	struct mesh_path *mpath = NULL;
 
-	mpath = rhashtable_lookup(&tbl->rhead, dst, mesh_rht_params);
+	if (tbl->last_hit)
+		mpath = READ_ONCE(*raw_cpu_ptr(tbl->last_hit));
+
+	if (!mpath || !ether_addr_equal(mpath->dst, dst) ||
+	    (READ_ONCE(mpath->flags) & MESH_PATH_DELETED)) {
+		mpath = rhashtable_lookup(&tbl->rhead, dst, mesh_rht_params);
+		if (mpath)
+			mesh_table_cache_store(tbl, mpath);
+	}
 
 	if (mpath && mpath_expired(mpath)) {
 		spin_lock_bh(&mpath->state_lock);
@@ -464,6 +892,8 @@ int mpp_path_add(struct ieee80211_sub_if_data *sdata,
 
 	if (ret)
 		kfree(new_mpath);
+	else
+		mesh_fast_tx_flush_addr(sdata, dst);
 
 	sdata->u.mesh.mpp_paths_generation++;
 	return ret;
@@ -484,9 +914,14 @@ void mesh_plink_broken(struct sta_info *sta)
 	struct mesh_table *tbl = &sdata->u.mesh.mesh_paths;
 	static const u8 bcast[ETH_ALEN] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
 	struct mesh_path *mpath;
+	unsigned int gen;
 
 	rcu_read_lock();
-	hlist_for_each_entry_rcu(mpath, &tbl->walk_head, walk_list) {
+restart:
+	gen = READ_ONCE(tbl->nexthop_gen);
+	smp_rmb();
+	hlist_for_each_entry_rcu(mpath, &sta->mesh->nexthop_paths,
+				 nexthop_list) {
 		if (rcu_access_pointer(mpath->next_hop) == sta &&
 		    mpath->flags & MESH_PATH_ACTIVE &&
 		    !(mpath->flags & MESH_PATH_FIXED)) {
@@ -500,6 +935,14 @@ void mesh_plink_broken(struct sta_info *sta)
 				WLAN_REASON_MESH_PATH_DEST_UNREACHABLE, bcast);
 		}
 	}
+
+	/* A path that moved to another next hop while we walked the list may
+	 * have taken us off this STA's list; deactivation is idempotent, so
+	 * just walk it again.
+	 */
+	smp_rmb();
+	if (READ_ONCE(tbl->nexthop_gen) != gen)
+		goto restart;
 	rcu_read_unlock();
 }
 
@@ -512,6 +955,14 @@ static void mesh_path_free_rcu(struct mesh_table *tbl,
 	mpath->flags |= MESH_PATH_RESOLVING | MESH_PATH_DELETED;
 	mesh_gate_del(tbl, mpath);
 	spin_unlock_bh(&mpath->state_lock);
+	mesh_table_cache_evict(tbl, mpath);
+	if (tbl == &sdata->u.mesh.mesh_paths) {
+		spin_lock_bh(&tbl->nexthop_lock);
+		if (!hlist_unhashed(&mpath->nexthop_list))
+			hlist_del_init_rcu(&mpath->nexthop_list);
+		spin_unlock_bh(&tbl->nexthop_lock);
+	}
+	mesh_fast_tx_flush_mpath(mpath);
 	del_timer_sync(&mpath->timer);
 	atomic_dec(&sdata->u.mesh.mpaths);
 	atomic_dec(&tbl->entries);
@@ -536,18 +987,27 @@ static void __mesh_path_del(struct mesh_table *tbl, struct mesh_path *mpath)
  * allows path creation. This will happen before the sta can be freed (because
  * sta_info_destroy() calls this) so any reader in a rcu read block will be
  * protected against the plink disappearing.
+ *
+ * Only the paths on the STA's next hop list are visited. With walk_lock held
+ * every path on that list is still in the table, and deleting it unlinks it.
  */
 void mesh_path_flush_by_nexthop(struct sta_info *sta)
 {
 	struct ieee80211_sub_if_data *sdata = sta->sdata;
 	struct mesh_table *tbl = &sdata->u.mesh.mesh_paths;
 	struct mesh_path *mpath;
-	struct hlist_node *n;
 
 	spin_lock_bh(&tbl->walk_lock);
-	hlist_for_each_entry_safe(mpath, n, &tbl->walk_head, walk_list) {
-		if (rcu_access_pointer(mpath->next_hop) == sta)
-			__mesh_path_del(tbl, mpath);
+	for (;;) {
+		spin_lock(&tbl->nexthop_lock);
+		mpath = hlist_entry_safe(sta->mesh->nexthop_paths.first,
+					 struct mesh_path, nexthop_list);
+		spin_unlock(&tbl->nexthop_lock);
+
+		if (!mpath)
+			break;
+
+		__mesh_path_del(tbl, mpath);
 	}
 	spin_unlock_bh(&tbl->walk_lock);
 }
@@ -758,22 +1218,42 @@ void mesh_pathtbl_init(struct ieee80211_sub_if_data *sdata)
 {
 	mesh_table_init(&sdata->u.mesh.mesh_paths);
 	mesh_table_init(&sdata->u.mesh.mpp_paths);
+	mesh_fast_tx_init(sdata);
 }
 
 static
 void mesh_path_tbl_expire(struct ieee80211_sub_if_data *sdata,
 			  struct mesh_table *tbl)
 {
+	unsigned long next = jiffies + MESH_PATH_EXPIRE;
 	struct mesh_path *mpath;
 	struct hlist_node *n;
 
+	/* exp_time is only ever set to the current time or later, so no path
+	 * can have expired before the earliest deadline seen by the last walk
+	 */
+	if (time_before(jiffies, READ_ONCE(tbl->next_expire)))
+		return;
+
 	spin_lock_bh(&tbl->walk_lock);
 	hlist_for_each_entry_safe(mpath, n, &tbl->walk_head, walk_list) {
-		if ((!(mpath->flags & MESH_PATH_RESOLVING)) &&
-		    (!(mpath->flags & MESH_PATH_FIXED)) &&
-		     time_after(jiffies, mpath->exp_time + MESH_PATH_EXPIRE))
+		unsigned long deadline = mpath->exp_time + MESH_PATH_EXPIRE;
+
+		if (mpath->flags & MESH_PATH_FIXED)
+			continue;
+
+		/* check again on the next run */
+		if (mpath->flags & MESH_PATH_RESOLVING) {
+			next = jiffies;
+			continue;
+		}
+
+		if (time_after(jiffies, deadline))
 			__mesh_path_del(tbl, mpath);
+		else if (time_before(deadline, next))
+			next = deadline;
 	}
+	WRITE_ONCE(tbl->next_expire, next);
 	spin_unlock_bh(&tbl->walk_lock);
 }
 
@@ -781,10 +1261,12 @@ void mesh_path_expire(struct ieee80211_sub_if_data *sdata)
 {
 	mesh_path_tbl_expire(sdata, &sdata->u.mesh.mesh_paths);
 	mesh_path_tbl_expire(sdata, &sdata->u.mesh.mpp_paths);
+	mesh_fast_tx_gc(sdata);
 }
 
 void mesh_pathtbl_unregister(struct ieee80211_sub_if_data *sdata)
 {
 	mesh_table_free(&sdata->u.mesh.mesh_paths);
 	mesh_table_free(&sdata->u.mesh.mpp_paths);
+	mesh_fast_tx_deinit(sdata);
 }
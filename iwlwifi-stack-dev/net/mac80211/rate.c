@@ -533,6 +533,10 @@ static void rate_idx_match_mask(s8 *rate_idx, u16 *rate_flags,
 				u8 mcs_mask[IEEE80211_HT_MCS_MASK_LEN],
 				u16 vht_mask[NL80211_VHT_NSS_MAX])
 {
+	/* there are no HE/EHT rate masks, leave such rates untouched */
+	if ((*rate_flags & IEEE80211_TX_RC_HE_MCS) == IEEE80211_TX_RC_HE_MCS)
+		return;
+
 	if (*rate_flags & IEEE80211_TX_RC_VHT_MCS) {
 		/* handle VHT rates */
 		if (rate_idx_match_vht_mcs_mask(rate_idx, vht_mask))
@@ -681,6 +685,16 @@ static void rate_fixup_ratelist(struct ieee80211_vif *vif,
 			continue;
 		}
 
+		if (ieee80211_rate_is_eht(&rates[i])) {
+			WARN_ON(ieee80211_rate_get_vht_mcs(&rates[i]) > 13);
+			continue;
+		}
+
+		if (ieee80211_rate_is_he(&rates[i])) {
+			WARN_ON(ieee80211_rate_get_vht_mcs(&rates[i]) > 11);
+			continue;
+		}
+
 		if (rates[i].flags & IEEE80211_TX_RC_VHT_MCS) {
 			WARN_ON(ieee80211_rate_get_vht_mcs(&rates[i]) > 9);
 			continue;
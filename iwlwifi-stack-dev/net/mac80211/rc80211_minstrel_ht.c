@@ -35,9 +35,33 @@
 #define MCS_DURATION(streams, sgi, bps) \
 	(MCS_SYMBOL_TIME(sgi, MCS_NSYMS((streams) * (bps))) / AVG_AMPDU_SIZE)
 
+/*
+ * Number of 1/16 symbols for a HE/EHT packet with (bps) bits per symbol.
+ * At the highest EHT rates an average A-MPDU fits into a single symbol, so
+ * use fractional symbols to still be able to tell the rates apart.
+ */
+#define HE_NSYMS_16(bps) DIV_ROUND_UP(MCS_NBITS << 4, (bps))
+
+/* These should match the values in enum nl80211_he_gi */
+#define HE_GI_08		0
+#define HE_GI_16		1
+
+/* Transmission time (nanoseconds) for a packet containing (syms16) symbols/16 */
+#define HE_SYMBOL_TIME(gi, syms16)					\
+	(gi == HE_GI_08 ?						\
+	  ((syms16) * 13600) >> 4 :	/* syms * 13.6 us */		\
+	  ((syms16) * 14400) >> 4	/* syms * 14.4 us */		\
+	)
+
+/* Transmit duration for the raw data part of an average sized packet */
+#define HE_DURATION(streams, gi, bps) \
+	(HE_SYMBOL_TIME(gi, HE_NSYMS_16((streams) * (bps))) / AVG_AMPDU_SIZE)
+
 #define BW_20			0
 #define BW_40			1
 #define BW_80			2
+#define BW_160			3
+#define BW_320			4
 
 /*
  * Define group sort order: HT40 -> SGI -> #streams
@@ -133,6 +157,112 @@
 	__VHT_GROUP(_streams, _sgi, _bw,				\
 		    VHT_GROUP_SHIFT(_streams, _sgi, _bw))
 
+#define HE_GROUP_IDX(_streams, _gi, _bw)				\
+	(MINSTREL_HE_GROUP_0 +						\
+	 MINSTREL_MAX_STREAMS * 2 * (_bw) +				\
+	 MINSTREL_MAX_STREAMS * (_gi) +					\
+	 (_streams) - 1)
+
+#define HE_DCM_GROUP_IDX(_streams, _gi, _bw)				\
+	(MINSTREL_HE_DCM_GROUP_0 +					\
+	 MINSTREL_HE_DCM_STREAMS * 2 * (_bw) +				\
+	 MINSTREL_HE_DCM_STREAMS * (_gi) +				\
+	 (_streams) - 1)
+
+#define EHT_GROUP_IDX(_streams, _gi, _bw)				\
+	(MINSTREL_EHT_GROUP_0 +						\
+	 MINSTREL_MAX_STREAMS * 2 * (_bw) +				\
+	 MINSTREL_MAX_STREAMS * (_gi) +					\
+	 (_streams) - 1)
+
+#define BW2HEBPS(_bw, r5, r4, r3, r2, r1)				\
+	(_bw == BW_320 ? r5 : _bw == BW_160 ? r4 : _bw == BW_80 ? r3 :	\
+	 _bw == BW_40 ? r2 : r1)
+
+#define HE_BW_FLAGS(_bw)						\
+	(_bw == BW_320 ? IEEE80211_TX_RC_320_MHZ_WIDTH :		\
+	 _bw == BW_160 ? IEEE80211_TX_RC_160_MHZ_WIDTH :		\
+	 _bw == BW_80 ? IEEE80211_TX_RC_80_MHZ_WIDTH :			\
+	 _bw == BW_40 ? IEEE80211_TX_RC_40_MHZ_WIDTH : 0)
+
+/* DCM transmits every bit twice, halving the data rate */
+#define HE_DURATION_LIST(_streams, _gi, _bw, _dcm, _s)			\
+	(HE_DURATION(_streams, _gi,					\
+		     BW2HEBPS(_bw,  1960,   980,  490,  234,  117)) << _dcm) >> _s, \
+	(HE_DURATION(_streams, _gi,					\
+		     BW2HEBPS(_bw,  3920,  1960,  980,  468,  234)) << _dcm) >> _s, \
+	(HE_DURATION(_streams, _gi,					\
+		     BW2HEBPS(_bw,  5880,  2940, 1470,  702,  351)) << _dcm) >> _s, \
+	(HE_DURATION(_streams, _gi,					\
+		     BW2HEBPS(_bw,  7840,  3920, 1960,  936,  468)) << _dcm) >> _s, \
+	(HE_DURATION(_streams, _gi,					\
+		     BW2HEBPS(_bw, 11760,  5880, 2940, 1404,  702)) << _dcm) >> _s, \
+	(HE_DURATION(_streams, _gi,					\
+		     BW2HEBPS(_bw, 15680,  7840, 3920, 1872,  936)) << _dcm) >> _s, \
+	(HE_DURATION(_streams, _gi,					\
+		     BW2HEBPS(_bw, 17640,  8820, 4410, 2106, 1053)) << _dcm) >> _s, \
+	(HE_DURATION(_streams, _gi,					\
+		     BW2HEBPS(_bw, 19600,  9800, 4900, 2340, 1170)) << _dcm) >> _s, \
+	(HE_DURATION(_streams, _gi,					\
+		     BW2HEBPS(_bw, 23520, 11760, 5880, 2808, 1404)) << _dcm) >> _s, \
+	(HE_DURATION(_streams, _gi,					\
+		     BW2HEBPS(_bw, 26133, 13066, 6533, 3120, 1560)) << _dcm) >> _s, \
+	(HE_DURATION(_streams, _gi,					\
+		     BW2HEBPS(_bw, 29400, 14700, 7350, 3510, 1755)) << _dcm) >> _s, \
+	(HE_DURATION(_streams, _gi,					\
+		     BW2HEBPS(_bw, 32666, 16333, 8166, 3900, 1950)) << _dcm) >> _s
+
+#define HE_GROUP_SHIFT(_streams, _gi, _bw, _dcm)			\
+	GROUP_SHIFT(HE_DURATION(_streams, _gi,				\
+				BW2HEBPS(_bw, 1960, 980, 490, 234, 117)) << _dcm)
+
+#define __HE_GROUP(_idx, _streams, _gi, _bw, _dcm, _s)			\
+	[_idx] = {							\
+	.streams = _streams,						\
+	.shift = _s,							\
+	.bw = _bw,							\
+	.flags =							\
+		IEEE80211_TX_RC_HE_MCS |				\
+		(_gi == HE_GI_08 ? IEEE80211_TX_RC_SHORT_GI : 0) |	\
+		(_dcm ? IEEE80211_TX_RC_HE_DCM : 0) |			\
+		HE_BW_FLAGS(_bw),					\
+	.duration = {							\
+		HE_DURATION_LIST(_streams, _gi, _bw, _dcm, _s)		\
+	}								\
+}
+
+#define HE_GROUP(_streams, _gi, _bw)					\
+	__HE_GROUP(HE_GROUP_IDX(_streams, _gi, _bw),			\
+		   _streams, _gi, _bw, 0,				\
+		   HE_GROUP_SHIFT(_streams, _gi, _bw, 0))
+
+#define HE_DCM_GROUP(_streams, _gi, _bw)				\
+	__HE_GROUP(HE_DCM_GROUP_IDX(_streams, _gi, _bw),		\
+		   _streams, _gi, _bw, 1,				\
+		   HE_GROUP_SHIFT(_streams, _gi, _bw, 1))
+
+#define __EHT_GROUP(_streams, _gi, _bw, _s)				\
+	[EHT_GROUP_IDX(_streams, _gi, _bw)] = {			\
+	.streams = _streams,						\
+	.shift = _s,							\
+	.bw = _bw,							\
+	.flags =							\
+		IEEE80211_TX_RC_EHT_MCS |				\
+		(_gi == HE_GI_08 ? IEEE80211_TX_RC_SHORT_GI : 0) |	\
+		HE_BW_FLAGS(_bw),					\
+	.duration = {							\
+		HE_DURATION_LIST(_streams, _gi, _bw, 0, _s),		\
+		HE_DURATION(_streams, _gi,				\
+			    BW2HEBPS(_bw, 35280, 17640, 8820, 4212, 2106)) >> _s, \
+		HE_DURATION(_streams, _gi,				\
+			    BW2HEBPS(_bw, 39200, 19600, 9800, 4680, 2340)) >> _s \
+	}								\
+}
+
+#define EHT_GROUP(_streams, _gi, _bw)					\
+	__EHT_GROUP(_streams, _gi, _bw,					\
+		    HE_GROUP_SHIFT(_streams, _gi, _bw, 0))
+
 #define CCK_DURATION(_bitrate, _short)			\
 	(1000 * (10 /* SIFS */ +			\
 	 (_short ? 72 + 24 : 144 + 48) +		\
@@ -198,6 +328,11 @@ module_param(minstrel_vht_only, bool, 0644);
 MODULE_PARM_DESC(minstrel_vht_only,
 		 "Use only VHT rates when VHT is supported by sta.");
 
+static bool minstrel_he_only = true;
+module_param(minstrel_he_only, bool, 0644);
+MODULE_PARM_DESC(minstrel_he_only,
+		 "Use only HE/EHT rates when HE is supported by sta.");
+
 /*
  * To enable sufficiently targeted rate sampling, MCS rates are divided into
  * groups, based on the number of streams and flags (HT40, SGI) that they
@@ -205,6 +340,9 @@ MODULE_PARM_DESC(minstrel_vht_only,
  *
  * Sortorder has to be fixed for GROUP_IDX macro to be applicable:
  * BW -> SGI -> #streams
+ *
+ * HE, HE DCM and EHT groups follow the same order, with the 0.8us guard
+ * interval sorted before the 1.6us one.
  */
 const struct mcs_group minstrel_mcs_groups[] = {
 	MCS_GROUP(1, 0, BW_20),
@@ -259,6 +397,120 @@ const struct mcs_group minstrel_mcs_groups[] = {
 	VHT_GROUP(2, 1, BW_80),
 	VHT_GROUP(3, 1, BW_80),
 	VHT_GROUP(4, 1, BW_80),
+
+	HE_GROUP(1, HE_GI_08, BW_20),
+	HE_GROUP(2, HE_GI_08, BW_20),
+	HE_GROUP(3, HE_GI_08, BW_20),
+	HE_GROUP(4, HE_GI_08, BW_20),
+
+	HE_GROUP(1, HE_GI_16, BW_20),
+	HE_GROUP(2, HE_GI_16, BW_20),
+	HE_GROUP(3, HE_GI_16, BW_20),
+	HE_GROUP(4, HE_GI_16, BW_20),
+
+	HE_GROUP(1, HE_GI_08, BW_40),
+	HE_GROUP(2, HE_GI_08, BW_40),
+	HE_GROUP(3, HE_GI_08, BW_40),
+	HE_GROUP(4, HE_GI_08, BW_40),
+
+	HE_GROUP(1, HE_GI_16, BW_40),
+	HE_GROUP(2, HE_GI_16, BW_40),
+	HE_GROUP(3, HE_GI_16, BW_40),
+	HE_GROUP(4, HE_GI_16, BW_40),
+
+	HE_GROUP(1, HE_GI_08, BW_80),
+	HE_GROUP(2, HE_GI_08, BW_80),
+	HE_GROUP(3, HE_GI_08, BW_80),
+	HE_GROUP(4, HE_GI_08, BW_80),
+
+	HE_GROUP(1, HE_GI_16, BW_80),
+	HE_GROUP(2, HE_GI_16, BW_80),
+	HE_GROUP(3, HE_GI_16, BW_80),
+	HE_GROUP(4, HE_GI_16, BW_80),
+
+	HE_GROUP(1, HE_GI_08, BW_160),
+	HE_GROUP(2, HE_GI_08, BW_160),
+	HE_GROUP(3, HE_GI_08, BW_160),
+	HE_GROUP(4, HE_GI_08, BW_160),
+
+	HE_GROUP(1, HE_GI_16, BW_160),
+	HE_GROUP(2, HE_GI_16, BW_160),
+	HE_GROUP(3, HE_GI_16, BW_160),
+	HE_GROUP(4, HE_GI_16, BW_160),
+
+	HE_DCM_GROUP(1, HE_GI_08, BW_20),
+	HE_DCM_GROUP(2, HE_GI_08, BW_20),
+
+	HE_DCM_GROUP(1, HE_GI_16, BW_20),
+	HE_DCM_GROUP(2, HE_GI_16, BW_20),
+
+	HE_DCM_GROUP(1, HE_GI_08, BW_40),
+	HE_DCM_GROUP(2, HE_GI_08, BW_40),
+
+	HE_DCM_GROUP(1, HE_GI_16, BW_40),
+	HE_DCM_GROUP(2, HE_GI_16, BW_40),
+
+	HE_DCM_GROUP(1, HE_GI_08, BW_80),
+	HE_DCM_GROUP(2, HE_GI_08, BW_80),
+
+	HE_DCM_GROUP(1, HE_GI_16, BW_80),
+	HE_DCM_GROUP(2, HE_GI_16, BW_80),
+
+	HE_DCM_GROUP(1, HE_GI_08, BW_160),
+	HE_DCM_GROUP(2, HE_GI_08, BW_160),
+
+	HE_DCM_GROUP(1, HE_GI_16, BW_160),
+	HE_DCM_GROUP(2, HE_GI_16, BW_160),
+
+	EHT_GROUP(1, HE_GI_08, BW_20),
+	EHT_GROUP(2, HE_GI_08, BW_20),
+	EHT_GROUP(3, HE_GI_08, BW_20),
+	EHT_GROUP(4, HE_GI_08, BW_20),
+
+	EHT_GROUP(1, HE_GI_16, BW_20),
+	EHT_GROUP(2, HE_GI_16, BW_20),
+	EHT_GROUP(3, HE_GI_16, BW_20),
+	EHT_GROUP(4, HE_GI_16, BW_20),
+
+	EHT_GROUP(1, HE_GI_08, BW_40),
+	EHT_GROUP(2, HE_GI_08, BW_40),
+	EHT_GROUP(3, HE_GI_08, BW_40),
+	EHT_GROUP(4, HE_GI_08, BW_40),
+
+	EHT_GROUP(1, HE_GI_16, BW_40),
+	EHT_GROUP(2, HE_GI_16, BW_40),
+	EHT_GROUP(3, HE_GI_16, BW_40),
+	EHT_GROUP(4, HE_GI_16, BW_40),
+
+	EHT_GROUP(1, HE_GI_08, BW_80),
+	EHT_GROUP(2, HE_GI_08, BW_80),
+	EHT_GROUP(3, HE_GI_08, BW_80),
+	EHT_GROUP(4, HE_GI_08, BW_80),
+
+	EHT_GROUP(1, HE_GI_16, BW_80),
+	EHT_GROUP(2, HE_GI_16, BW_80),
+	EHT_GROUP(3, HE_GI_16, BW_80),
+	EHT_GROUP(4, HE_GI_16, BW_80),
+
+	EHT_GROUP(1, HE_GI_08, BW_160),
+	EHT_GROUP(2, HE_GI_08, BW_160),
+	EHT_GROUP(3, HE_GI_08, BW_160),
+	EHT_GROUP(4, HE_GI_08, BW_160),
+
+	EHT_GROUP(1, HE_GI_16, BW_160),
+	EHT_GROUP(2, HE_GI_16, BW_160),
+	EHT_GROUP(3, HE_GI_16, BW_160),
+	EHT_GROUP(4, HE_GI_16, BW_160),
+
+	EHT_GROUP(1, HE_GI_08, BW_320),
+	EHT_GROUP(2, HE_GI_08, BW_320),
+	EHT_GROUP(3, HE_GI_08, BW_320),
+	EHT_GROUP(4, HE_GI_08, BW_320),
+
+	EHT_GROUP(1, HE_GI_16, BW_320),
+	EHT_GROUP(2, HE_GI_16, BW_320),
+	EHT_GROUP(3, HE_GI_16, BW_320),
+	EHT_GROUP(4, HE_GI_16, BW_320),
 };
 
 const s16 minstrel_cck_bitrates[4] = { 10, 20, 55, 110 };
@@ -315,6 +567,108 @@ minstrel_get_valid_vht_rates(int bw, int nss, __le16 mcs_map)
 	return 0x3ff & ~mask;
 }
 
+/*
+ * Returns the valid mcs map for an HE group, taking the DCM capabilities of
+ * the station into account for DCM groups (only MCS 0, 1, 3 and 4 can use DCM)
+ */
+static u16
+minstrel_get_valid_he_rates(struct ieee80211_sta *sta, int bw, int nss,
+			    bool dcm)
+{
+	const struct ieee80211_sta_he_cap *he_cap = &sta->deflink.he_cap;
+	u8 phy_cap = he_cap->he_cap_elem.phy_cap_info[3];
+	u16 mcs_map, mask;
+
+	if (bw == BW_160)
+		mcs_map = le16_to_cpu(he_cap->he_mcs_nss_supp.rx_mcs_160);
+	else
+		mcs_map = le16_to_cpu(he_cap->he_mcs_nss_supp.rx_mcs_80);
+
+	switch ((mcs_map >> (2 * (nss - 1))) & 3) {
+	case IEEE80211_HE_MCS_SUPPORT_0_7:
+		mask = GENMASK(7, 0);
+		break;
+	case IEEE80211_HE_MCS_SUPPORT_0_9:
+		mask = GENMASK(9, 0);
+		break;
+	case IEEE80211_HE_MCS_SUPPORT_0_11:
+		mask = GENMASK(11, 0);
+		break;
+	default:
+		return 0;
+	}
+
+	if (!dcm)
+		return mask;
+
+	if (nss > 1 && !(phy_cap & IEEE80211_HE_PHY_CAP3_DCM_MAX_RX_NSS_2))
+		return 0;
+
+	switch (phy_cap & IEEE80211_HE_PHY_CAP3_DCM_MAX_CONST_RX_MASK) {
+	case IEEE80211_HE_PHY_CAP3_DCM_MAX_CONST_RX_BPSK:
+		return mask & BIT(0);
+	case IEEE80211_HE_PHY_CAP3_DCM_MAX_CONST_RX_QPSK:
+		return mask & (BIT(0) | BIT(1));
+	case IEEE80211_HE_PHY_CAP3_DCM_MAX_CONST_RX_16_QAM:
+		return mask & (BIT(0) | BIT(1) | BIT(3) | BIT(4));
+	default:
+		return 0;
+	}
+}
+
+/*
+ * Returns the valid mcs map for an EHT group, based on the maximum number of
+ * spatial streams the station can receive for each MCS range
+ */
+static u16
+minstrel_get_valid_eht_rates(struct ieee80211_sta *sta, int bw, int nss)
+{
+	const struct ieee80211_eht_mcs_nss_supp *mcs_nss =
+		&sta->deflink.eht_cap.eht_mcs_nss_supp;
+	const struct ieee80211_eht_mcs_nss_supp_bw *mcs_bw;
+	u8 he_phy_cap = sta->deflink.he_cap.he_cap_elem.phy_cap_info[0];
+	u16 mask = 0;
+
+	if (!(he_phy_cap & IEEE80211_HE_PHY_CAP0_CHANNEL_WIDTH_SET_MASK_ALL)) {
+		const struct ieee80211_eht_mcs_nss_supp_20mhz_only *mcs_20 =
+			&mcs_nss->only_20mhz;
+
+		if (nss <= u8_get_bits(mcs_20->rx_tx_mcs7_max_nss,
+				       IEEE80211_EHT_MCS_NSS_RX))
+			mask |= GENMASK(7, 0);
+		if (nss <= u8_get_bits(mcs_20->rx_tx_mcs9_max_nss,
+				       IEEE80211_EHT_MCS_NSS_RX))
+			mask |= GENMASK(9, 8);
+		if (nss <= u8_get_bits(mcs_20->rx_tx_mcs11_max_nss,
+				       IEEE80211_EHT_MCS_NSS_RX))
+			mask |= GENMASK(11, 10);
+		if (nss <= u8_get_bits(mcs_20->rx_tx_mcs13_max_nss,
+				       IEEE80211_EHT_MCS_NSS_RX))
+			mask |= GENMASK(13, 12);
+
+		return mask;
+	}
+
+	if (bw == BW_320)
+		mcs_bw = &mcs_nss->bw._320;
+	else if (bw == BW_160)
+		mcs_bw = &mcs_nss->bw._160;
+	else
+		mcs_bw = &mcs_nss->bw._80;
+
+	if (nss <= u8_get_bits(mcs_bw->rx_tx_mcs9_max_nss,
+			       IEEE80211_EHT_MCS_NSS_RX))
+		mask |= GENMASK(9, 0);
+	if (nss <= u8_get_bits(mcs_bw->rx_tx_mcs11_max_nss,
+			       IEEE80211_EHT_MCS_NSS_RX))
+		mask |= GENMASK(11, 10);
+	if (nss <= u8_get_bits(mcs_bw->rx_tx_mcs13_max_nss,
+			       IEEE80211_EHT_MCS_NSS_RX))
+		mask |= GENMASK(13, 12);
+
+	return mask;
+}
+
 static bool
 minstrel_ht_is_legacy_group(int group)
 {
@@ -322,6 +676,37 @@ minstrel_ht_is_legacy_group(int group)
 	       group == MINSTREL_OFDM_GROUP;
 }
 
+static bool
+minstrel_ht_is_he_group(int group)
+{
+	return group >= MINSTREL_HE_GROUP_0 &&
+	       group < MINSTREL_EHT_GROUP_0;
+}
+
+static bool
+minstrel_ht_is_he_dcm_group(int group)
+{
+	return group >= MINSTREL_HE_DCM_GROUP_0 &&
+	       group < MINSTREL_EHT_GROUP_0;
+}
+
+static bool
+minstrel_ht_is_eht_group(int group)
+{
+	return group >= MINSTREL_EHT_GROUP_0;
+}
+
+/*
+ * HE and EHT stations without HT capabilities (e.g. on 6 GHz) still use
+ * aggregation, so treat them like HT stations
+ */
+static bool
+minstrel_ht_sta_has_mcs(struct ieee80211_sta *sta)
+{
+	return sta->deflink.ht_cap.ht_supported ||
+	       sta->deflink.he_cap.has_he;
+}
+
 /*
  * Look up an MCS group index based on mac80211 rate information
  */
@@ -344,6 +729,81 @@ minstrel_ht_ri_get_group_idx(struct rate_info *rate)
 			 !!(rate->bw & RATE_INFO_BW_40));
 }
 
+static int
+minstrel_he_get_bw(u16 flags)
+{
+	if ((flags & IEEE80211_TX_RC_320_MHZ_WIDTH) ==
+	    IEEE80211_TX_RC_320_MHZ_WIDTH)
+		return BW_320;
+	if (flags & IEEE80211_TX_RC_160_MHZ_WIDTH)
+		return BW_160;
+	if (flags & IEEE80211_TX_RC_80_MHZ_WIDTH)
+		return BW_80;
+	if (flags & IEEE80211_TX_RC_40_MHZ_WIDTH)
+		return BW_40;
+	return BW_20;
+}
+
+static int
+minstrel_he_ri_get_bw(struct rate_info *rate)
+{
+	switch (rate->bw) {
+	case RATE_INFO_BW_320:
+		return BW_320;
+	case RATE_INFO_BW_160:
+		return BW_160;
+	case RATE_INFO_BW_80:
+		return BW_80;
+	case RATE_INFO_BW_40:
+		return BW_40;
+	default:
+		return BW_20;
+	}
+}
+
+/*
+ * Look up an HE/EHT group index based on mac80211 rate information
+ */
+static int
+minstrel_he_get_group_idx(struct ieee80211_tx_rate *rate)
+{
+	int nss = ieee80211_rate_get_vht_nss(rate);
+	int gi = rate->flags & IEEE80211_TX_RC_SHORT_GI ? HE_GI_08 : HE_GI_16;
+	int bw = minstrel_he_get_bw(rate->flags);
+
+	if (ieee80211_rate_is_eht(rate))
+		return EHT_GROUP_IDX(nss, gi, bw);
+
+	if (rate->flags & IEEE80211_TX_RC_HE_DCM)
+		return HE_DCM_GROUP_IDX(nss, gi, bw);
+
+	return HE_GROUP_IDX(nss, gi, bw);
+}
+
+/*
+ * Look up an HE/EHT group index based on new cfg80211 rate_info.
+ * The 3.2us guard interval isn't used by minstrel, account it to the
+ * 1.6us groups.
+ */
+static int
+minstrel_he_ri_get_group_idx(struct rate_info *rate)
+{
+	int bw = minstrel_he_ri_get_bw(rate);
+	int gi;
+
+	if (rate->flags & RATE_INFO_FLAGS_EHT_MCS) {
+		gi = rate->eht_gi == NL80211_RATE_INFO_EHT_GI_0_8 ?
+		     HE_GI_08 : HE_GI_16;
+		return EHT_GROUP_IDX(rate->nss, gi, bw);
+	}
+
+	gi = rate->he_gi == NL80211_RATE_INFO_HE_GI_0_8 ? HE_GI_08 : HE_GI_16;
+	if (rate->he_dcm)
+		return HE_DCM_GROUP_IDX(rate->nss, gi, bw);
+
+	return HE_GROUP_IDX(rate->nss, gi, bw);
+}
+
 static int
 minstrel_vht_get_group_idx(struct ieee80211_tx_rate *rate)
 {
@@ -377,6 +837,12 @@ minstrel_ht_get_stats(struct minstrel_priv *mp, struct minstrel_ht_sta *mi,
 		goto out;
 	}
 
+	if (ieee80211_rate_is_he(rate) || ieee80211_rate_is_eht(rate)) {
+		group = minstrel_he_get_group_idx(rate);
+		idx = ieee80211_rate_get_vht_mcs(rate);
+		goto out;
+	}
+
 	if (rate->flags & IEEE80211_TX_RC_VHT_MCS) {
 		group = minstrel_vht_get_group_idx(rate);
 		idx = ieee80211_rate_get_vht_mcs(rate);
@@ -430,6 +896,12 @@ minstrel_ht_ri_get_stats(struct minstrel_priv *mp, struct minstrel_ht_sta *mi,
 		goto out;
 	}
 
+	if (rate->flags & (RATE_INFO_FLAGS_HE_MCS | RATE_INFO_FLAGS_EHT_MCS)) {
+		group = minstrel_he_ri_get_group_idx(rate);
+		idx = rate->mcs;
+		goto out;
+	}
+
 	group = MINSTREL_CCK_GROUP;
 	for (idx = 0; idx < ARRAY_SIZE(mp->cck_rates); idx++) {
 		if (rate->legacy != minstrel_cck_bitrates[ mp->cck_rates[idx] ])
@@ -501,6 +973,7 @@ minstrel_ht_get_tp_avg(struct minstrel_ht_sta *mi, int group, int rate,
 {
 	unsigned int nsecs = 0, overhead = mi->overhead;
 	unsigned int ampdu_len = 1;
+	u64 tp;
 
 	/* do not account throughput if success prob is below 10% */
 	if (prob_avg < MINSTREL_FRAC(10, 100))
@@ -523,7 +996,10 @@ minstrel_ht_get_tp_avg(struct minstrel_ht_sta *mi, int group, int rate,
 	if (prob_avg > MINSTREL_FRAC(90, 100))
 		prob_avg = MINSTREL_FRAC(90, 100);
 
-	return MINSTREL_TRUNC(100 * ((prob_avg * 1000000) / nsecs));
+	/* HE/EHT durations are short enough to overflow 32 bit math here */
+	tp = div_u64((u64)prob_avg * 1000000, nsecs);
+
+	return MINSTREL_TRUNC(100 * tp);
 }
 
 /*
@@ -673,7 +1149,7 @@ minstrel_ht_prob_rate_reduce_streams(struct minstrel_ht_sta *mi)
 	int tmp_max_streams, group, tmp_idx, tmp_prob;
 	int tmp_tp = 0;
 
-	if (!mi->sta->deflink.ht_cap.ht_supported)
+	if (!minstrel_ht_sta_has_mcs(mi->sta))
 		return;
 
 	group = MI_RATE_GROUP(mi->max_tp_rate[0]);
@@ -1063,7 +1539,7 @@ minstrel_ht_update_stats(struct minstrel_priv *mp, struct minstrel_ht_sta *mi)
 	u16 tmp_mcs_tp_rate[MAX_THR_RATES], tmp_group_tp_rate[MAX_THR_RATES];
 	u16 tmp_legacy_tp_rate[MAX_THR_RATES], tmp_max_prob_rate;
 	u16 index;
-	bool ht_supported = mi->sta->deflink.ht_cap.ht_supported;
+	bool ht_supported = minstrel_ht_sta_has_mcs(mi->sta);
 
 	if (mi->ampdu_packets > 0) {
 		if (!ieee80211_hw_check(mp->hw, TX_STATUS_NO_AMPDU_LEN))
@@ -1087,7 +1563,11 @@ minstrel_ht_update_stats(struct minstrel_priv *mp, struct minstrel_ht_sta *mi)
 	for (j = 0; j < ARRAY_SIZE(tmp_legacy_tp_rate); j++)
 		tmp_legacy_tp_rate[j] = index;
 
-	if (mi->supported[MINSTREL_VHT_GROUP_0])
+	if (mi->supported[MINSTREL_EHT_GROUP_0])
+		group = MINSTREL_EHT_GROUP_0;
+	else if (mi->supported[MINSTREL_HE_GROUP_0])
+		group = MINSTREL_HE_GROUP_0;
+	else if (mi->supported[MINSTREL_VHT_GROUP_0])
 		group = MINSTREL_VHT_GROUP_0;
 	else if (ht_supported)
 		group = MINSTREL_HT_GROUP_0;
@@ -1238,6 +1718,21 @@ minstrel_ht_ri_txstat_valid(struct minstrel_priv *mp,
 	    rate_status->rate_idx.flags & RATE_INFO_FLAGS_VHT_MCS)
 		return true;
 
+	if (rate_status->rate_idx.flags & RATE_INFO_FLAGS_HE_MCS) {
+		u8 max_nss = rate_status->rate_idx.he_dcm ?
+			     MINSTREL_HE_DCM_STREAMS : MINSTREL_MAX_STREAMS;
+
+		return rate_status->rate_idx.nss &&
+		       rate_status->rate_idx.nss <= max_nss &&
+		       rate_status->rate_idx.mcs <= 11 &&
+		       rate_status->rate_idx.bw != RATE_INFO_BW_320;
+	}
+
+	if (rate_status->rate_idx.flags & RATE_INFO_FLAGS_EHT_MCS)
+		return rate_status->rate_idx.nss &&
+		       rate_status->rate_idx.nss <= MINSTREL_MAX_STREAMS &&
+		       rate_status->rate_idx.mcs <= 13;
+
 	for (i = 0; i < ARRAY_SIZE(mp->cck_rates); i++) {
 		if (rate_status->rate_idx.legacy ==
 		    minstrel_cck_bitrates[ mp->cck_rates[i] ])
@@ -1538,7 +2033,8 @@ minstrel_ht_get_max_amsdu_len(struct minstrel_ht_sta *mi)
 	 * the limit here to avoid the complexity of having to de-aggregate
 	 * packets in the queue.
 	 */
-	if (!mi->sta->deflink.vht_cap.vht_supported)
+	if (!mi->sta->deflink.vht_cap.vht_supported &&
+	    !mi->sta->deflink.he_cap.has_he)
 		return IEEE80211_MAX_MPDU_LEN_HT_BA;
 
 	/* unlimited */
@@ -1679,7 +2175,7 @@ minstrel_ht_update_ofdm(struct minstrel_priv *mp, struct minstrel_ht_sta *mi,
 	const u8 *rates;
 	int i;
 
-	if (sta->deflink.ht_cap.ht_supported)
+	if (minstrel_ht_sta_has_mcs(sta))
 		return;
 
 	rates = mp->ofdm_rates[sband->band];
@@ -1705,6 +2201,7 @@ minstrel_ht_update_caps(void *priv, struct ieee80211_supported_band *sband,
 	const struct ieee80211_rate *ctl_rate;
 	struct sta_info *sta_info;
 	bool ldpc, erp;
+	bool use_he, use_eht;
 	int use_vht;
 	int n_supported = 0;
 	int ack_dur;
@@ -1718,6 +2215,9 @@ minstrel_ht_update_caps(void *priv, struct ieee80211_supported_band *sband,
 	else
 		use_vht = 0;
 
+	use_he = sta->deflink.he_cap.has_he;
+	use_eht = use_he && sta->deflink.eht_cap.has_eht;
+
 	memset(mi, 0, sizeof(*mi));
 
 	mi->sta = sta;
@@ -1763,6 +2263,52 @@ minstrel_ht_update_caps(void *priv, struct ieee80211_supported_band *sband,
 		if (minstrel_ht_is_legacy_group(i))
 			continue;
 
+		/* HE/EHT rate */
+		if (minstrel_ht_is_he_group(i) || minstrel_ht_is_eht_group(i)) {
+			bw = minstrel_mcs_groups[i].bw;
+			nss = minstrel_mcs_groups[i].streams;
+
+			if (!use_he)
+				continue;
+
+			if (sta->deflink.smps_mode == IEEE80211_SMPS_STATIC &&
+			    nss > 1)
+				continue;
+
+			if ((bw == BW_40 &&
+			     sta->deflink.bandwidth < IEEE80211_STA_RX_BW_40) ||
+			    (bw == BW_80 &&
+			     sta->deflink.bandwidth < IEEE80211_STA_RX_BW_80) ||
+			    (bw == BW_160 &&
+			     sta->deflink.bandwidth < IEEE80211_STA_RX_BW_160) ||
+			    (bw == BW_320 &&
+			     sta->deflink.bandwidth < IEEE80211_STA_RX_BW_320))
+				continue;
+
+			if (minstrel_ht_is_eht_group(i)) {
+				if (!use_eht)
+					continue;
+
+				mi->supported[i] =
+					minstrel_get_valid_eht_rates(sta, bw, nss);
+			} else {
+				/* EHT rates supersede plain HE rates */
+				if (use_eht && !minstrel_ht_is_he_dcm_group(i))
+					continue;
+
+				mi->supported[i] =
+					minstrel_get_valid_he_rates(sta, bw, nss,
+						minstrel_ht_is_he_dcm_group(i));
+			}
+
+			if (mi->supported[i])
+				n_supported++;
+			continue;
+		}
+
+		if (use_he && minstrel_he_only)
+			continue;
+
 		if (gflags & IEEE80211_TX_RC_SHORT_GI) {
 			if (gflags & IEEE80211_TX_RC_40_MHZ_WIDTH) {
 				if (!(ht_cap & IEEE80211_HT_CAP_SGI_40))
@@ -1867,13 +2413,17 @@ minstrel_ht_alloc_sta(void *priv, struct ieee80211_sta *sta, gfp_t gfp)
 			max_rates = sband->n_bitrates;
 	}
 
+	/* HE/EHT groups make the per-station state too big for kmalloc */
+	if (gfpflags_allow_blocking(gfp))
+		return kvzalloc(sizeof(*mi), gfp);
+
 	return kzalloc(sizeof(*mi), gfp);
 }
 
 static void
 minstrel_ht_free_sta(void *priv, struct ieee80211_sta *sta, void *priv_sta)
 {
-	kfree(priv_sta);
+	kvfree(priv_sta);
 }
 
 static void
@@ -1995,17 +2545,18 @@ minstrel_ht_free(void *priv)
 static u32 minstrel_ht_get_expected_throughput(void *priv_sta)
 {
 	struct minstrel_ht_sta *mi = priv_sta;
-	int i, j, prob, tp_avg;
+	int i, j, prob;
+	u64 tp_avg;
 
 	i = MI_RATE_GROUP(mi->max_tp_rate[0]);
 	j = MI_RATE_IDX(mi->max_tp_rate[0]);
 	prob = mi->groups[i].rates[j].prob_avg;
 
 	/* convert tp_avg from pkt per second in kbps */
-	tp_avg = minstrel_ht_get_tp_avg(mi, i, j, prob) * 10;
-	tp_avg = tp_avg * AVG_PKT_SIZE * 8 / 1024;
+	tp_avg = (u64)minstrel_ht_get_tp_avg(mi, i, j, prob) * 10;
+	tp_avg = div_u64(tp_avg * AVG_PKT_SIZE * 8, 1024);
 
-	return tp_avg;
+	return min_t(u64, tp_avg, U32_MAX);
 }
 
 static const struct rate_control_ops mac80211_minstrel_ht = {
@@ -42,22 +42,40 @@
 #define MINSTREL_MAX_STREAMS		4
 #define MINSTREL_HT_STREAM_GROUPS	4 /* BW(=2) * SGI(=2) */
 #define MINSTREL_VHT_STREAM_GROUPS	6 /* BW(=3) * SGI(=2) */
+#define MINSTREL_HE_STREAM_GROUPS	8 /* BW(=4) * GI(=2) */
+#define MINSTREL_EHT_STREAM_GROUPS	10 /* BW(=5) * GI(=2) */
+
+/* DCM can only be used with up to two spatial streams */
+#define MINSTREL_HE_DCM_STREAMS		2
 
 #define MINSTREL_HT_GROUPS_NB	(MINSTREL_MAX_STREAMS *		\
 				 MINSTREL_HT_STREAM_GROUPS)
 #define MINSTREL_VHT_GROUPS_NB	(MINSTREL_MAX_STREAMS *		\
 				 MINSTREL_VHT_STREAM_GROUPS)
+#define MINSTREL_HE_GROUPS_NB	(MINSTREL_MAX_STREAMS *		\
+				 MINSTREL_HE_STREAM_GROUPS)
+#define MINSTREL_HE_DCM_GROUPS_NB	(MINSTREL_HE_DCM_STREAMS *	\
+					 MINSTREL_HE_STREAM_GROUPS)
+#define MINSTREL_EHT_GROUPS_NB	(MINSTREL_MAX_STREAMS *		\
+				 MINSTREL_EHT_STREAM_GROUPS)
 #define MINSTREL_LEGACY_GROUPS_NB	2
 #define MINSTREL_GROUPS_NB	(MINSTREL_HT_GROUPS_NB +	\
 				 MINSTREL_VHT_GROUPS_NB +	\
+				 MINSTREL_HE_GROUPS_NB +	\
+				 MINSTREL_HE_DCM_GROUPS_NB +	\
+				 MINSTREL_EHT_GROUPS_NB +	\
 				 MINSTREL_LEGACY_GROUPS_NB)
 
 #define MINSTREL_HT_GROUP_0	0
 #define MINSTREL_CCK_GROUP	(MINSTREL_HT_GROUP_0 + MINSTREL_HT_GROUPS_NB)
 #define MINSTREL_OFDM_GROUP	(MINSTREL_CCK_GROUP + 1)
 #define MINSTREL_VHT_GROUP_0	(MINSTREL_OFDM_GROUP + 1)
+#define MINSTREL_HE_GROUP_0	(MINSTREL_VHT_GROUP_0 + MINSTREL_VHT_GROUPS_NB)
+#define MINSTREL_HE_DCM_GROUP_0	(MINSTREL_HE_GROUP_0 + MINSTREL_HE_GROUPS_NB)
+#define MINSTREL_EHT_GROUP_0	(MINSTREL_HE_DCM_GROUP_0 +	\
+				 MINSTREL_HE_DCM_GROUPS_NB)
 
-#define MCS_GROUP_RATES		10
+#define MCS_GROUP_RATES		14
 
 #define MI_RATE_IDX_MASK	GENMASK(3, 0)
 #define MI_RATE_GROUP_MASK	GENMASK(15, 4)
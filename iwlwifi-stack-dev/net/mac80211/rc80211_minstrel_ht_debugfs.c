@@ -16,6 +16,45 @@ struct minstrel_debugfs_info {
 	char buf[];
 };
 
+/* upper bound for the length of a single rate line, header and footer */
+#define MINSTREL_DEBUGFS_LINE_LEN	192
+#define MINSTREL_DEBUGFS_EXTRA_LEN	1024
+
+static const char * const minstrel_he_bw_str[] = {
+	"20", "40", "80", "160", "320"
+};
+
+static bool
+minstrel_ht_group_is_he(u32 gflags)
+{
+	return (gflags & IEEE80211_TX_RC_HE_MCS) == IEEE80211_TX_RC_HE_MCS;
+}
+
+static bool
+minstrel_ht_group_is_eht(u32 gflags)
+{
+	return (gflags & IEEE80211_TX_RC_EHT_MCS) == IEEE80211_TX_RC_EHT_MCS;
+}
+
+/*
+ * HE/EHT stations can support several hundred rates, so size the
+ * buffer based on the number of rates actually in use.
+ */
+static struct minstrel_debugfs_info *
+minstrel_ht_debugfs_alloc(struct minstrel_ht_sta *mi, size_t *size)
+{
+	unsigned int i, n_rates = 0;
+
+	for (i = 0; i < ARRAY_SIZE(mi->groups); i++)
+		n_rates += hweight16(mi->supported[i]);
+
+	*size = sizeof(struct minstrel_debugfs_info) +
+		MINSTREL_DEBUGFS_EXTRA_LEN +
+		n_rates * MINSTREL_DEBUGFS_LINE_LEN;
+
+	return kvmalloc(*size, GFP_KERNEL);
+}
+
 static ssize_t
 minstrel_stats_read(struct file *file, char __user *buf, size_t len, loff_t *ppos)
 {
@@ -28,7 +67,7 @@ minstrel_stats_read(struct file *file, char __user *buf, size_t len, loff_t *ppo
 static int
 minstrel_stats_release(struct inode *inode, struct file *file)
 {
-	kfree(file->private_data);
+	kvfree(file->private_data);
 	return 0;
 }
 
@@ -78,6 +117,14 @@ minstrel_ht_stats_dump(struct minstrel_ht_sta *mi, int i, char *p)
 			p += sprintf(p, "HT%c0  ", htmode);
 			p += sprintf(p, "%cGI  ", gimode);
 			p += sprintf(p, "%d  ", mg->streams);
+		} else if (minstrel_ht_group_is_he(gflags)) {
+			p += sprintf(p, "%s%-*s ",
+				     minstrel_ht_group_is_eht(gflags) ?
+				     "EHT" : "HE",
+				     minstrel_ht_group_is_eht(gflags) ? 3 : 4,
+				     minstrel_he_bw_str[mg->bw]);
+			p += sprintf(p, "%s ", gimode == 'S' ? "0.8" : "1.6");
+			p += sprintf(p, "%d  ", mg->streams);
 		} else if (gflags & IEEE80211_TX_RC_VHT_MCS) {
 			p += sprintf(p, "VHT%c0 ", htmode);
 			p += sprintf(p, "%cGI ", gimode);
@@ -100,6 +147,9 @@ minstrel_ht_stats_dump(struct minstrel_ht_sta *mi, int i, char *p)
 
 		if (gflags & IEEE80211_TX_RC_MCS) {
 			p += sprintf(p, "  MCS%-2u", (mg->streams - 1) * 8 + j);
+		} else if (minstrel_ht_group_is_he(gflags)) {
+			p += sprintf(p, "  MCS%-2u/%1u%s", j, mg->streams,
+				     gflags & IEEE80211_TX_RC_HE_DCM ? "D" : "");
 		} else if (gflags & IEEE80211_TX_RC_VHT_MCS) {
 			p += sprintf(p, "  MCS%-1u/%1u", j, mg->streams);
 		} else {
@@ -147,9 +197,10 @@ minstrel_ht_stats_open(struct inode *inode, struct file *file)
 	struct minstrel_ht_sta *mi = inode->i_private;
 	struct minstrel_debugfs_info *ms;
 	unsigned int i;
+	size_t size;
 	char *p;
 
-	ms = kmalloc(32768, GFP_KERNEL);
+	ms = minstrel_ht_debugfs_alloc(mi, &size);
 	if (!ms)
 		return -ENOMEM;
 
@@ -177,7 +228,7 @@ minstrel_ht_stats_open(struct inode *inode, struct file *file)
 			MINSTREL_TRUNC(mi->avg_ampdu_len),
 			MINSTREL_TRUNC(mi->avg_ampdu_len * 10) % 10);
 	ms->len = p - ms->buf;
-	WARN_ON(ms->len + sizeof(*ms) > 32768);
+	WARN_ON(ms->len + sizeof(*ms) > size);
 
 	return nonseekable_open(inode, file);
 }
@@ -224,6 +275,13 @@ minstrel_ht_stats_csv_dump(struct minstrel_ht_sta *mi, int i, char *p)
 			p += sprintf(p, "HT%c0,", htmode);
 			p += sprintf(p, "%cGI,", gimode);
 			p += sprintf(p, "%d,", mg->streams);
+		} else if (minstrel_ht_group_is_he(gflags)) {
+			p += sprintf(p, "%s%s,",
+				     minstrel_ht_group_is_eht(gflags) ?
+				     "EHT" : "HE",
+				     minstrel_he_bw_str[mg->bw]);
+			p += sprintf(p, "%s,", gimode == 'S' ? "0.8" : "1.6");
+			p += sprintf(p, "%d,", mg->streams);
 		} else if (gflags & IEEE80211_TX_RC_VHT_MCS) {
 			p += sprintf(p, "VHT%c0,", htmode);
 			p += sprintf(p, "%cGI,", gimode);
@@ -245,6 +303,9 @@ minstrel_ht_stats_csv_dump(struct minstrel_ht_sta *mi, int i, char *p)
 
 		if (gflags & IEEE80211_TX_RC_MCS) {
 			p += sprintf(p, ",MCS%-2u,", (mg->streams - 1) * 8 + j);
+		} else if (minstrel_ht_group_is_he(gflags)) {
+			p += sprintf(p, ",MCS%u/%u%s,", j, mg->streams,
+				     gflags & IEEE80211_TX_RC_HE_DCM ? "D" : "");
 		} else if (gflags & IEEE80211_TX_RC_VHT_MCS) {
 			p += sprintf(p, ",MCS%-1u/%1u,", j, mg->streams);
 		} else {
@@ -296,9 +357,10 @@ minstrel_ht_stats_csv_open(struct inode *inode, struct file *file)
 	struct minstrel_ht_sta *mi = inode->i_private;
 	struct minstrel_debugfs_info *ms;
 	unsigned int i;
+	size_t size;
 	char *p;
 
-	ms = kmalloc(32768, GFP_KERNEL);
+	ms = minstrel_ht_debugfs_alloc(mi, &size);
 	if (!ms)
 		return -ENOMEM;
 
@@ -313,7 +375,7 @@ minstrel_ht_stats_csv_open(struct inode *inode, struct file *file)
 		p = minstrel_ht_stats_csv_dump(mi, i, p);
 
 	ms->len = p - ms->buf;
-	WARN_ON(ms->len + sizeof(*ms) > 32768);
+	WARN_ON(ms->len + sizeof(*ms) > size);
 
 	return nonseekable_open(inode, file);
 }
@@ -2918,8 +2918,10 @@ ieee80211_rx_h_mesh_fwding(struct ieee80211_rx_data *rx)
 			mpp_path_add(sdata, proxied_addr, mpp_addr);
 		} else {
 			spin_lock_bh(&mppath->state_lock);
-			if (!ether_addr_equal(mppath->mpp, mpp_addr))
+			if (!ether_addr_equal(mppath->mpp, mpp_addr)) {
 				memcpy(mppath->mpp, mpp_addr, ETH_ALEN);
+				mesh_fast_tx_flush_mpath(mppath);
+			}
 			mppath->exp_time = jiffies;
 			spin_unlock_bh(&mppath->state_lock);
 		}
@@ -4410,6 +4412,12 @@ void ieee80211_check_fast_rx(struct sta_info *sta)
 			fastrx.internal_forward = 0;
 		}
 
+		break;
+	case NL80211_IFTYPE_MESH_POINT:
+		fastrx.expected_ds_bits = cpu_to_le16(IEEE80211_FCTL_FROMDS |
+						      IEEE80211_FCTL_TODS);
+		fastrx.da_offs = offsetof(struct ieee80211_hdr, addr3);
+		fastrx.sa_offs = offsetof(struct ieee80211_hdr, addr4);
 		break;
 	default:
 		goto clear;
@@ -4691,6 +4699,40 @@ static bool ieee80211_invoke_fast_rx(struct ieee80211_rx_data *rx,
 		snap_offs += IEEE80211_CCMP_HDR_LEN;
 	}
 
+#ifdef CPTCFG_MAC80211_MESH
+	if (fast_rx->vif_type == NL80211_IFTYPE_MESH_POINT) {
+		struct ieee80211s_hdr *mesh_hdr;
+
+		/* Only handle unicast frames for this station from an
+		 * established peer that don't need forwarding, proxy
+		 * learning or mesh power save processing; everything
+		 * else goes through ieee80211_rx_h_mesh_fwding().
+		 */
+		if (!sta->mesh || sta->mesh->plink_state != NL80211_PLINK_ESTAB)
+			return false;
+
+		if (ieee80211_has_pm(hdr->frame_control) ||
+		    sta->mesh->peer_pm != NL80211_MESH_POWER_ACTIVE ||
+		    sta->mesh->local_pm != NL80211_MESH_POWER_ACTIVE)
+			return false;
+
+		if (!ether_addr_equal(fast_rx->vif_addr, hdr->addr3))
+			return false;
+
+		if (status->rx_flags & IEEE80211_RX_AMSDU)
+			return false;
+
+		if (!pskb_may_pull(skb, snap_offs + 6))
+			goto drop;
+
+		mesh_hdr = (void *)(skb->data + snap_offs);
+		if ((mesh_hdr->flags & MESH_FLAGS_AE) || !mesh_hdr->ttl)
+			return false;
+
+		snap_offs += 6;
+	}
+#endif
+
 	if (!(status->rx_flags & IEEE80211_RX_AMSDU)) {
 		if (!pskb_may_pull(skb, snap_offs + sizeof(*payload)))
 			goto drop;
@@ -2453,15 +2453,16 @@ static void sta_set_tidstats(struct sta_info *sta,
 	}
 
 	if (local->ops->wake_tx_queue && tid < IEEE80211_NUM_TIDS) {
-		spin_lock_bh(&local->fq.lock);
+		struct txq_info *txqi = to_txq_info(sta->sta.txq[tid]);
+
+		fq_shard_lock_bh(txqi->tin.shard);
 		rcu_read_lock();
 
 		tidstats->filled |= BIT(NL80211_TID_STATS_TXQ_STATS);
-		ieee80211_fill_txq_stats(&tidstats->txq_stats,
-					 to_txq_info(sta->sta.txq[tid]));
+		ieee80211_fill_txq_stats(&tidstats->txq_stats, txqi);
 
 		rcu_read_unlock();
-		spin_unlock_bh(&local->fq.lock);
+		fq_shard_unlock_bh(txqi->tin.shard);
 	}
 }
 
@@ -390,6 +390,8 @@ DECLARE_EWMA(mesh_tx_rate_avg, 8, 16)
  * @connected_to_as: true if mesh STA has a path to a authentication server
  * @fail_avg: moving percentage of failed MSDUs
  * @tx_rate_avg: moving average of tx bitrate
+ * @nexthop_paths: mesh paths using this STA as next hop, protected by
+ *	the mesh path table's nexthop_lock
  */
 struct mesh_sta {
 	struct timer_list plink_timer;
@@ -421,6 +423,8 @@ struct mesh_sta {
 	struct ewma_mesh_fail_avg fail_avg;
 	/* moving average of tx bitrate */
 	struct ewma_mesh_tx_rate_avg tx_rate_avg;
+
+	struct hlist_head nexthop_paths;
 };
 
 DECLARE_EWMA(signal, 10, 8)
@@ -281,7 +281,9 @@ static int ieee80211_tx_radiotap_len(struct ieee80211_tx_info *info,
 	} else if (info->status.rates[0].idx >= 0) {
 		if (info->status.rates[0].flags & IEEE80211_TX_RC_MCS)
 			len += 3;
-		else if (info->status.rates[0].flags & IEEE80211_TX_RC_VHT_MCS)
+		else if (info->status.rates[0].flags & IEEE80211_TX_RC_VHT_MCS &&
+			 !(ieee80211_rate_is_he(&info->status.rates[0]) ||
+			   ieee80211_rate_is_eht(&info->status.rates[0])))
 			len = ALIGN(len, 2) + 12;
 	}
 
@@ -520,7 +522,9 @@ ieee80211_add_tx_radiotap_header(struct ieee80211_local *local,
 			pos[1] |= IEEE80211_RADIOTAP_MCS_FMT_GF;
 		pos[2] = info->status.rates[0].idx;
 		pos += 3;
-	} else if (info->status.rates[0].flags & IEEE80211_TX_RC_VHT_MCS) {
+	} else if (info->status.rates[0].flags & IEEE80211_TX_RC_VHT_MCS &&
+		   !(ieee80211_rate_is_he(&info->status.rates[0]) ||
+		     ieee80211_rate_is_eht(&info->status.rates[0]))) {
 		u16 known = local->hw.radiotap_vht_details &
 			(IEEE80211_RADIOTAP_VHT_KNOWN_GI |
 			 IEEE80211_RADIOTAP_VHT_KNOWN_BANDWIDTH);
@@ -1106,6 +1110,60 @@ void ieee80211_tx_status(struct ieee80211_hw *hw, struct sk_buff *skb)
 }
 EXPORT_SYMBOL(ieee80211_tx_status);
 
+void ieee80211_tx_status_list(struct ieee80211_hw *hw,
+			      struct ieee80211_sta *pubsta,
+			      struct sk_buff_head *skbs)
+{
+	struct ieee80211_local *local = hw_to_local(hw);
+#if LINUX_VERSION_IS_GEQ(4,19,0)
+	LIST_HEAD(free_list);
+	struct sk_buff *tmp;
+#else
+	struct sk_buff_head free_list;
+#endif
+	struct ieee80211_tx_status status = {
+		.free_list = &free_list,
+	};
+	struct sk_buff *skb;
+
+#if LINUX_VERSION_IS_LESS(4,19,0)
+	__skb_queue_head_init(&free_list);
+#endif
+
+	rcu_read_lock();
+
+	while ((skb = __skb_dequeue(skbs))) {
+		status.skb = skb;
+		status.info = IEEE80211_SKB_CB(skb);
+		status.sta = pubsta;
+
+		if (!pubsta) {
+			struct ieee80211_hdr *hdr = (void *)skb->data;
+			struct sta_info *sta;
+
+			sta = sta_info_get_by_addrs(local, hdr->addr1,
+						    hdr->addr2);
+			if (sta)
+				status.sta = &sta->sta;
+		}
+
+		ieee80211_tx_status_ext(hw, &status);
+	}
+
+	rcu_read_unlock();
+
+#if LINUX_VERSION_IS_GEQ(4,19,0)
+	list_for_each_entry_safe(skb, tmp, &free_list, list) {
+		skb_list_del_init(skb);
+		dev_kfree_skb(skb);
+	}
+#else
+	while ((skb = __skb_dequeue(&free_list)))
+		dev_kfree_skb(skb);
+#endif
+}
+EXPORT_SYMBOL(ieee80211_tx_status_list);
+
 void ieee80211_tx_status_ext(struct ieee80211_hw *hw,
 			     struct ieee80211_tx_status *status)
 {
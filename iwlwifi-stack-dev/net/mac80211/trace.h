@@ -1353,6 +1353,69 @@ TRACE_EVENT(drv_get_ringparam,
 	)
 );
 
+TRACE_EVENT(drv_set_coalesce,
+	TP_PROTO(struct ieee80211_local *local, u32 rx_usecs, bool adaptive_rx),
+
+	TP_ARGS(local, rx_usecs, adaptive_rx),
+
+	TP_STRUCT__entry(
+		LOCAL_ENTRY
+		__field(u32, rx_usecs)
+		__field(bool, adaptive_rx)
+	),
+
+	TP_fast_assign(
+		LOCAL_ASSIGN;
+		__entry->rx_usecs = rx_usecs;
+		__entry->adaptive_rx = adaptive_rx;
+	),
+
+	TP_printk(
+		LOCAL_PR_FMT " rx_usecs:%u adaptive_rx:%d",
+		LOCAL_PR_ARG, __entry->rx_usecs, __entry->adaptive_rx
+	)
+);
+
+DEFINE_EVENT(local_only_evt, drv_get_coalesce,
+	TP_PROTO(struct ieee80211_local *local),
+	TP_ARGS(local)
+);
+
+DEFINE_EVENT(local_only_evt, drv_get_rxfh,
+	TP_PROTO(struct ieee80211_local *local),
+	TP_ARGS(local)
+);
+
+DEFINE_EVENT(local_only_evt, drv_set_rxfh,
+	TP_PROTO(struct ieee80211_local *local),
+	TP_ARGS(local)
+);
+
+DEFINE_EVENT(local_only_evt, drv_get_rxnfc,
+	TP_PROTO(struct ieee80211_local *local),
+	TP_ARGS(local)
+);
+
+DEFINE_EVENT(local_only_evt, drv_set_rxnfc,
+	TP_PROTO(struct ieee80211_local *local),
+	TP_ARGS(local)
+);
+
+DEFINE_EVENT(local_only_evt, drv_get_channels,
+	TP_PROTO(struct ieee80211_local *local),
+	TP_ARGS(local)
+);
+
+DEFINE_EVENT(local_only_evt, drv_set_channels,
+	TP_PROTO(struct ieee80211_local *local),
+	TP_ARGS(local)
+);
+
+DEFINE_EVENT(local_only_evt, drv_get_ts_info,
+	TP_PROTO(struct ieee80211_local *local),
+	TP_ARGS(local)
+);
+
 DEFINE_EVENT(local_only_evt, drv_tx_frames_pending,
 	TP_PROTO(struct ieee80211_local *local),
 	TP_ARGS(local)
@@ -1460,11 +1460,11 @@ static void ieee80211_txq_enqueue(struct ieee80211_local *local,
 {
 	struct fq *fq = &local->fq;
 	struct fq_tin *tin = &txqi->tin;
-	u32 flow_idx = fq_flow_idx(fq, skb);
+	u32 flow_idx = fq_flow_idx(fq, tin, skb);
 
 	ieee80211_set_skb_enqueue_time(skb);
 
-	spin_lock_bh(&fq->lock);
+	fq_shard_lock_bh(tin->shard);
 	/*
 	 * For management frames, don't really apply codel etc.,
 	 * we don't want to apply any shaping or anything we just
@@ -1479,7 +1479,7 @@ static void ieee80211_txq_enqueue(struct ieee80211_local *local,
 		fq_tin_enqueue(fq, tin, flow_idx, skb,
 			       fq_skb_free_func);
 	}
-	spin_unlock_bh(&fq->lock);
+	fq_shard_unlock_bh(tin->shard);
 }
 
 static bool fq_vlan_filter_func(struct fq *fq, struct fq_tin *tin,
@@ -1510,17 +1510,27 @@ void ieee80211_txq_remove_vlan(struct ieee80211_local *local,
 	txqi = to_txq_info(ap->vif.txq);
 	tin = &txqi->tin;
 
-	spin_lock_bh(&fq->lock);
+	fq_shard_lock_bh(tin->shard);
 	fq_tin_filter(fq, tin, fq_vlan_filter_func, &sdata->vif,
 		      fq_skb_free_func);
-	spin_unlock_bh(&fq->lock);
+	fq_shard_unlock_bh(tin->shard);
 }
 
 void ieee80211_txq_init(struct ieee80211_sub_if_data *sdata,
 			struct sta_info *sta,
 			struct txq_info *txqi, int tid)
 {
-	fq_tin_init(&txqi->tin);
+	u8 ac;
+
+	if (!sta)
+		ac = IEEE80211_AC_BE;
+	else if (tid == IEEE80211_NUM_TIDS)
+		ac = IEEE80211_AC_VO;
+	else
+		ac = ieee80211_ac_from_tid(tid);
+
+	/* the FQ is sharded per AC, see ieee80211_txq_setup_flows() */
+	fq_tin_init(&sdata->local->fq, &txqi->tin, ac);
 	codel_vars_init(&txqi->def_cvars);
 	codel_stats_init(&txqi->cstats);
 	__skb_queue_head_init(&txqi->frags);
@@ -1531,7 +1541,7 @@ void ieee80211_txq_init(struct ieee80211_sub_if_data *sdata,
 	if (!sta) {
 		sdata->vif.txq = &txqi->txq;
 		txqi->txq.tid = 0;
-		txqi->txq.ac = IEEE80211_AC_BE;
+		txqi->txq.ac = ac;
 
 		return;
 	}
@@ -1547,11 +1557,9 @@ void ieee80211_txq_init(struct ieee80211_sub_if_data *sdata,
 			/* Drivers need to opt in to the bufferable MMPDU TXQ */
 			return;
 		}
-		txqi->txq.ac = IEEE80211_AC_VO;
-	} else {
-		txqi->txq.ac = ieee80211_ac_from_tid(tid);
 	}
 
+	txqi->txq.ac = ac;
 	txqi->txq.sta = &sta->sta;
 	txqi->txq.tid = tid;
 	sta->sta.txq[tid] = &txqi->txq;
@@ -1563,10 +1571,10 @@ void ieee80211_txq_purge(struct ieee80211_local *local,
 	struct fq *fq = &local->fq;
 	struct fq_tin *tin = &txqi->tin;
 
-	spin_lock_bh(&fq->lock);
+	fq_shard_lock_bh(tin->shard);
 	fq_tin_reset(fq, tin, fq_skb_free_func);
 	ieee80211_purge_tx_queue(&local->hw, &txqi->frags);
-	spin_unlock_bh(&fq->lock);
+	fq_shard_unlock_bh(tin->shard);
 
 	spin_lock_bh(&local->active_txq_lock[txqi->txq.ac]);
 	list_del_init(&txqi->schedule_order);
@@ -1602,7 +1610,11 @@ int ieee80211_txq_setup_flows(struct ieee80211_local *local)
 	if (!local->ops->wake_tx_queue)
 		return 0;
 
-	ret = fq_init(fq, 4096);
+	/*
+	 * Give each AC its own part of the flow table and its own lock, so
+	 * that enqueue and dequeue on different ACs don't contend.
+	 */
+	ret = fq_init_shards(fq, 4096 / IEEE80211_NUM_ACS, IEEE80211_NUM_ACS);
 	if (ret)
 		return ret;
 
@@ -1631,9 +1643,7 @@ int ieee80211_txq_setup_flows(struct ieee80211_local *local)
 	local->cvars = kcalloc(fq->flows_cnt, sizeof(local->cvars[0]),
 			       GFP_KERNEL);
 	if (!local->cvars) {
-		spin_lock_bh(&fq->lock);
 		fq_reset(fq, fq_skb_free_func);
-		spin_unlock_bh(&fq->lock);
 		return -ENOMEM;
 	}
 
@@ -1655,9 +1665,7 @@ void ieee80211_txq_teardown_flows(struct ieee80211_local *local)
 	kfree(local->cvars);
 	local->cvars = NULL;
 
-	spin_lock_bh(&fq->lock);
 	fq_reset(fq, fq_skb_free_func);
-	spin_unlock_bh(&fq->lock);
 }
 
 static bool ieee80211_queue_skb(struct ieee80211_local *local,
@@ -3045,6 +3053,10 @@ void ieee80211_check_fast_xmit(struct sta_info *sta)
 	if (!ieee80211_hw_check(&local->hw, SUPPORT_FAST_XMIT))
 		return;
 
+	/* cached mesh headers carry the key and peer state as well */
+	if (ieee80211_vif_is_mesh(&sdata->vif))
+		mesh_fast_tx_flush_sta(sdata, sta);
+
 	/* Locking here protects both the pointer itself, and against concurrent
 	 * invocations winning data access races to, e.g., the key pointer that
 	 * is used.
@@ -3301,6 +3313,9 @@ void ieee80211_clear_fast_xmit(struct sta_info *sta)
 {
 	struct ieee80211_fast_tx *fast_tx;
 
+	if (ieee80211_vif_is_mesh(&sta->sdata->vif))
+		mesh_fast_tx_flush_sta(sta->sdata, sta);
+
 	spin_lock_bh(&sta->lock);
 	fast_tx = rcu_dereference_protected(sta->fast_tx,
 					    lockdep_is_held(&sta->lock));
@@ -3444,15 +3459,15 @@ static bool ieee80211_amsdu_aggregate(struct ieee80211_sub_if_data *sdata,
 		max_amsdu_len = min_t(int, max_amsdu_len,
 				      sta->sta.cur->max_tid_amsdu_len[tid]);
 
-	flow_idx = fq_flow_idx(fq, skb);
+	tin = &txqi->tin;
+	flow_idx = fq_flow_idx(fq, tin, skb);
 
-	spin_lock_bh(&fq->lock);
+	fq_shard_lock_bh(tin->shard);
 
 	/* TODO: Ideally aggregation should be done on dequeue to remain
 	 * responsive to environment changes.
 	 */
 
-	tin = &txqi->tin;
 	flow = fq_flow_classify(fq, tin, flow_idx, skb);
 	head = skb_peek_tail(&flow->queue);
 	if (!head || skb_is_gso(head))
@@ -3524,13 +3539,14 @@ static bool ieee80211_amsdu_aggregate(struct ieee80211_sub_if_data *sdata,
 	*frag_tail = skb;
 
 out_recalc:
-	fq->memory_usage += head->truesize - orig_truesize;
+	atomic_add(head->truesize - orig_truesize, &fq->memory_usage);
 	if (head->len != orig_len) {
 		flow->backlog += head->len - orig_len;
+		fq_flow_update_backlog(flow);
 		tin->backlog_bytes += head->len - orig_len;
 	}
 out:
-	spin_unlock_bh(&fq->lock);
+	fq_shard_unlock_bh(tin->shard);
 
 	return ret;
 }
@@ -3606,56 +3622,27 @@ ieee80211_xmit_fast_finish(struct ieee80211_sub_if_data *sdata,
 	return TX_CONTINUE;
 }
 
-static bool ieee80211_xmit_fast(struct ieee80211_sub_if_data *sdata,
-				struct sta_info *sta,
-				struct ieee80211_fast_tx *fast_tx,
-				struct sk_buff *skb)
+/*
+ * Transmit a frame using a prepared fast-xmit header. The frame is expected
+ * to start with the (12 bytes of) Ethernet addresses, followed by whatever
+ * comes after the header template; the addresses are replaced by @da and @sa.
+ */
+static void __ieee80211_xmit_fast(struct ieee80211_sub_if_data *sdata,
+				  struct sta_info *sta,
+				  struct ieee80211_fast_tx *fast_tx,
+				  struct sk_buff *skb,
+				  struct tid_ampdu_tx *tid_tx,
+				  const u8 *da, const u8 *sa)
 {
 	struct ieee80211_local *local = sdata->local;
-	u16 ethertype = (skb->data[12] << 8) | skb->data[13];
 	int extra_head = fast_tx->hdr_len - (ETH_HLEN - 2);
 	int hw_headroom = sdata->local->hw.extra_tx_headroom;
-	struct ethhdr eth;
 	struct ieee80211_tx_info *info;
 	struct ieee80211_hdr *hdr = (void *)fast_tx->hdr;
 	struct ieee80211_tx_data tx;
 	ieee80211_tx_result r;
-	struct tid_ampdu_tx *tid_tx = NULL;
 	u8 tid = IEEE80211_NUM_TIDS;
 
-	/* control port protocol needs a lot of special handling */
-	if (cpu_to_be16(ethertype) == sdata->control_port_protocol)
-		return false;
-
-	/* only RFC 1042 SNAP */
-	if (ethertype < ETH_P_802_3_MIN)
-		return false;
-
-	/* don't handle TX status request here either */
-	if (skb->sk && skb_shinfo(skb)->tx_flags & SKBTX_WIFI_STATUS)
-		return false;
-
-	if (hdr->frame_control & cpu_to_le16(IEEE80211_STYPE_QOS_DATA)) {
-		tid = skb->priority & IEEE80211_QOS_CTL_TAG1D_MASK;
-		tid_tx = rcu_dereference(sta->ampdu_mlme.tid_tx[tid]);
-		if (tid_tx) {
-			if (!test_bit(HT_AGG_STATE_OPERATIONAL, &tid_tx->state))
-				return false;
-			if (tid_tx->timeout)
-				tid_tx->last_tx = jiffies;
-		}
-	}
-
-	/* after this point (skb is modified) we cannot return false */
-
-	skb = skb_share_check(skb, GFP_ATOMIC);
-	if (unlikely(!skb))
-		return true;
-
-	if ((hdr->frame_control & cpu_to_le16(IEEE80211_STYPE_QOS_DATA)) &&
-	    ieee80211_amsdu_aggregate(sdata, sta, fast_tx, skb))
-		return true;
-
 	/* will not be crypto-handled beyond what we do here, so use false
 	 * as the may-encrypt argument for the resize to not account for
 	 * more room than we already have in 'extra_head'
@@ -3665,14 +3652,13 @@ static bool ieee80211_xmit_fast(struct ieee80211_sub_if_data *sdata,
 						     skb_headroom(skb), 0),
 					  ENCRYPT_NO))) {
 		kfree_skb(skb);
-		return true;
+		return;
 	}
 
-	memcpy(&eth, skb->data, ETH_HLEN - 2);
 	hdr = skb_push(skb, extra_head);
 	memcpy(skb->data, fast_tx->hdr, fast_tx->hdr_len);
-	memcpy(skb->data + fast_tx->da_offs, eth.h_dest, ETH_ALEN);
-	memcpy(skb->data + fast_tx->sa_offs, eth.h_source, ETH_ALEN);
+	memcpy(skb->data + fast_tx->da_offs, da, ETH_ALEN);
+	memcpy(skb->data + fast_tx->sa_offs, sa, ETH_ALEN);
 
 	info = IEEE80211_SKB_CB(skb);
 	memset(info, 0, sizeof(*info));
@@ -3704,7 +3690,7 @@ static bool ieee80211_xmit_fast(struct ieee80211_sub_if_data *sdata,
 	tx.key = fast_tx->key;
 
 	if (ieee80211_queue_skb(local, sdata, sta, skb))
-		return true;
+		return;
 
 	tx.skb = skb;
 	r = ieee80211_xmit_fast_finish(sdata, sta, fast_tx->pn_offs,
@@ -3712,7 +3698,7 @@ static bool ieee80211_xmit_fast(struct ieee80211_sub_if_data *sdata,
 	tx.skb = NULL;
 	if (r == TX_DROP) {
 		kfree_skb(skb);
-		return true;
+		return;
 	}
 
 	if (sdata->vif.type == NL80211_IFTYPE_AP_VLAN)
@@ -3721,9 +3707,175 @@ static bool ieee80211_xmit_fast(struct ieee80211_sub_if_data *sdata,
 
 	__skb_queue_tail(&tx.skbs, skb);
 	ieee80211_tx_frags(local, &sdata->vif, sta, &tx.skbs, false);
+}
+
+static bool ieee80211_xmit_fast(struct ieee80211_sub_if_data *sdata,
+				struct sta_info *sta,
+				struct ieee80211_fast_tx *fast_tx,
+				struct sk_buff *skb)
+{
+	u16 ethertype = (skb->data[12] << 8) | skb->data[13];
+	struct ieee80211_hdr *hdr = (void *)fast_tx->hdr;
+	struct tid_ampdu_tx *tid_tx = NULL;
+	struct ethhdr eth;
+	u8 tid;
+
+	/* control port protocol needs a lot of special handling */
+	if (cpu_to_be16(ethertype) == sdata->control_port_protocol)
+		return false;
+
+	/* only RFC 1042 SNAP */
+	if (ethertype < ETH_P_802_3_MIN)
+		return false;
+
+	/* don't handle TX status request here either */
+	if (skb->sk && skb_shinfo(skb)->tx_flags & SKBTX_WIFI_STATUS)
+		return false;
+
+	if (hdr->frame_control & cpu_to_le16(IEEE80211_STYPE_QOS_DATA)) {
+		tid = skb->priority & IEEE80211_QOS_CTL_TAG1D_MASK;
+		tid_tx = rcu_dereference(sta->ampdu_mlme.tid_tx[tid]);
+		if (tid_tx) {
+			if (!test_bit(HT_AGG_STATE_OPERATIONAL, &tid_tx->state))
+				return false;
+			if (tid_tx->timeout)
+				tid_tx->last_tx = jiffies;
+		}
+	}
+
+	/* after this point (skb is modified) we cannot return false */
+
+	skb = skb_share_check(skb, GFP_ATOMIC);
+	if (unlikely(!skb))
+		return true;
+
+	if ((hdr->frame_control & cpu_to_le16(IEEE80211_STYPE_QOS_DATA)) &&
+	    ieee80211_amsdu_aggregate(sdata, sta, fast_tx, skb))
+		return true;
+
+	memcpy(&eth, skb->data, ETH_HLEN - 2);
+	__ieee80211_xmit_fast(sdata, sta, fast_tx, skb, tid_tx,
+			      eth.h_dest, eth.h_source);
+
 	return true;
 }
 
+#ifdef CPTCFG_MAC80211_MESH
+static bool ieee80211_mesh_xmit_fast(struct ieee80211_sub_if_data *sdata,
+				     struct sk_buff *skb, u32 ctrl_flags)
+{
+	struct ieee80211_if_mesh *ifmsh = &sdata->u.mesh;
+	struct ieee80211_mesh_fast_tx_key key = {};
+	struct ieee80211_mesh_fast_tx *entry;
+	struct ieee80211s_hdr *meshhdr;
+	struct ieee80211_hdr *hdr;
+	u8 sa[ETH_ALEN] __aligned(2);
+	struct tid_ampdu_tx *tid_tx;
+	struct sta_info *sta;
+	bool copy_sa = false;
+	u16 ethertype;
+	u8 tid;
+
+	if (ctrl_flags & IEEE80211_TX_CTRL_SKIP_MPATH_LOOKUP)
+		return false;
+
+	if (ifmsh->mshcfg.dot11MeshNolearn)
+		return false;
+
+	/* peers in power save need frames buffered and flagged */
+	if (ifmsh->ps_peers_light_sleep || ifmsh->ps_peers_deep_sleep)
+		return false;
+
+	if (is_multicast_ether_addr(skb->data))
+		return false;
+
+	/* each segment would need its own mesh sequence number */
+	if (skb_is_gso(skb))
+		return false;
+
+	ethertype = (skb->data[12] << 8) | skb->data[13];
+	if (ethertype < ETH_P_802_3_MIN)
+		return false;
+
+	if (cpu_to_be16(ethertype) == sdata->control_port_protocol)
+		return false;
+
+	if (skb->sk && skb_shinfo(skb)->tx_flags & SKBTX_WIFI_STATUS)
+		return false;
+
+	if (skb->ip_summed == CHECKSUM_PARTIAL) {
+		skb_set_transport_header(skb, skb_checksum_start_offset(skb));
+		if (skb_checksum_help(skb))
+			return false;
+	}
+
+	ether_addr_copy(key.addr, skb->data);
+	if (ether_addr_equal(skb->data + ETH_ALEN, sdata->vif.addr))
+		key.type = MESH_FAST_TX_TYPE_LOCAL;
+	else
+		key.type = MESH_FAST_TX_TYPE_PROXIED;
+
+	entry = mesh_fast_tx_get(sdata, &key);
+	if (!entry)
+		return false;
+
+	if (skb_headroom(skb) < entry->hdrlen + entry->fast_tx.hdr_len)
+		return false;
+
+	sta = rcu_dereference(entry->mpath->next_hop);
+	if (!sta || sta->mesh->local_pm != NL80211_MESH_POWER_ACTIVE)
+		return false;
+
+	/* the next hop may have changed since the header was cached */
+	hdr = (struct ieee80211_hdr *)entry->fast_tx.hdr;
+	if (!ether_addr_equal(hdr->addr1, sta->sta.addr))
+		return false;
+
+	tid = skb->priority & IEEE80211_QOS_CTL_TAG1D_MASK;
+	tid_tx = rcu_dereference(sta->ampdu_mlme.tid_tx[tid]);
+	if (tid_tx) {
+		if (!test_bit(HT_AGG_STATE_OPERATIONAL, &tid_tx->state))
+			return false;
+		if (tid_tx->timeout)
+			tid_tx->last_tx = jiffies;
+	}
+
+	skb = skb_share_check(skb, GFP_ATOMIC);
+	if (!skb)
+		return true;
+
+	meshhdr = (struct ieee80211s_hdr *)entry->hdr;
+	if ((meshhdr->flags & MESH_FLAGS_AE) == MESH_FLAGS_AE_A5_A6) {
+		/* preserve SA from eth header for 6-addr frames */
+		ether_addr_copy(sa, skb->data + ETH_ALEN);
+		copy_sa = true;
+	}
+
+	/* replace the Ethernet addresses with the mesh and SNAP headers */
+	memcpy(skb_push(skb, entry->hdrlen - 2 * ETH_ALEN), entry->hdr,
+	       entry->hdrlen);
+	meshhdr = (struct ieee80211s_hdr *)skb->data;
+	/* FIXME: racy -- TX on multiple queues can be concurrent */
+	put_unaligned(cpu_to_le32(ifmsh->mesh_seqnum), &meshhdr->seqnum);
+	ifmsh->mesh_seqnum++;
+	meshhdr->ttl = ifmsh->mshcfg.dot11MeshTTL;
+	if (copy_sa)
+		ether_addr_copy(meshhdr->eaddr2, sa);
+
+	skb_push(skb, 2 * ETH_ALEN);
+	__ieee80211_xmit_fast(sdata, sta, &entry->fast_tx, skb, tid_tx,
+			      entry->mpath->dst, sdata->vif.addr);
+
+	return true;
+}
+#else
+static bool ieee80211_mesh_xmit_fast(struct ieee80211_sub_if_data *sdata,
+				     struct sk_buff *skb, u32 ctrl_flags)
+{
+	return false;
+}
+#endif
+
 struct sk_buff *ieee80211_tx_dequeue(struct ieee80211_hw *hw,
 				     struct ieee80211_txq *txq)
 {
@@ -3744,7 +3896,7 @@ struct sk_buff *ieee80211_tx_dequeue(struct ieee80211_hw *hw,
 		return NULL;
 
 begin:
-	spin_lock_bh(&fq->lock);
+	fq_shard_lock_bh(tin->shard);
 
 	if (test_bit(IEEE80211_TXQ_STOP, &txqi->flags) ||
 	    test_bit(IEEE80211_TXQ_STOP_NETIF_TX, &txqi->flags))
@@ -3770,7 +3922,7 @@ begin:
 	if (!skb)
 		goto out;
 
-	spin_unlock_bh(&fq->lock);
+	fq_shard_unlock_bh(tin->shard);
 
 	hdr = (struct ieee80211_hdr *)skb->data;
 	info = IEEE80211_SKB_CB(skb);
@@ -3851,9 +4003,9 @@ begin:
 		skb = __skb_dequeue(&tx.skbs);
 
 		if (!skb_queue_empty(&tx.skbs)) {
-			spin_lock_bh(&fq->lock);
+			fq_shard_lock_bh(tin->shard);
 			skb_queue_splice_tail(&tx.skbs, &txqi->frags);
-			spin_unlock_bh(&fq->lock);
+			fq_shard_unlock_bh(tin->shard);
 		}
 	}
 
@@ -3914,7 +4066,7 @@ encap_out:
 	return skb;
 
 out:
-	spin_unlock_bh(&fq->lock);
+	fq_shard_unlock_bh(tin->shard);
 
 	return skb;
 }
@@ -4219,6 +4371,11 @@ void __ieee80211_subif_start_xmit(struct sk_buff *skb,
 
 	sk_pacing_shift_update(skb->sk, sdata->local->hw.tx_sk_pacing_shift);
 
+	if (ieee80211_vif_is_mesh(&sdata->vif) &&
+	    ieee80211_hw_check(&local->hw, SUPPORT_FAST_XMIT) &&
+	    ieee80211_mesh_xmit_fast(sdata, skb, ctrl_flags))
+		goto out;
+
 	if (sta) {
 		struct ieee80211_fast_tx *fast_tx;
 
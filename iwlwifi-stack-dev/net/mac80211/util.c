@@ -292,14 +292,14 @@ static void __ieee80211_wake_txqs(struct ieee80211_sub_if_data *sdata, int ac)
 {
 	struct ieee80211_local *local = sdata->local;
 	struct ieee80211_vif *vif = &sdata->vif;
-	struct fq *fq = &local->fq;
+	struct fq_shard *shard = &local->fq.shards[ac];
 	struct ps_data *ps = NULL;
 	struct txq_info *txqi;
 	struct sta_info *sta;
 	int i;
 
 	local_bh_disable();
-	spin_lock(&fq->lock);
+	fq_shard_lock(shard);
 
 	if (!test_bit(SDATA_STATE_RUNNING, &sdata->state))
 		goto out;
@@ -328,9 +328,9 @@ static void __ieee80211_wake_txqs(struct ieee80211_sub_if_data *sdata, int ac)
 						&txqi->flags))
 				continue;
 
-			spin_unlock(&fq->lock);
+			fq_shard_unlock(shard);
 			drv_wake_tx_queue(local, txqi);
-			spin_lock(&fq->lock);
+			fq_shard_lock(shard);
 		}
 	}
 
@@ -343,13 +343,13 @@ static void __ieee80211_wake_txqs(struct ieee80211_sub_if_data *sdata, int ac)
 	    (ps && atomic_read(&ps->num_sta_ps)) || ac != vif->txq->ac)
 		goto out;
 
-	spin_unlock(&fq->lock);
+	fq_shard_unlock(shard);
 
 	drv_wake_tx_queue(local, txqi);
 	local_bh_enable();
 	return;
 out:
-	spin_unlock(&fq->lock);
+	fq_shard_unlock(shard);
 	local_bh_enable();
 }
 
@@ -543,9 +543,9 @@ static void __ieee80211_stop_queue(struct ieee80211_hw *hw, int queue,
 					netif_stop_subqueue(sdata->dev, ac);
 					continue;
 				}
-				spin_lock(&local->fq.lock);
+				fq_shard_lock(&local->fq.shards[ac]);
 				sdata->vif.txqs_stopped[ac] = true;
-				spin_unlock(&local->fq.lock);
+				fq_shard_unlock(&local->fq.shards[ac]);
 			}
 		}
 	}
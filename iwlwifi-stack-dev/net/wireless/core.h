@@ -9,6 +9,7 @@
 #ifndef __NET_WIRELESS_CORE_H
 #define __NET_WIRELESS_CORE_H
 #include <linux/list.h>
+#include <linux/hashtable.h>
 #include <linux/netdevice.h>
 #include <linux/rbtree.h>
 #include <linux/debugfs.h>
@@ -71,6 +72,13 @@ struct cfg80211_registered_device {
 	struct rb_root bss_tree;
 	u32 bss_generation;
 	u32 bss_entries;
+	unsigned long bss_ies_reused;
+	/*
+	 * 6 GHz APs reported as co-located in the RNR element of the BSSes
+	 * above, hashed by center frequency, see cfg80211_scan_6ghz()
+	 */
+	DECLARE_HASHTABLE(coloc_ap_hash, 6);
+	u32 coloc_ap_entries;
 	struct cfg80211_scan_request *scan_req; /* protected by RTNL */
 	struct cfg80211_scan_request *int_scan_req;
 	struct sk_buff *scan_msg;
@@ -176,6 +184,10 @@ struct cfg80211_internal_bss {
 	 */
 	u8 parent_bssid[ETH_ALEN] __aligned(2);
 
+	/* co-located APs parsed from the RNR element of @coloc_ies */
+	struct list_head coloc_aps;
+	const struct cfg80211_bss_ies *coloc_ies;
+
 	/* must be last because of priv member */
 	struct cfg80211_bss pub;
 };
@@ -305,6 +317,11 @@ int cfg80211_dev_rename(struct cfg80211_registered_device *rdev,
 void ieee80211_set_bitrate_flags(struct wiphy *wiphy);
 
 void cfg80211_bss_expire(struct cfg80211_registered_device *rdev);
+/* take/drop a BSS reference with rdev->bss_lock already held */
+void cfg80211_ref_bss_locked(struct cfg80211_registered_device *rdev,
+			     struct cfg80211_internal_bss *bss);
+void cfg80211_put_bss_locked(struct cfg80211_registered_device *rdev,
+			     struct cfg80211_internal_bss *bss);
 void cfg80211_bss_age(struct cfg80211_registered_device *rdev,
                       unsigned long age_secs);
 void cfg80211_update_assoc_bss_entry(struct wireless_dev *wdev,
@@ -36,6 +36,10 @@ DEBUGFS_READONLY_FILE(short_retry_limit, 20, "%d",
 		      wiphy->retry_short);
 DEBUGFS_READONLY_FILE(long_retry_limit, 20, "%d",
 		      wiphy->retry_long);
+DEBUGFS_READONLY_FILE(bss_ies_reused, 24, "%lu",
+		      wiphy_to_rdev(wiphy)->bss_ies_reused);
+DEBUGFS_READONLY_FILE(coloc_ap_entries, 12, "%u",
+		      wiphy_to_rdev(wiphy)->coloc_ap_entries);
 
 static int ht_print_chan(struct ieee80211_channel *chan,
 			 char *buf, int buf_size, int offset)
@@ -107,4 +111,6 @@ void cfg80211_debugfs_rdev_add(struct cfg80211_registered_device *rdev)
 	DEBUGFS_ADD(short_retry_limit);
 	DEBUGFS_ADD(long_retry_limit);
 	DEBUGFS_ADD(ht40allow_map);
+	DEBUGFS_ADD(bss_ies_reused);
+	DEBUGFS_ADD(coloc_ap_entries);
 }
@@ -10249,12 +10249,36 @@ static int nl80211_send_bss(struct sk_buff *msg, struct netlink_callback *cb,
 	return -EMSGSIZE;
 }
 
+static struct cfg80211_internal_bss *
+nl80211_dump_scan_resume(struct cfg80211_registered_device *rdev,
+			 struct netlink_callback *cb, int start)
+{
+	struct cfg80211_internal_bss *scan = (void *)cb->args[3];
+	int idx = 0;
+
+	lockdep_assert_held(&rdev->bss_lock);
+
+	/*
+	 * Nothing was added, updated or removed since the previous message
+	 * was filled, so the entry dumped last is still on the list and we
+	 * can continue right after it.
+	 */
+	if (scan && cb->args[4] == rdev->bss_generation)
+		return list_next_entry(scan, list);
+
+	list_for_each_entry(scan, &rdev->bss_list, list)
+		if (++idx > start)
+			break;
+
+	return scan;
+}
+
 static int nl80211_dump_scan(struct sk_buff *skb, struct netlink_callback *cb)
 {
 	struct cfg80211_registered_device *rdev;
-	struct cfg80211_internal_bss *scan;
+	struct cfg80211_internal_bss *scan, *next;
 	struct wireless_dev *wdev;
-	int start = cb->args[2], idx = 0;
+	int start = cb->args[2], idx = start;
 	int err;
 
 	err = nl80211_prepare_wdev_dump(cb, &rdev, &wdev, NULL);
@@ -10277,15 +10301,45 @@ static int nl80211_dump_scan(struct sk_buff *skb, struct netlink_callback *cb)
 
 	cb->seq = rdev->bss_generation;
 
-	list_for_each_entry(scan, &rdev->bss_list, list) {
-		if (++idx <= start)
-			continue;
-		if (nl80211_send_bss(skb, cb,
-				cb->nlh->nlmsg_seq, NLM_F_MULTI,
-				rdev, wdev, scan) < 0) {
-			idx--;
+	/*
+	 * The BSS list is only appended to, so resuming is cheap as long
+	 * as the previous entry is still known to be on it. The messages
+	 * themselves are built without the BSS lock: the entry is kept
+	 * alive by a reference, and the IEs are RCU protected.
+	 */
+	scan = nl80211_dump_scan_resume(rdev, cb, start);
+	cb->args[3] = 0;
+
+	while (!list_entry_is_head(scan, &rdev->bss_list, list)) {
+		cfg80211_ref_bss_locked(rdev, scan);
+		spin_unlock_bh(&rdev->bss_lock);
+
+		err = nl80211_send_bss(skb, cb, cb->nlh->nlmsg_seq,
+				       NLM_F_MULTI, rdev, wdev, scan);
+
+		spin_lock_bh(&rdev->bss_lock);
+
+		if (err < 0) {
+			cfg80211_put_bss_locked(rdev, scan);
 			break;
 		}
+
+		idx++;
+
+		if (list_empty(&scan->list)) {
+			/* unlinked meanwhile, find our position again */
+			cfg80211_put_bss_locked(rdev, scan);
+			cb->args[3] = 0;
+			scan = nl80211_dump_scan_resume(rdev, cb, idx);
+			continue;
+		}
+
+		next = list_next_entry(scan, list);
+		cb->args[3] = (long)scan;
+		cb->args[4] = rdev->bss_generation;
+		/* still linked, so the list holds another reference */
+		cfg80211_put_bss_locked(rdev, scan);
+		scan = next;
 	}
 
 	spin_unlock_bh(&rdev->bss_lock);
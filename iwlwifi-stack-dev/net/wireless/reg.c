@@ -1666,17 +1666,63 @@ __freq_reg_info(struct wiphy *wiphy, u32 center_freq, u32 min_bw)
 {
 	const struct ieee80211_regdomain *regd = reg_get_regdomain(wiphy);
 	static const u32 bws[] = {0, 1, 2, 4, 5, 8, 10, 16, 20};
-	const struct ieee80211_reg_rule *reg_rule = ERR_PTR(-ERANGE);
-	int i = ARRAY_SIZE(bws) - 1;
-	u32 bw;
+	const struct ieee80211_reg_rule *reg_rule = NULL;
+	bool band_rule_found = false;
+	int best = -1;
+	int i, j;
 
-	for (bw = MHZ_TO_KHZ(bws[i]); bw >= min_bw; bw = MHZ_TO_KHZ(bws[i--])) {
-		reg_rule = freq_reg_info_regd(center_freq, regd, bw);
-		if (!IS_ERR(reg_rule))
-			return reg_rule;
+	if (MHZ_TO_KHZ(bws[ARRAY_SIZE(bws) - 1]) < min_bw)
+		return ERR_PTR(-ERANGE);
+
+	if (!regd)
+		return ERR_PTR(-EINVAL);
+
+	/*
+	 * Find the first rule that allows the widest bandwidth of the ones
+	 * above, in a single pass over the rules rather than one pass for
+	 * each bandwidth. A bandwidth that fits a rule implies that all the
+	 * narrower ones fit as well, so each rule only needs to be checked
+	 * for the bandwidths wider than the best found so far.
+	 */
+	for (i = 0; i < regd->n_reg_rules; i++) {
+		const struct ieee80211_reg_rule *rr = &regd->reg_rules[i];
+		const struct ieee80211_freq_range *fr = &rr->freq_range;
+
+		/*
+		 * We only need to know if one frequency rule was
+		 * in center_freq's band, that's enough, so let's
+		 * not overwrite it once found
+		 */
+		if (!band_rule_found)
+			band_rule_found = freq_in_rule_band(fr, center_freq);
+		if (!band_rule_found)
+			continue;
+
+		for (j = ARRAY_SIZE(bws) - 1; j > best; j--) {
+			u32 bw = MHZ_TO_KHZ(bws[j]);
+
+			if (bw < min_bw)
+				break;
+
+			if (cfg80211_does_bw_fit_range(fr, center_freq, bw)) {
+				best = j;
+				reg_rule = rr;
+				break;
+			}
+		}
+
+		/* nothing can beat the widest bandwidth */
+		if (best == ARRAY_SIZE(bws) - 1)
+			break;
 	}
 
-	return reg_rule;
+	if (reg_rule)
+		return reg_rule;
+
+	if (!band_rule_found)
+		return ERR_PTR(-ERANGE);
+
+	return ERR_PTR(-EINVAL);
 }
 
 const struct ieee80211_reg_rule *freq_reg_info(struct wiphy *wiphy,
@@ -80,6 +80,7 @@ MODULE_PARM_DESC(bss_entries_limit,
  * struct cfg80211_colocated_ap - colocated AP information
  *
  * @list: linked list to all colocated aPS
+ * @hnode: node in the rdev's per-channel co-located AP index
  * @bssid: BSSID of the reported AP
  * @ssid: SSID of the reported AP
  * @ssid_len: length of the ssid
@@ -99,6 +100,7 @@ MODULE_PARM_DESC(bss_entries_limit,
  */
 struct cfg80211_colocated_ap {
 	struct list_head list;
+	struct hlist_node hnode;
 	u8 bssid[ETH_ALEN];
 	u8 ssid[IEEE80211_MAX_SSID_LEN];
 	size_t ssid_len;
@@ -113,13 +115,30 @@ struct cfg80211_colocated_ap {
 	   short_ssid_valid:1;
 };
 
-static void bss_free(struct cfg80211_internal_bss *bss)
+static void cfg80211_unindex_coloc_aps(struct cfg80211_registered_device *rdev,
+				       struct cfg80211_internal_bss *bss)
+{
+	struct cfg80211_colocated_ap *ap, *tmp;
+
+	list_for_each_entry_safe(ap, tmp, &bss->coloc_aps, list) {
+		hash_del(&ap->hnode);
+		list_del(&ap->list);
+		kfree(ap);
+		rdev->coloc_ap_entries--;
+	}
+	bss->coloc_ies = NULL;
+}
+
+static void bss_free(struct cfg80211_registered_device *rdev,
+		     struct cfg80211_internal_bss *bss)
 {
 	struct cfg80211_bss_ies *ies;
 
 	if (WARN_ON(atomic_read(&bss->hold)))
 		return;
 
+	cfg80211_unindex_coloc_aps(rdev, bss);
+
 	ies = (void *)rcu_access_pointer(bss->pub.beacon_ies);
 	if (ies && !bss->pub.hidden_beacon_bss)
 		kfree_rcu(ies, rcu_head);
@@ -163,7 +182,7 @@ static inline void bss_ref_put(struct cfg80211_registered_device *rdev,
 				    pub);
 		hbss->refcount--;
 		if (hbss->refcount == 0)
-			bss_free(hbss);
+			bss_free(rdev, hbss);
 	}
 
 	if (bss->pub.transmitted_bss) {
@@ -174,12 +193,12 @@ static inline void bss_ref_put(struct cfg80211_registered_device *rdev,
 				    pub);
 		tbss->refcount--;
 		if (tbss->refcount == 0)
-			bss_free(tbss);
+			bss_free(rdev, tbss);
 	}
 
 	bss->refcount--;
 	if (bss->refcount == 0)
-		bss_free(bss);
+		bss_free(rdev, bss);
 }
 
 static bool __cfg80211_unlink_bss(struct cfg80211_registered_device *rdev,
@@ -204,6 +223,7 @@ static bool __cfg80211_unlink_bss(struct cfg80211_registered_device *rdev,
 	list_del_init(&bss->list);
 	list_del_init(&bss->pub.nontrans_list);
 	rb_erase(&bss->rbn, &rdev->bss_tree);
+	cfg80211_unindex_coloc_aps(rdev, bss);
 	rdev->bss_entries--;
 	WARN_ONCE((rdev->bss_entries == 0) ^ list_empty(&rdev->bss_list),
 		  "rdev bss entries[%d]/list[empty:%d] corruption\n",
@@ -672,6 +692,79 @@ static int cfg80211_parse_colocated_ap(const struct cfg80211_bss_ies *ies,
 	return n_coloc;
 }
 
+/*
+ * Re-parse the RNR element only when the BSS's IEs changed, so building
+ * a 6 GHz scan request doesn't need to walk and parse the whole BSS list.
+ */
+static void cfg80211_index_coloc_aps(struct cfg80211_registered_device *rdev,
+				     struct cfg80211_internal_bss *bss)
+{
+	const struct cfg80211_bss_ies *ies;
+	struct cfg80211_colocated_ap *ap;
+
+	lockdep_assert_held(&rdev->bss_lock);
+
+	ies = rcu_access_pointer(bss->pub.ies);
+	if (ies == bss->coloc_ies)
+		return;
+
+	cfg80211_unindex_coloc_aps(rdev, bss);
+
+	/* entries that were already unlinked are not scanned for */
+	if (!ies || list_empty(&bss->list))
+		return;
+
+	bss->coloc_ies = ies;
+	if (cfg80211_parse_colocated_ap(ies, &bss->coloc_aps) <= 0)
+		return;
+
+	list_for_each_entry(ap, &bss->coloc_aps, list) {
+		hash_add(rdev->coloc_ap_hash, &ap->hnode, ap->center_freq);
+		rdev->coloc_ap_entries++;
+	}
+}
+
+static int cfg80211_get_coloc_aps(struct cfg80211_registered_device *rdev,
+				  struct cfg80211_scan_request *request,
+				  struct list_head *list)
+{
+	int n_coloc = 0;
+	u32 i, j;
+
+	lockdep_assert_held(&rdev->bss_lock);
+
+	for (i = 0; i < request->n_channels; i++) {
+		struct ieee80211_channel *chan = request->channels[i];
+		struct cfg80211_colocated_ap *ap, *entry;
+
+		if (chan->band != NL80211_BAND_6GHZ)
+			continue;
+
+		/* the same channel may be requested more than once */
+		for (j = 0; j < i; j++) {
+			if (request->channels[j] == chan)
+				break;
+		}
+		if (j < i)
+			continue;
+
+		hash_for_each_possible(rdev->coloc_ap_hash, ap, hnode,
+				       chan->center_freq) {
+			if (ap->center_freq != chan->center_freq)
+				continue;
+
+			entry = kmemdup(ap, sizeof(*ap), GFP_ATOMIC);
+			if (!entry)
+				return n_coloc;
+
+			list_add_tail(&entry->list, list);
+			n_coloc++;
+		}
+	}
+
+	return n_coloc;
+}
+
 static  void cfg80211_scan_req_add_chan(struct cfg80211_scan_request *request,
 					struct ieee80211_channel *chan,
 					bool add_to_6ghz)
@@ -752,17 +845,8 @@ static int cfg80211_scan_6ghz(struct cfg80211_registered_device *rdev)
 	n_channels = rdev->wiphy.bands[NL80211_BAND_6GHZ]->n_channels;
 
 	if (rdev_req->flags & NL80211_SCAN_FLAG_COLOCATED_6GHZ) {
-		struct cfg80211_internal_bss *intbss;
-
 		spin_lock_bh(&rdev->bss_lock);
-		list_for_each_entry(intbss, &rdev->bss_list, list) {
-			struct cfg80211_bss *res = &intbss->pub;
-			const struct cfg80211_bss_ies *ies;
-
-			ies = rcu_access_pointer(res->ies);
-			count += cfg80211_parse_colocated_ap(ies,
-							     &coloc_ap_list);
-		}
+		count = cfg80211_get_coloc_aps(rdev, rdev_req, &coloc_ap_list);
 		spin_unlock_bh(&rdev->bss_lock);
 	}
 
@@ -814,8 +898,8 @@ static int cfg80211_scan_6ghz(struct cfg80211_registered_device *rdev)
 	if (!(rdev_req->flags & NL80211_SCAN_FLAG_COLOCATED_6GHZ))
 		goto skip;
 
+	/* only APs on requested channels were collected above */
 	list_for_each_entry(ap, &coloc_ap_list, list) {
-		bool found = false;
 		struct cfg80211_scan_6ghz_params *scan_6ghz_params =
 			&request->scan_6ghz_params[request->n_6ghz_params];
 		struct ieee80211_channel *chan =
@@ -824,14 +908,6 @@ static int cfg80211_scan_6ghz(struct cfg80211_registered_device *rdev)
 		if (!chan || chan->flags & IEEE80211_CHAN_DISABLED)
 			continue;
 
-		for (i = 0; i < rdev_req->n_channels; i++) {
-			if (rdev_req->channels[i] == chan)
-				found = true;
-		}
-
-		if (!found)
-			continue;
-
 		if (request->n_ssids > 0 &&
 		    !cfg80211_find_ssid_match(ap, request))
 			continue;
@@ -1219,6 +1295,18 @@ void cfg80211_bss_expire(struct cfg80211_registered_device *rdev)
 	__cfg80211_bss_expire(rdev, jiffies - IEEE80211_SCAN_RESULT_EXPIRE);
 }
 
+void cfg80211_ref_bss_locked(struct cfg80211_registered_device *rdev,
+			     struct cfg80211_internal_bss *bss)
+{
+	bss_ref_get(rdev, bss);
+}
+
+void cfg80211_put_bss_locked(struct cfg80211_registered_device *rdev,
+			     struct cfg80211_internal_bss *bss)
+{
+	bss_ref_put(rdev, bss);
+}
+
 void cfg80211_bss_flush(struct wiphy *wiphy)
 {
 	struct cfg80211_registered_device *rdev = wiphy_to_rdev(wiphy);
@@ -1624,6 +1712,65 @@ static void cfg80211_update_hidden_bsses(struct cfg80211_internal_bss *known,
 	}
 }
 
+/*
+ * Most beacons and probe responses carry exactly the same elements as the
+ * last time the BSS was seen. Rather than replacing the stored copy (and
+ * freeing it through RCU), just refresh its TSF and drop the new copy.
+ * This is only done for the temporary entries built by the inform
+ * functions (refcount 0), whose IEs were never visible to anyone else.
+ */
+static bool
+cfg80211_reuse_known_ies(struct cfg80211_registered_device *rdev,
+			 struct cfg80211_internal_bss *known,
+			 struct cfg80211_internal_bss *new)
+{
+	struct cfg80211_bss_ies *old, *ies;
+	bool proberesp;
+
+	lockdep_assert_held(&rdev->bss_lock);
+
+	if (new->refcount)
+		return false;
+
+	ies = (void *)rcu_access_pointer(new->pub.proberesp_ies);
+	proberesp = ies;
+	if (proberesp) {
+		old = (void *)rcu_access_pointer(known->pub.proberesp_ies);
+	} else {
+		ies = (void *)rcu_access_pointer(new->pub.beacon_ies);
+		if (!ies)
+			return false;
+
+		/* cfg80211_update_known_bss() drops these */
+		if (known->pub.hidden_beacon_bss &&
+		    !list_empty(&known->hidden_list))
+			return false;
+
+		old = (void *)rcu_access_pointer(known->pub.beacon_ies);
+	}
+
+	if (!old || old->len != ies->len ||
+	    old->from_beacon != ies->from_beacon ||
+	    memcmp(old->data, ies->data, ies->len))
+		return false;
+
+	/* readers may see either TSF, same as with swapping the pointer */
+	WRITE_ONCE(old->tsf, ies->tsf);
+
+	/* Override possible earlier Beacon frame IEs */
+	if (proberesp)
+		rcu_assign_pointer(known->pub.ies, old);
+
+	RCU_INIT_POINTER(new->pub.proberesp_ies, NULL);
+	RCU_INIT_POINTER(new->pub.beacon_ies, NULL);
+	RCU_INIT_POINTER(new->pub.ies, NULL);
+	kfree(ies);
+
+	rdev->bss_ies_reused++;
+
+	return true;
+}
+
 static bool
 cfg80211_update_known_bss(struct cfg80211_registered_device *rdev,
 			  struct cfg80211_internal_bss *known,
@@ -1726,6 +1873,9 @@ cfg80211_bss_update(struct cfg80211_registered_device *rdev,
 	found = rb_find_bss(rdev, tmp, BSS_CMP_REGULAR);
 
 	if (found) {
+		/* if the IEs are unchanged only the other fields are updated */
+		cfg80211_reuse_known_ies(rdev, found, tmp);
+
 		if (!cfg80211_update_known_bss(rdev, found, tmp, signal_valid))
 			goto drop;
 	} else {
@@ -1752,6 +1902,8 @@ cfg80211_bss_update(struct cfg80211_registered_device *rdev,
 		memcpy(new, tmp, sizeof(*new));
 		new->refcount = 1;
 		INIT_LIST_HEAD(&new->hidden_list);
+		INIT_LIST_HEAD(&new->coloc_aps);
+		new->coloc_ies = NULL;
 		INIT_LIST_HEAD(&new->pub.nontrans_list);
 		/* we'll set this later if it was non-NULL */
 		new->pub.transmitted_bss = NULL;
@@ -1805,6 +1957,8 @@ cfg80211_bss_update(struct cfg80211_registered_device *rdev,
 		found = new;
 	}
 
+	cfg80211_index_coloc_aps(rdev, found);
+
 	rdev->bss_generation++;
 	bss_ref_get(rdev, found);
 	spin_unlock_bh(&rdev->bss_lock);
@@ -2370,6 +2524,9 @@ cfg80211_update_notlisted_nontrans(struct wiphy *wiphy,
 			kfree_rcu((struct cfg80211_bss_ies *)old, rcu_head);
 	}
 
+	cfg80211_index_coloc_aps(wiphy_to_rdev(wiphy),
+				 bss_from_pub(nontrans_bss));
+
 out_free:
 	kfree(new_ie);
 }